@@ -4,6 +4,8 @@ open System
 open BenchmarkDotNet.Attributes
 open BenchmarkDotNet.Jobs
 open BenchmarkDotNet.Configs
+open BenchmarkDotNet.Columns
+open BenchmarkDotNet.Reports
 open BenchmarkDotNet.Running
 open MathOperationsInterop
 open CppOperationsInterop
@@ -99,6 +101,14 @@ type InteropPerformanceBenchmarks() =
         with
         | _ -> 0.0
 
+    [<Benchmark(Description = "C++: Fused Statistics (calculate_statistics)")>]
+    member this.CppFusedStatistics() =
+        try
+            let summary = calculateSummary testData
+            summary.variance + summary.standard_deviation
+        with
+        | _ -> 0.0
+
     // Array operations benchmarks - F# vs C vs C++
     [<Benchmark(Description = "F#: Array Sum (100 elements)")>]
     member this.FSharpArraySum() =
@@ -319,6 +329,1496 @@ type MicroBenchmarks() =
         with
         | _ -> 0.0
 
+    [<Benchmark>]
+    member this.CppFusedStatisticsScaled() =
+        try
+            (calculateSummary testDoubleArray).variance
+        with
+        | _ -> 0.0
+
+// Reports work per second, derived from the "Size" parameter and the mean time per call.
+// scale converts work per nanosecond into the column's unit (1.0 gives G/s, 1e3 gives M/s).
+type ThroughputColumn(id: string, columnName: string, legend: string, workPerCall: float -> float, scale: float) =
+    interface IColumn with
+        member _.Id = id
+        member _.ColumnName = columnName
+        member _.AlwaysShow = true
+        member _.Category = ColumnCategory.Custom
+        member _.PriorityInCategory = 0
+        member _.IsNumeric = true
+        member _.UnitType = UnitType.Dimensionless
+        member _.Legend = legend
+        member this.GetValue(summary: Summary, benchmarkCase: BenchmarkCase) =
+            (this :> IColumn).GetValue(summary, benchmarkCase, SummaryStyle.Default)
+        member _.GetValue(summary: Summary, benchmarkCase: BenchmarkCase, _style: SummaryStyle) =
+            let report = summary.[benchmarkCase]
+            if isNull report || isNull report.ResultStatistics then "-"
+            else
+                let size = Convert.ToDouble(benchmarkCase.Parameters.["Size"])
+                // Mean is in nanoseconds
+                let throughput = workPerCall size / report.ResultStatistics.Mean * scale
+                throughput.ToString("F2")
+        member _.IsDefault(_: Summary, _: BenchmarkCase) = false
+        member _.IsAvailable(_: Summary) = true
+
+// Dense matrix multiply throughput (2 * Size^3 floating point operations per call)
+type GflopsColumn() =
+    inherit ThroughputColumn("GflopsColumn", "GFLOP/s",
+                             "Billions of floating point operations per second (2 * Size^3 per multiply)",
+                             (fun n -> 2.0 * n * n * n), 1.0)
+
+// Elements processed per second for one dimensional inputs of Size elements
+type ElementThroughputColumn() =
+    inherit ThroughputColumn("ElementThroughputColumn", "Melem/s",
+                             "Millions of input elements processed per second (Size elements per call)",
+                             id, 1e3)
+
+// Elements processed per second for square Size x Size matrices
+type MatrixElementThroughputColumn() =
+    inherit ThroughputColumn("MatrixElementThroughputColumn", "Melem/s",
+                             "Millions of matrix elements processed per second (Size^2 elements per call)",
+                             (fun n -> n * n), 1e3)
+
+type MatrixBenchmarkConfig() =
+    inherit BenchmarkConfig()
+    do
+        base.AddColumn(GflopsColumn() :> IColumn) |> ignore
+
+type ScalingBenchmarkConfig() =
+    inherit BenchmarkConfig()
+    do
+        base.AddColumn(ElementThroughputColumn() :> IColumn) |> ignore
+
+type MatrixTransposeBenchmarkConfig() =
+    inherit BenchmarkConfig()
+    do
+        base.AddColumn(MatrixElementThroughputColumn() :> IColumn) |> ignore
+
+// Square matrix multiply from sizes that fit in L1 up to sizes where cache blocking dominates
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<MatrixBenchmarkConfig>)>]
+type MatrixMultiplyBenchmarks() =
+    let mutable left: CppMatrix option = None
+    let mutable right: CppMatrix option = None
+    let mutable leftManaged: double[] = [||]
+    let mutable rightManaged: double[] = [||]
+
+    [<Params(16, 32, 64, 128, 256, 512, 1024, 2048)>]
+    member val public Size = 0 with get, set
+
+    // Native worker count; 0 uses every hardware thread
+    [<Params(1, 0)>]
+    member val public Threads = 0 with get, set
+
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        leftManaged <- Array.init (n * n) (fun _ -> random.NextDouble())
+        rightManaged <- Array.init (n * n) (fun _ -> random.NextDouble())
+        try
+            cpp_set_num_threads(this.Threads)
+            left <- Some(CppMatrix.FromArray(n, n, leftManaged))
+            right <- Some(CppMatrix.FromArray(n, n, rightManaged))
+        with
+        | _ -> () // Skip setup if libraries not available
+
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        left |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+        right |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+        try cpp_set_num_threads(0) with _ -> ()
+
+    [<Benchmark(Description = "F#: Matrix Multiply (i-k-j loop)", Baseline = true)>]
+    member this.FSharpMatrixMultiply() =
+        let n = this.Size
+        let result = Array.zeroCreate<double> (n * n)
+        for i in 0 .. n - 1 do
+            for k in 0 .. n - 1 do
+                let aik = leftManaged.[i * n + k]
+                let rowOffset = k * n
+                let resultOffset = i * n
+                for j in 0 .. n - 1 do
+                    result.[resultOffset + j] <- result.[resultOffset + j] + aik * rightManaged.[rowOffset + j]
+        result.[0]
+
+    [<Benchmark(Description = "C++: Matrix Multiply (blocked GEMM)")>]
+    member this.CppMatrixMultiply() =
+        match left, right with
+        | Some a, Some b ->
+            match a.Multiply(b) with
+            | Some product ->
+                use resultMatrix = product
+                resultMatrix.Get(0, 0)
+            | None -> 0.0
+        | _ -> 0.0
+
+// Out-of-place transpose from 16 to 2048; the native kernel is single threaded and
+// bandwidth bound, so there is no thread count sweep here
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<MatrixTransposeBenchmarkConfig>)>]
+type MatrixTransposeBenchmarks() =
+    let mutable source: CppMatrix option = None
+    let mutable destination: CppMatrix option = None
+    let mutable managed: double[] = [||]
+    let mutable managedResult: double[] = [||]
+
+    [<Params(16, 32, 64, 128, 256, 512, 1024, 2048)>]
+    member val public Size = 0 with get, set
+
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        managed <- Array.init (n * n) (fun _ -> random.NextDouble())
+        managedResult <- Array.zeroCreate (n * n)
+        try
+            source <- Some(CppMatrix.FromArray(n, n, managed))
+            destination <- Some(new CppMatrix(n, n))
+        with
+        | _ -> () // Skip setup if libraries not available
+
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        source |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+        destination |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+
+    [<Benchmark(Description = "F#: Transpose (row-major loop)", Baseline = true)>]
+    member this.FSharpTranspose() =
+        let n = this.Size
+        for i in 0 .. n - 1 do
+            let rowOffset = i * n
+            for j in 0 .. n - 1 do
+                managedResult.[j * n + i] <- managed.[rowOffset + j]
+        managedResult.[0]
+
+    [<Benchmark(Description = "C++: TransposeInto (tiled)")>]
+    member this.CppTranspose() =
+        match source, destination with
+        | Some a, Some result ->
+            a.TransposeInto(result)
+            result.Get(0, 0)
+        | _ -> 0.0
+
+// Startup cost of loading a saved matrix: element-by-element, one bulk copy, or a mapping
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixFileBenchmarks() =
+    let mutable path = ""
+    let mutable values: double[] = [||]
+    
+    [<Params(256, 1024, 4096)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        values <- Array.init (n * n) (fun _ -> random.NextDouble())
+        path <- IO.Path.Combine(IO.Path.GetTempPath(), $"interop-bench-{n}.mat")
+        try
+            use matrix = CppMatrix.FromArray(n, n, values)
+            matrix.Save(path)
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        if IO.File.Exists(path) then IO.File.Delete(path)
+    
+    [<Benchmark(Description = "C++: Load via matrix_set per element", Baseline = true)>]
+    member this.PerElement() =
+        let n = this.Size
+        use matrix = new CppMatrix(n, n)
+        for i in 0 .. n - 1 do
+            for j in 0 .. n - 1 do
+                matrix.Set(i, j, values.[i * n + j])
+        matrix.Get(n - 1, n - 1)
+    
+    [<Benchmark(Description = "C++: Load via FromArray (bulk copy)")>]
+    member this.Bulk() =
+        let n = this.Size
+        use matrix = CppMatrix.FromArray(n, n, values)
+        matrix.Get(n - 1, n - 1)
+    
+    [<Benchmark(Description = "C++: OpenMapped (read-only, touches one page)")>]
+    member this.Mapped() =
+        use matrix = CppMatrix.OpenMapped(path, true)
+        matrix.Get(matrix.Rows - 1, matrix.Cols - 1)
+
+// Statistics over data that arrives in chunks: buffer everything, or accumulate per chunk
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type StatsAccumulatorBenchmarks() =
+    let mutable chunks: double[][] = [||]
+    let mutable accumulator: StatsAccumulator option = None
+    
+    [<Params(1000, 100000)>]
+    member val public ChunkSize = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        chunks <- Array.init 64 (fun _ -> Array.init this.ChunkSize (fun _ -> random.NextDouble()))
+        try
+            accumulator <- Some(new StatsAccumulator())
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        accumulator |> Option.iter (fun a -> (a :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: Concatenate chunks, calculate_statistics", Baseline = true)>]
+    member this.Buffered() =
+        try (calculateSummary (Array.concat chunks)).variance with _ -> 0.0
+    
+    [<Benchmark(Description = "C++: stats_push_batch per chunk")>]
+    member this.Streaming() =
+        match accumulator with
+        | Some a ->
+            a.Reset()
+            for chunk in chunks do
+                a.Push(chunk)
+            a.Snapshot().variance
+        | None -> 0.0
+
+// Integer and floating point reductions; large inputs run on the thread pool
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<ScalingBenchmarkConfig>)>]
+type ReductionBenchmarks() =
+    let mutable ints: int[] = [||]
+    let mutable doubles: double[] = [||]
+    let mutable vector: CppVector option = None
+    
+    [<Params(100, 1000, 10000, 100000, 1000000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    // Native worker count; 0 uses every hardware thread
+    [<Params(1, 0)>]
+    member val public Threads = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        ints <- Array.init this.Size (fun _ -> random.Next())
+        doubles <- Array.init this.Size (fun _ -> random.NextDouble())
+        try
+            cpp_set_num_threads(this.Threads)
+            let v = new CppVector()
+            v.AddRange(ints)
+            vector <- Some v
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        vector |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+        try cpp_set_num_threads(0) with _ -> ()
+    
+    [<Benchmark(Description = "F#: Array.sumBy int64", Baseline = true)>]
+    member this.FSharpSum() = Array.sumBy int64 ints
+    
+    [<Benchmark(Description = "C: sum_array_i64 (vectorized)")>]
+    member this.CSum() =
+        try sum_array_i64(ints, ints.Length) with _ -> 0L
+    
+    [<Benchmark(Description = "C++: vector_sum_i64 (parallel)")>]
+    member this.CppVectorSum() =
+        match vector with
+        | Some v -> v.SumInt64()
+        | None -> 0L
+    
+    [<Benchmark(Description = "C++: calculate_mean_double (parallel pairwise)")>]
+    member this.CppMean() =
+        try int64 (calculate_mean_double(doubles, doubles.Length) * 1e6) with _ -> 0L
+
+// Overhead of handing a multiply to the native job runner and awaiting the task
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixAsyncBenchmarks() =
+    let mutable a: CppMatrix option = None
+    let mutable b: CppMatrix option = None
+    
+    [<Params(32, 256, 1024)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        try
+            a <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+            b <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        [ a; b ] |> List.iter (Option.iter (fun m -> (m :> IDisposable).Dispose()))
+    
+    [<Benchmark(Description = "C++: Multiply (blocks the caller)", Baseline = true)>]
+    member this.Sync() =
+        match a, b with
+        | Some a, Some b ->
+            use product = a.Multiply(b).Value
+            product.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: MultiplyAsync (awaited)")>]
+    member this.Async() =
+        match a, b with
+        | Some a, Some b ->
+            task {
+                use! product = a.MultiplyAsync(b)
+                return product.Get(0, 0)
+            }
+        | _ -> Threading.Tasks.Task.FromResult(0.0)
+
+// Same GEMM kernels compiled per element type; float32 halves memory traffic per element
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<MatrixBenchmarkConfig>)>]
+type MatrixElementTypeBenchmarks() =
+    let mutable f64: (CppMatrix * CppMatrix * CppMatrix) option = None
+    let mutable f32: (CppMatrixF32 * CppMatrixF32 * CppMatrixF32) option = None
+    let mutable i32: (CppMatrixI32 * CppMatrixI32 * CppMatrixI32) option = None
+    
+    [<Params(256, 512, 1024)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        let values = Array.init (n * n) (fun _ -> random.NextDouble())
+        try
+            f64 <- Some(CppMatrix.FromArray(n, n, values), CppMatrix.FromArray(n, n, values), new CppMatrix(n, n))
+            let single = Array.map float32 values
+            f32 <- Some(CppMatrixF32.FromArray(n, n, single), CppMatrixF32.FromArray(n, n, single), new CppMatrixF32(n, n))
+            let ints = Array.map (fun v -> int (v * 100.0)) values
+            i32 <- Some(CppMatrixI32.FromArray(n, n, ints), CppMatrixI32.FromArray(n, n, ints), new CppMatrixI32(n, n))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        let dispose (items: IDisposable list) = items |> List.iter (fun d -> d.Dispose())
+        f64 |> Option.iter (fun (a, b, c) -> dispose [ a; b; c ])
+        f32 |> Option.iter (fun (a, b, c) -> dispose [ a; b; c ])
+        i32 |> Option.iter (fun (a, b, c) -> dispose [ a; b; c ])
+    
+    [<Benchmark(Description = "C++: MultiplyInto (float64)", Baseline = true)>]
+    member this.Float64() =
+        match f64 with
+        | Some (a, b, c) ->
+            a.MultiplyInto(b, c)
+            c.Get(0, 0)
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: MultiplyInto (float32)")>]
+    member this.Float32() =
+        match f32 with
+        | Some (a, b, c) ->
+            a.MultiplyInto(b, c)
+            float (c.Get(0, 0))
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: MultiplyInto (int32)")>]
+    member this.Int32() =
+        match i32 with
+        | Some (a, b, c) ->
+            a.MultiplyInto(b, c)
+            float (c.Get(0, 0))
+        | None -> 0.0
+
+// Repeated transforms in a steady-state loop; the *Into variants should report zero allocations
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixIterationBenchmarks() =
+    let mutable transform: CppMatrix option = None
+    let mutable state: CppMatrix option = None
+    let mutable scratch: CppMatrix option = None
+    let mutable spare: CppMatrix option = None
+    let steps = 10
+    
+    [<Params(16, 64, 256)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        try
+            // Scaled so repeated products stay bounded
+            transform <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble() / float n)))
+            state <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+            scratch <- Some(new CppMatrix(n, n))
+            spare <- Some(new CppMatrix(n, n))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        [ transform; state; scratch; spare ] |> List.iter (Option.iter (fun m -> (m :> IDisposable).Dispose()))
+    
+    [<Benchmark(Description = "C++: Repeated Multiply (new matrix per step)", Baseline = true)>]
+    member this.AllocatingLoop() =
+        match transform, state with
+        | Some t, Some x ->
+            let mutable current = t.Multiply(x).Value
+            for _ in 2 .. steps do
+                let next = t.Multiply(current).Value
+                (current :> IDisposable).Dispose()
+                current <- next
+            let result = current.Get(0, 0)
+            (current :> IDisposable).Dispose()
+            result
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: Repeated Multiply (matrix_multiply_into)")>]
+    member this.IntoLoop() =
+        match transform, state, scratch, spare with
+        | Some t, Some x, Some y, Some z ->
+            // Ping-pong between two preallocated buffers, leaving the input untouched
+            t.MultiplyInto(x, y)
+            let mutable source = y
+            let mutable target = z
+            for _ in 2 .. steps do
+                t.MultiplyInto(source, target)
+                let previous = source
+                source <- target
+                target <- previous
+            source.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: Repeated GEMM Update (matrix_gemm)")>]
+    member this.GemmLoop() =
+        match transform, state, scratch with
+        | Some t, Some x, Some y ->
+            for _ in 1 .. steps do
+                y.Gemm(1.0, t, x, 0.5)
+            y.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: Transpose (new matrix)")>]
+    member this.TransposeAllocating() =
+        match state with
+        | Some x ->
+            use result = x.Transpose().Value
+            result.Get(0, 0)
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Transpose (in place, cache-oblivious)")>]
+    member this.TransposeInPlace() =
+        match state with
+        | Some x ->
+            x.TransposeInPlace()
+            x.Get(0, 0)
+        | None -> 0.0
+
+// transpose(A) * B * v: eager left-to-right evaluation vs one lazy expression
+// (fused transpose, and the chain is reordered to A^T * (B * v))
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixExpressionBenchmarks() =
+    let mutable a: CppMatrix option = None
+    let mutable b: CppMatrix option = None
+    let mutable v: CppMatrix option = None
+    
+    [<Params(128, 512)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let n = this.Size
+        let random = Random(42)
+        try
+            a <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+            b <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+            v <- Some(CppMatrix.FromArray(n, 1, Array.init n (fun _ -> random.NextDouble())))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        [ a; b; v ] |> List.iter (Option.iter (fun m -> (m :> IDisposable).Dispose()))
+    
+    [<Benchmark(Description = "C++: transpose(A) * B * v (eager temporaries)", Baseline = true)>]
+    member this.Eager() =
+        match a, b, v with
+        | Some a, Some b, Some v ->
+            use aT = a.Transpose().Value
+            use aTb = aT.Multiply(b).Value
+            use result = aTb.Multiply(v).Value
+            result.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: transpose(A) * B * v (lazy expression)")>]
+    member this.Lazy() =
+        match a, b, v with
+        | Some a, Some b, Some v ->
+            use expr = CppMatrixExpr.Of(a).Transpose() * CppMatrixExpr.Of(b) * CppMatrixExpr.Of(v)
+            use result = expr.Eval()
+            result.Get(0, 0)
+        | _ -> 0.0
+
+// Cost of moving matrix data across the P/Invoke boundary
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixTransferBenchmarks() =
+    let mutable matrix: CppMatrix option = None
+    let mutable values: double[] = [||]
+    
+    [<Params(100, 500, 1000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        values <- Array.init (this.Size * this.Size) float
+        try
+            matrix <- Some(new CppMatrix(this.Size, this.Size))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        matrix |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: Matrix Load (matrix_set per element)", Baseline = true)>]
+    member this.PerElementLoad() =
+        match matrix with
+        | Some m ->
+            let n = this.Size
+            for i in 0 .. n - 1 do
+                for j in 0 .. n - 1 do
+                    m.Set(i, j, values.[i * n + j])
+            m.Get(n - 1, n - 1)
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Matrix Load (matrix_copy_from_buffer)")>]
+    member this.BulkLoad() =
+        match matrix with
+        | Some m ->
+            m.CopyFrom(ReadOnlySpan<double>(values))
+            m.Get(this.Size - 1, this.Size - 1)
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Matrix Read (matrix_get per element)")>]
+    member this.PerElementRead() =
+        match matrix with
+        | Some m ->
+            let n = this.Size
+            let mutable sum = 0.0
+            for i in 0 .. n - 1 do
+                for j in 0 .. n - 1 do
+                    sum <- sum + m.Get(i, j)
+            sum
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Matrix Read (zero-copy span)")>]
+    member this.SpanRead() =
+        match matrix with
+        | Some m ->
+            let view = m.AsSpan()
+            let mutable sum = 0.0
+            for i in 0 .. view.Length - 1 do
+                sum <- sum + view.[i]
+            sum
+        | None -> 0.0
+
+// Cost of moving vector data across the P/Invoke boundary
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type VectorTransferBenchmarks() =
+    let mutable vector: CppVector option = None
+    let mutable values: int[] = [||]
+    
+    [<Params(1000, 100000, 1000000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        values <- Array.init this.Size id
+        try
+            let v = new CppVector()
+            v.AddRange(values)
+            vector <- Some v
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        vector |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: Vector Build (vector_add per element)", Baseline = true)>]
+    member this.PerElementBuild() =
+        try
+            use v = new CppVector()
+            for value in values do
+                v.Add(value)
+            v.Size
+        with
+        | _ -> 0
+    
+    [<Benchmark(Description = "C++: Vector Build (vector_add_range)")>]
+    member this.BulkBuild() =
+        try
+            use v = new CppVector()
+            v.AddRange(values)
+            v.Size
+        with
+        | _ -> 0
+    
+    [<Benchmark(Description = "C++: Vector Read (vector_get per element)")>]
+    member this.PerElementRead() =
+        match vector with
+        | Some v ->
+            let mutable sum = 0L
+            for i in 0 .. v.Size - 1 do
+                sum <- sum + int64 (v.Get(i))
+            sum
+        | None -> 0L
+    
+    [<Benchmark(Description = "C++: Vector Read (zero-copy span)")>]
+    member this.SpanRead() =
+        match vector with
+        | Some v ->
+            let view = v.AsSpan()
+            let mutable sum = 0L
+            for i in 0 .. view.Length - 1 do
+                sum <- sum + int64 view.[i]
+            sum
+        | None -> 0L
+
+// String traffic: marshalled managed strings in and out vs pinned UTF-8 spans and a pointer/length view
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type StringTransferBenchmarks() =
+    let mutable text = ""
+    let mutable utf8: byte[] = [||]
+    
+    [<Params(16, 1024)>]
+    member val public PieceLength = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        text <- String('x', this.PieceLength)
+        utf8 <- Text.Encoding.UTF8.GetBytes(text)
+    
+    [<Benchmark(Description = "C++: Append(string) x100 + Value", Baseline = true)>]
+    member this.Marshalled() =
+        try
+            use str = new CppString("")
+            for _ in 1 .. 100 do
+                str.Append(text)
+            str.Value.Length
+        with
+        | _ -> 0
+    
+    [<Benchmark(Description = "C++: AppendUtf8(span) x100 + AsUtf8Span")>]
+    member this.Utf8Span() =
+        try
+            use str = CppString.FromUtf8(ReadOnlySpan<byte>.Empty)
+            for _ in 1 .. 100 do
+                str.AppendUtf8(utf8)
+            str.AsUtf8Span().Length
+        with
+        | _ -> 0
+
+// Normalizing many short identifiers: one handle and three calls per string vs one batch call
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type StringBatchBenchmarks() =
+    let mutable identifiers: string[] = [||]
+    let mutable packed: byte[] = [||]
+    let mutable offsets: int[] = [||]
+    
+    [<Params(1000, 100000)>]
+    member val public Count = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        identifiers <- Array.init this.Count (fun i -> $"user_{random.Next()}_Name{i % 97}")
+        offsets <- Array.zeroCreate (this.Count + 1)
+        for i in 0 .. this.Count - 1 do
+            offsets.[i + 1] <- offsets.[i] + identifiers.[i].Length
+        packed <- Text.Encoding.UTF8.GetBytes(String.Concat(identifiers))
+    
+    [<Benchmark(Description = "F#: Array.map ToUpperInvariant", Baseline = true)>]
+    member this.FSharpUpper() =
+        (Array.map (fun (s: string) -> s.ToUpperInvariant()) identifiers).Length
+    
+    [<Benchmark(Description = "C++: CppString per identifier")>]
+    member this.CppPerString() =
+        try
+            let results = Array.zeroCreate<string> identifiers.Length
+            for i in 0 .. identifiers.Length - 1 do
+                use str = new CppString(identifiers.[i])
+                str.ToUpper()
+                results.[i] <- str.Value
+            results.Length
+        with
+        | _ -> 0
+    
+    [<Benchmark(Description = "C++: transformStrings (pack, one call, unpack)")>]
+    member this.CppBatch() =
+        try (transformStrings CppStringTransform.ToUpper identifiers).Length with _ -> 0
+    
+    [<Benchmark(Description = "C++: transformUtf8Batch (already packed)")>]
+    member this.CppBatchPacked() =
+        try
+            transformUtf8Batch(CppStringTransform.ToUpper, Span<byte>(packed), ReadOnlySpan<int>(offsets))
+            int packed.[0]
+        with
+        | _ -> 0
+
+// Assembling a large log document from prepends, appends and inserts, then writing it out
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type RopeStringBenchmarks() =
+    let line = Text.Encoding.UTF8.GetBytes(String('x', 63) + "\n")
+    
+    [<Params(10000, 100000)>]
+    member val public Lines = 0 with get, set
+    
+    member private this.Build(str: CppString) =
+        for i in 0 .. this.Lines - 1 do
+            match i % 8 with
+            | 0 -> str.PrependUtf8(line)
+            | 1 -> str.InsertUtf8(str.Length / 2, line)
+            | _ -> str.AppendUtf8(line)
+    
+    [<Benchmark(Description = "C++: flat string, Value", Baseline = true)>]
+    member this.Flat() =
+        try
+            use str = CppString.FromUtf8(ReadOnlySpan<byte>.Empty)
+            this.Build(str)
+            str.AsUtf8Span().Length
+        with
+        | _ -> 0
+    
+    [<Benchmark(Description = "C++: rope string, WriteTo (no flatten)")>]
+    member this.Rope() =
+        try
+            use str = CppString.Rope()
+            this.Build(str)
+            use sink = IO.Stream.Null
+            str.WriteTo(sink)
+            str.ChunkCount
+        with
+        | _ -> 0
+
+// Scanning a buffer through the iterator: one call per element vs batches and native search
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type IteratorBenchmarks() =
+    let mutable values: int[] = [||]
+    let mutable batch: int[] = Array.zeroCreate 4096
+    let mutable iterator: CppIterator option = None
+    
+    [<Params(100000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        values <- Array.init this.Size (fun _ -> random.Next(1000))
+        values.[this.Size - 1] <- -1
+        try iterator <- Some(CppIterator.Borrow(ReadOnlyMemory<int>(values))) with _ -> ()
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        iterator |> Option.iter (fun i -> (i :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: iterator_next per element", Baseline = true)>]
+    member this.PerElement() =
+        match iterator with
+        | Some it ->
+            it.Reset()
+            let mutable total = 0L
+            while it.HasNext do
+                total <- total + int64 (it.Next())
+            total
+        | None -> 0L
+    
+    [<Benchmark(Description = "C++: iterator_next_batch (4096)")>]
+    member this.Batched() =
+        match iterator with
+        | Some it ->
+            it.Reset()
+            let mutable total = 0L
+            let mutable read = it.NextBatch(Span<int>(batch))
+            while read > 0 do
+                for i in 0 .. read - 1 do
+                    total <- total + int64 batch.[i]
+                read <- it.NextBatch(Span<int>(batch))
+            total
+        | None -> 0L
+    
+    [<Benchmark(Description = "F#: Array.IndexOf (last element)")>]
+    member this.FSharpFind() = int64 (Array.IndexOf(values, -1))
+    
+    [<Benchmark(Description = "C++: iterator_find (SIMD, borrowed)")>]
+    member this.CppFind() =
+        match iterator with
+        | Some it -> if it.Find(-1) then 1L else 0L
+        | None -> 0L
+
+// Short-lived matrices: one heap allocation per object vs an arena reset per batch
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type ArenaBenchmarks() =
+    let mutable arena: CppArena option = None
+    let batch = 100
+    
+    [<Params(4, 16, 64)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        try
+            arena <- Some(new CppArena())
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        arena |> Option.iter (fun a -> (a :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: Matrix Multiply Batch (heap handles)", Baseline = true)>]
+    member this.HeapBatch() =
+        match arena with
+        | Some _ ->
+            let mutable trace = 0.0
+            for _ in 1 .. batch do
+                use a = new CppMatrix(this.Size, this.Size)
+                use b = new CppMatrix(this.Size, this.Size)
+                a.Set(0, 0, 2.0)
+                b.Set(0, 0, 3.0)
+                match a.Multiply(b) with
+                | Some product ->
+                    use product = product
+                    trace <- trace + product.Get(0, 0)
+                | None -> ()
+            trace
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Matrix Multiply Batch (arena)")>]
+    member this.ArenaBatch() =
+        match arena with
+        | Some scope ->
+            let mutable trace = 0.0
+            for _ in 1 .. batch do
+                let a = scope.CreateMatrix(this.Size, this.Size)
+                let b = scope.CreateMatrix(this.Size, this.Size)
+                a.Set(0, 0, 2.0)
+                b.Set(0, 0, 3.0)
+                match scope.Multiply(a, b) with
+                | Some product -> trace <- trace + product.Get(0, 0)
+                | None -> ()
+            scope.Reset()
+            trace
+        | None -> 0.0
+
+// One P/Invoke per pair vs one per batch
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type FunctionBatchBenchmarks() =
+    let mutable addFunc: CppFunction option = None
+    let mutable powerFunc: CppFunction option = None
+    let mutable left: double[] = [||]
+    let mutable right: double[] = [||]
+    let mutable output: double[] = [||]
+    
+    [<Params(1000, 100000, 1000000)>]
+    member val public Count = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        left <- Array.init this.Count (fun _ -> random.NextDouble() * 10.0)
+        right <- Array.init this.Count (fun _ -> random.NextDouble() * 2.0)
+        output <- Array.zeroCreate this.Count
+        try
+            addFunc <- Some(CppFunction.CreateAdd())
+            powerFunc <- Some(CppFunction.CreatePower())
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        [ addFunc; powerFunc ] |> List.iter (Option.iter (fun f -> (f :> IDisposable).Dispose()))
+    
+    [<Benchmark(Description = "F#: Array.map2 (+)", Baseline = true)>]
+    member this.FSharpAdd() =
+        let result = Array.map2 (+) left right
+        result.[0]
+    
+    [<Benchmark(Description = "C++: Add (function_call per pair)")>]
+    member this.CppAddPerCall() =
+        match addFunc with
+        | Some f ->
+            for i in 0 .. left.Length - 1 do
+                output.[i] <- f.Call(left.[i], right.[i])
+            output.[0]
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Add (function_call_batch)")>]
+    member this.CppAddBatch() =
+        match addFunc with
+        | Some f ->
+            f.CallBatch(ReadOnlySpan<double>(left), ReadOnlySpan<double>(right), Span<double>(output))
+            output.[0]
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Power (function_call per pair)")>]
+    member this.CppPowerPerCall() =
+        match powerFunc with
+        | Some f ->
+            for i in 0 .. left.Length - 1 do
+                output.[i] <- f.Call(left.[i], right.[i])
+            output.[0]
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: Power (function_call_batch)")>]
+    member this.CppPowerBatch() =
+        match powerFunc with
+        | Some f ->
+            f.CallBatch(ReadOnlySpan<double>(left), ReadOnlySpan<double>(right), Span<double>(output))
+            output.[0]
+        | None -> 0.0
+
+// Sort scaling across input sizes (random values spanning the full int range)
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<ScalingBenchmarkConfig>)>]
+type SortBenchmarks() =
+    let mutable values: int[] = [||]
+    let mutable vector: CppVector option = None
+    
+    [<Params(100, 1000, 10000, 100000, 1000000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    // Native worker count for the C++ radix sort; 0 uses every hardware thread
+    [<Params(1, 0)>]
+    member val public Threads = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        values <- Array.init this.Size (fun _ -> random.Next(Int32.MinValue, Int32.MaxValue))
+        try
+            cpp_set_num_threads(this.Threads)
+            let v = new CppVector()
+            v.Reserve(this.Size)
+            vector <- Some v
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        vector |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+        try cpp_set_num_threads(0) with _ -> ()
+    
+    [<Benchmark(Description = "F#: Array.sortInPlace", Baseline = true)>]
+    member this.FSharpSort() =
+        let arrayCopy = Array.copy values
+        Array.sortInPlace arrayCopy
+        arrayCopy.[0]
+    
+    [<Benchmark(Description = "C: sort_array (radix)")>]
+    member this.CSort() =
+        let arrayCopy = Array.copy values
+        sort_array(arrayCopy, arrayCopy.Length)
+        arrayCopy.[0]
+    
+    // Refilling the vector is the counterpart of the Array.copy above
+    [<Benchmark(Description = "C++: vector_sort (parallel radix)")>]
+    member this.CppVectorSort() =
+        match vector with
+        | Some v ->
+            v.Clear()
+            v.AddRange(values)
+            v.Sort()
+            v.Get(0)
+        | None -> 0
+
+// Fused statistics across input sizes; the C++ pairwise reduction splits large inputs across threads
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<ScalingBenchmarkConfig>)>]
+type StatisticsScalingBenchmarks() =
+    let mutable values: double[] = [||]
+    
+    [<Params(100, 1000, 10000, 100000, 1000000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    // Native worker count; 0 uses every hardware thread
+    [<Params(1, 0)>]
+    member val public Threads = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        values <- Array.init this.Size (fun _ -> random.NextDouble())
+        try cpp_set_num_threads(this.Threads) with _ -> ()
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        try cpp_set_num_threads(0) with _ -> ()
+    
+    [<Benchmark(Description = "F#: mean, variance, min, max (two passes)", Baseline = true)>]
+    member this.FSharpStatistics() =
+        let mean = Array.average values
+        let mutable squares = 0.0
+        let mutable minimum = Double.MaxValue
+        let mutable maximum = Double.MinValue
+        for x in values do
+            squares <- squares + (x - mean) * (x - mean)
+            minimum <- min minimum x
+            maximum <- max maximum x
+        squares / float values.Length + minimum + maximum
+    
+    [<Benchmark(Description = "C++: calculate_statistics (fused, parallel)")>]
+    member this.CppStatistics() =
+        try
+            let summary = calculateSummary values
+            summary.variance + summary.min + summary.max
+        with
+        | _ -> 0.0
+
+// Bulk vector operations across sizes: fill, reduce, copy back
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+[<Config(typeof<ScalingBenchmarkConfig>)>]
+type VectorScalingBenchmarks() =
+    let mutable values: int[] = [||]
+    let mutable destination: int[] = [||]
+    let mutable vector: CppVector option = None
+    
+    [<Params(100, 1000, 10000, 100000, 1000000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    // Native worker count; 0 uses every hardware thread
+    [<Params(1, 0)>]
+    member val public Threads = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        values <- Array.init this.Size (fun _ -> random.Next())
+        destination <- Array.zeroCreate this.Size
+        try
+            cpp_set_num_threads(this.Threads)
+            let v = new CppVector()
+            v.Reserve(this.Size)
+            vector <- Some v
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        vector |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+        try cpp_set_num_threads(0) with _ -> ()
+    
+    [<Benchmark(Description = "F#: ResizeArray fill, sum, copy", Baseline = true)>]
+    member this.FSharpVector() =
+        let list = ResizeArray<int>(values.Length)
+        list.AddRange(values)
+        let mutable total = 0L
+        for i in 0 .. list.Count - 1 do
+            total <- total + int64 list.[i]
+        list.CopyTo(destination)
+        total
+    
+    [<Benchmark(Description = "C++: AddRange, vector_sum_i64, CopyTo")>]
+    member this.CppVector() =
+        match vector with
+        | Some v ->
+            v.Clear()
+            v.AddRange(values)
+            let total = v.SumInt64()
+            v.CopyTo(Span<int>(destination))
+            total
+        | None -> 0L
+
+// 1000 lookups against a large vector: linear scan vs hash and sorted indexes
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type VectorIndexBenchmarks() =
+    let mutable probes: int[] = [||]
+    let mutable scanned: CppVector option = None
+    let mutable indexed: CppVector option = None
+    
+    [<Params(100000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        let values = Array.init this.Size (fun _ -> random.Next(this.Size * 4))
+        probes <- Array.init 1000 (fun _ -> random.Next(this.Size * 4))
+        try
+            let plain = new CppVector()
+            plain.AddRange(values)
+            scanned <- Some plain
+            let v = new CppVector()
+            v.AddRange(values)
+            v.BuildIndex(CppVectorIndex.Hash ||| CppVectorIndex.Sorted)
+            indexed <- Some v
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        scanned |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+        indexed |> Option.iter (fun v -> (v :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: vector_contains (linear scan)", Baseline = true)>]
+    member this.ContainsScan() =
+        match scanned with
+        | Some v -> probes |> Array.sumBy (fun p -> if v.Contains(p) then 1 else 0)
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: vector_contains (hash index)")>]
+    member this.ContainsHash() =
+        match indexed with
+        | Some v -> probes |> Array.sumBy (fun p -> if v.Contains(p) then 1 else 0)
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: vector_count_range (sorted index)")>]
+    member this.CountRangeSorted() =
+        match indexed with
+        | Some v -> probes |> Array.sumBy (fun p -> v.CountRange(p, p + 1000))
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: vector_build_index (hash + sorted)")>]
+    member this.BuildIndex() =
+        match scanned with
+        | Some v ->
+            v.BuildIndex(CppVectorIndex.Hash ||| CppVectorIndex.Sorted)
+            // Add drops the indexes again, so the next call rebuilds and the scan benchmark stays unindexed
+            v.Add(0)
+            v.Size
+        | None -> 0
+
+// Scratch-buffer traffic: per-element calls vs bulk fill/copy, and statistics read in place vs copied out
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type SmartResourceBenchmarks() =
+    let mutable values: double[] = [||]
+    let mutable resource: CppSmartResource option = None
+    
+    [<Params(1000000, 10000000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        values <- Array.init this.Size (fun _ -> random.NextDouble())
+        try
+            let r = new CppSmartResource(this.Size, CppResourceFlags.HugePages)
+            r.CopyFrom(0, ReadOnlySpan<double>(values))
+            resource <- Some r
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        resource |> Option.iter (fun r -> (r :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: smart_resource_use per element", Baseline = true)>]
+    member this.ScalarWrites() =
+        match resource with
+        | Some r ->
+            let handle = r.Handle
+            for i in 0 .. values.Length - 1 do
+                smart_resource_use(handle, i, values.[i])
+            r.Size
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: smart_resource_copy_in")>]
+    member this.BulkCopyIn() =
+        match resource with
+        | Some r ->
+            r.CopyFrom(0, ReadOnlySpan<double>(values))
+            r.Size
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: smart_resource_fill")>]
+    member this.BulkFill() =
+        match resource with
+        | Some r ->
+            r.Fill(0.5)
+            r.Size
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: copy_out + calculate_statistics")>]
+    member this.StatisticsCopied() =
+        match resource with
+        | Some r ->
+            let copy = Array.zeroCreate<double> values.Length
+            r.CopyTo(0, Span<double>(copy))
+            (calculateSummary copy).mean
+        | None -> 0.0
+    
+    [<Benchmark(Description = "C++: smart_resource_statistics (zero-copy)")>]
+    member this.StatisticsInPlace() =
+        match resource with
+        | Some r -> r.Statistics().mean
+        | None -> 0.0
+
+// Geometry: one P/Invoke per distance vs the SoA batch kernel, and brute-force vs k-d tree kNN
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type GeometryBenchmarks() =
+    let mutable points: Point[] = [||]
+    let mutable xs: double[] = [||]
+    let mutable ys: double[] = [||]
+    let mutable queryXs: double[] = [||]
+    let mutable queryYs: double[] = [||]
+    let mutable distances: double[] = [||]
+    let mutable index: PointIndex option = None
+    
+    [<Params(10000, 1000000)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        points <- Array.init this.Size (fun _ -> { x = random.Next(100000); y = random.Next(100000) })
+        xs <- points |> Array.map (fun p -> float p.x)
+        ys <- points |> Array.map (fun p -> float p.y)
+        queryXs <- Array.init 100 (fun _ -> random.NextDouble() * 100000.0)
+        queryYs <- Array.init 100 (fun _ -> random.NextDouble() * 100000.0)
+        distances <- Array.zeroCreate this.Size
+        try
+            index <- Some(new PointIndex(xs, ys))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        index |> Option.iter (fun i -> (i :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C: calculate_distance per pair", Baseline = true)>]
+    member this.ScalarDistances() =
+        let origin = { x = 0; y = 0 }
+        let mutable total = 0.0f
+        for p in points do
+            total <- total + calculate_distance(origin, p)
+        total
+    
+    [<Benchmark(Description = "C: calculate_distances_soa")>]
+    member this.BatchDistances() =
+        calculate_distances_soa(xs, ys, ys, xs, distances, xs.Length) |> ignore
+        distances.[0]
+    
+    // 100 queries, 8 neighbours each
+    [<Benchmark(Description = "C: kNN brute force via pairwise_distance_matrix rows")>]
+    member this.BruteForceKnn() =
+        let mutable total = 0.0
+        for q in 0 .. queryXs.Length - 1 do
+            pairwise_distance_matrix([| queryXs.[q] |], [| queryYs.[q] |], 1, xs, ys, xs.Length, distances) |> ignore
+            total <- total + (Array.sort distances).[7]
+        total
+    
+    [<Benchmark(Description = "C: point_index_knn_batch")>]
+    member this.IndexedKnn() =
+        match index with
+        | Some i ->
+            let _, found = i.NearestBatch(queryXs, queryYs, 8)
+            found.[7]
+        | None -> 0.0
+
+// pow(a * b + c, 2): three batch calls with temporaries vs one fused pipeline evaluation
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type FunctionPipelineBenchmarks() =
+    let mutable functions: CppFunction list = []
+    let mutable pipeline: CppFunction option = None
+    let mutable a: double[] = [||]
+    let mutable b: double[] = [||]
+    let mutable c: double[] = [||]
+    let mutable twos: double[] = [||]
+    let mutable temporary: double[] = [||]
+    let mutable output: double[] = [||]
+    
+    [<Params(1000, 1000000)>]
+    member val public Count = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        a <- Array.init this.Count (fun _ -> random.NextDouble())
+        b <- Array.init this.Count (fun _ -> random.NextDouble())
+        c <- Array.init this.Count (fun _ -> random.NextDouble())
+        twos <- Array.create this.Count 2.0
+        temporary <- Array.zeroCreate this.Count
+        output <- Array.zeroCreate this.Count
+        try
+            let add = CppFunction.CreateAdd()
+            let multiply = CppFunction.CreateMultiply()
+            let power = CppFunction.CreatePower()
+            let third = CppFunction.Input(2)
+            let two = CppFunction.Constant(2.0)
+            let sum = CppFunction.Compose(add, multiply, third)
+            functions <- [ add; multiply; power; third; two; sum ]
+            pipeline <- Some(CppFunction.Compose(power, sum, two))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        pipeline |> Option.iter (fun f -> (f :> IDisposable).Dispose())
+        functions |> List.iter (fun f -> (f :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "F#: Array.init (a * b + c) ** 2", Baseline = true)>]
+    member this.FSharpLoop() =
+        let result = Array.init a.Length (fun i -> (a.[i] * b.[i] + c.[i]) ** 2.0)
+        result.[0]
+    
+    [<Benchmark(Description = "C++: three function_call_batch passes")>]
+    member this.SeparateBatches() =
+        match functions with
+        | [ add; multiply; power; _; _; _ ] ->
+            multiply.CallBatch(ReadOnlySpan<double>(a), ReadOnlySpan<double>(b), Span<double>(temporary))
+            add.CallBatch(ReadOnlySpan<double>(temporary), ReadOnlySpan<double>(c), Span<double>(temporary))
+            power.CallBatch(ReadOnlySpan<double>(temporary), ReadOnlySpan<double>(twos), Span<double>(output))
+            output.[0]
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: fused function_evaluate")>]
+    member this.FusedPipeline() =
+        match pipeline with
+        | Some f ->
+            f.Evaluate([| ReadOnlyMemory<double>(a); ReadOnlyMemory<double>(b); ReadOnlyMemory<double>(c) |], Span<double>(output))
+            output.[0]
+        | None -> 0.0
+    
+    // Rebuilding the pipeline per query hits the kernel cache instead of recompiling
+    [<Benchmark(Description = "C++: function_compose per query (cached)")>]
+    member this.ComposeCached() =
+        match functions, pipeline with
+        | [ _; _; power; _; two; sum ], Some _ ->
+            use rebuilt = CppFunction.Compose(power, sum, two)
+            rebuilt.Arity
+        | _ -> 0
+
+// Repeated products of unchanged matrices: recomputed vs served from the result cache
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type MatrixResultCacheBenchmarks() =
+    let mutable left: CppMatrix option = None
+    let mutable right: CppMatrix option = None
+    
+    [<Params(64, 256)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        let create () = CppMatrix.FromArray(this.Size, this.Size, Array.init (this.Size * this.Size) (fun _ -> random.NextDouble()))
+        try
+            left <- Some(create ())
+            right <- Some(create ())
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        CppMatrix.SetResultCacheBudget(0L)
+        [ left; right ] |> List.iter (Option.iter (fun m -> (m :> IDisposable).Dispose()))
+    
+    member private this.Multiply() =
+        match left, right with
+        | Some a, Some b ->
+            use product = (a.Multiply(b)).Value
+            product.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: matrix_multiply (cache off)", Baseline = true)>]
+    member this.Uncached() =
+        CppMatrix.SetResultCacheBudget(0L)
+        this.Multiply()
+    
+    [<Benchmark(Description = "C++: matrix_multiply (cache hit)")>]
+    member this.Cached() =
+        if CppMatrix.ResultCacheStatistics.budget = 0L then CppMatrix.SetResultCacheBudget(64L <<< 20)
+        this.Multiply()
+
+// Graph-like matrix with 8 nonzeros per row (under 1% dense): dense vs CSR
+[<SimpleJob(RuntimeMoniker.Net80)>]
+[<MemoryDiagnoser>]
+type SparseMatrixBenchmarks() =
+    let mutable dense: CppMatrix option = None
+    let mutable sparse: CppSparseMatrix option = None
+    let mutable operand: CppMatrix option = None
+    let mutable x: double[] = [||]
+    let mutable y: double[] = [||]
+    
+    [<Params(1024)>]
+    member val public Size = 0 with get, set
+    
+    [<GlobalSetup>]
+    member this.Setup() =
+        let random = Random(42)
+        let n = this.Size
+        let rows = Array.init (n * 8) (fun i -> i / 8)
+        let cols = Array.init (n * 8) (fun _ -> random.Next(n))
+        let values = Array.init (n * 8) (fun _ -> random.NextDouble())
+        x <- Array.init n (fun _ -> random.NextDouble())
+        y <- Array.zeroCreate n
+        try
+            let matrix = CppSparseMatrix.FromCoo(n, n, rows, cols, values)
+            sparse <- Some matrix
+            dense <- Some(matrix.ToDense())
+            operand <- Some(CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble())))
+        with
+        | _ -> () // Skip setup if libraries not available
+    
+    [<GlobalCleanup>]
+    member this.Cleanup() =
+        [ dense; operand ] |> List.iter (Option.iter (fun m -> (m :> IDisposable).Dispose()))
+        sparse |> Option.iter (fun m -> (m :> IDisposable).Dispose())
+    
+    [<Benchmark(Description = "C++: matrix_multiply (dense)", Baseline = true)>]
+    member this.DenseMultiply() =
+        match dense, operand with
+        | Some a, Some b ->
+            use product = (a.Multiply(b)).Value
+            product.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: sparse_matrix_multiply_dense")>]
+    member this.SparseMultiply() =
+        match sparse, operand with
+        | Some a, Some b ->
+            use product = a.Multiply(b)
+            product.Get(0, 0)
+        | _ -> 0.0
+    
+    [<Benchmark(Description = "C++: sparse_matrix_multiply (SpGEMM)")>]
+    member this.SparseSquare() =
+        match sparse with
+        | Some a ->
+            use product = a.Multiply(a)
+            product.NonZeroCount
+        | None -> 0
+    
+    [<Benchmark(Description = "C++: sparse_matrix_spmv")>]
+    member this.MultiplyVector() =
+        match sparse with
+        | Some a ->
+            a.MultiplyVector(ReadOnlySpan<double>(x), Span<double>(y))
+            y.[0]
+        | None -> 0.0
+
 // Library availability check
 type LibraryChecker() =
     static member CheckAvailability() =
@@ -41,7 +41,9 @@ let printBenchmarkOptions() =
     printfn "  1. Full Performance Benchmarks (F# vs C vs C++ operations)"
     printfn "  2. Micro Benchmarks (scaled array operations with size analysis)"
     printfn "  3. Quick Performance Test (subset of benchmarks)"
-    printfn "  4. Exit"
+    printfn "  4. Matrix Multiply Benchmarks (GFLOP/s at 16 to 2048)"
+    printfn "  5. Scaling Benchmarks (sizes 10^2 to 10^7 and thread counts, with throughput)"
+    printfn "  6. Exit"
     printfn ""
 
 let runQuickTest() =
@@ -50,6 +52,8 @@ let runQuickTest() =
     printfn ""
     
     try
+        (try cpp_stats_reset() with _ -> ())
+        
         // F# baseline test
         let startTime1 = DateTime.Now
         let mutable fsharpSum = 0
@@ -89,6 +93,13 @@ let runQuickTest() =
         printfn ""
         printfn "For detailed benchmarks with statistical analysis, run the full benchmarks."
         
+        // The quick test runs in this process, so native counters from an
+        // INSTRUMENT=1 build describe exactly the calls above
+        if cpp_stats_enabled() = 1 then
+            printfn ""
+            printfn "Native instrumentation (libcpp_operations.so):"
+            printf "%s" (formatNativeStats (nativeStatsSnapshot()))
+        
     with
     | ex -> printfn "Error running quick test: %s" ex.Message
 
@@ -104,7 +115,7 @@ let main argv =
         
         while keepRunning do
             printBenchmarkOptions()
-            printf "Select option (1-4): "
+            printf "Select option (1-6): "
             let input = Console.ReadLine()
             
             match input with
@@ -143,11 +154,45 @@ let main argv =
                 printfn ""
                 
             | "4" ->
+                printfn ""
+                printfn "Running Matrix Multiply Benchmarks (F# vs C++ blocked GEMM)..."
+                printfn "Throughput is reported in the GFLOP/s column."
+                printfn ""
+                try
+                    BenchmarkRunner.Run<MatrixMultiplyBenchmarks>() |> ignore
+                    printfn ""
+                    printfn "✅ Matrix benchmarks completed!"
+                with
+                | ex -> 
+                    printfn "❌ Benchmark failed: %s" ex.Message
+                    result <- 1
+                
+            | "5" ->
+                printfn ""
+                printfn "Running Scaling Benchmarks (sort, reductions, statistics, vectors, matrices)..."
+                printfn "Each suite sweeps Size and, for the parallel paths, Threads (1 and all cores)."
+                printfn "Throughput is reported in the Melem/s and GFLOP/s columns."
+                printfn ""
+                try
+                    BenchmarkRunner.Run<SortBenchmarks>() |> ignore
+                    BenchmarkRunner.Run<ReductionBenchmarks>() |> ignore
+                    BenchmarkRunner.Run<StatisticsScalingBenchmarks>() |> ignore
+                    BenchmarkRunner.Run<VectorScalingBenchmarks>() |> ignore
+                    BenchmarkRunner.Run<MatrixMultiplyBenchmarks>() |> ignore
+                    BenchmarkRunner.Run<MatrixTransposeBenchmarks>() |> ignore
+                    printfn ""
+                    printfn "✅ Scaling benchmarks completed!"
+                with
+                | ex -> 
+                    printfn "❌ Benchmark failed: %s" ex.Message
+                    result <- 1
+                
+            | "6" ->
                 keepRunning <- false
                 printfn "Goodbye!"
                 
             | _ ->
-                printfn "Invalid option. Please select 1-4."
+                printfn "Invalid option. Please select 1-6."
                 printfn ""
         
         result
@@ -0,0 +1,317 @@
+// Native-only microbenchmarks for the kernels behind libcpp_operations.so and
+// libmath_operations.so. The library source is compiled into this binary, so the
+// internal classes (BasicMatrix, SparseMatrix, VectorWrapper, StringWrapper, the
+// statistics templates) are timed directly with no P/Invoke in the loop. Comparing these
+// numbers with the BenchmarkDotNet results separates boundary cost from kernel cost.
+//
+// Output follows the Google Benchmark JSON layout (context + benchmarks[] with
+// real_time in ns and items_per_second), so its comparison tools can read it.
+//
+//   make bench-native
+//   build/bench_native --filter=matrix --min-time=0.5 --out=results.json
+
+#include "cpp_operations.cpp"
+#include "math_operations.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// Stops the optimizer from discarding a result, like benchmark::DoNotOptimize
+template<typename T>
+static void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchOptions {
+    std::string filter;
+    double min_time = 0.2;
+    std::string out;
+};
+
+struct BenchResult {
+    std::string name;
+    long long iterations;
+    double ns_per_iteration;
+    double items_per_second;
+    std::string label;
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options) : options_(options) {}
+
+    // Times body() until min_time has elapsed; items is the work done per call
+    void run(const std::string& name, double items, const char* label, const std::function<void()>& body) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+        body();
+        long long iterations = 1;
+        double elapsed = 0.0;
+        for (;;) {
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++) body();
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= options_.min_time || iterations >= (1LL << 30)) break;
+            // Aim slightly past min_time so the final batch is usually the last
+            double scale = elapsed > 0.0 ? options_.min_time * 1.4 / elapsed : 10.0;
+            iterations = std::max(iterations + 1, static_cast<long long>(iterations * std::min(scale, 10.0)));
+        }
+        BenchResult result{name, iterations, elapsed * 1e9 / iterations, items * iterations / elapsed, label};
+        std::fprintf(stderr, "%-44s %12.0f ns %14.3e %s/s\n", name.c_str(), result.ns_per_iteration,
+                     result.items_per_second, label);
+        results_.push_back(result);
+    }
+
+    std::string json() const {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        std::ostringstream out;
+        out << "{\n  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"executable\": \"bench_native\",\n"
+            << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"library_build_type\": \"release\"\n"
+            << "  },\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results_.size(); i++) {
+            const BenchResult& r = results_[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"name\": \"" << r.name << "\", \"run_name\": \"" << r.name << "\", "
+                << "\"run_type\": \"iteration\", \"iterations\": " << r.iterations << ", "
+                << "\"real_time\": " << r.ns_per_iteration << ", \"cpu_time\": " << r.ns_per_iteration << ", "
+                << "\"time_unit\": \"ns\", \"items_per_second\": " << r.items_per_second << ", "
+                << "\"label\": \"" << r.label << "\"}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+private:
+    BenchOptions options_;
+    std::vector<BenchResult> results_;
+};
+
+// threads < 0 marks a single-threaded kernel, which gets no threads: suffix
+static std::string case_name(const char* kernel, long long size, int threads) {
+    std::ostringstream name;
+    name << kernel << "/" << size;
+    if (threads > 0) name << "/threads:" << threads;
+    return name.str();
+}
+
+static std::vector<int> random_ints(std::size_t count) {
+    std::mt19937 random(42);
+    std::vector<int> values(count);
+    for (int& v : values) v = static_cast<int>(random());
+    return values;
+}
+
+static std::vector<double> random_doubles(std::size_t count) {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> values(count);
+    for (double& v : values) v = uniform(random);
+    return values;
+}
+
+// Native worker counts swept by the parallel kernels: one thread, then every hardware thread
+static std::vector<int> thread_counts() {
+    std::vector<int> counts{1};
+    if (default_thread_count() > 1) counts.push_back(default_thread_count());
+    return counts;
+}
+
+static void bench_matrix(BenchRunner& runner) {
+    for (int n : {64, 256, 1024}) {
+        std::vector<double> values = random_doubles(static_cast<std::size_t>(n) * n);
+        Matrix a(n, n), b(n, n), c(n, n);
+        a.copy_from(values.data());
+        b.copy_from(values.data());
+        for (int threads : thread_counts()) {
+            cpp_set_num_threads(threads);
+            runner.run(case_name("matrix_multiply", n, threads), 2.0 * n * n * n, "flop", [&] {
+                c.gemm(1.0, a, b, 0.0);
+                keep(c.get(0, 0));
+            });
+        }
+        cpp_set_num_threads(0);
+    }
+    for (int n : {64, 256, 1024, 2048}) {
+        std::vector<double> values = random_doubles(static_cast<std::size_t>(n) * n);
+        Matrix a(n, n), t(n, n);
+        a.copy_from(values.data());
+        runner.run(case_name("matrix_transpose", n, -1), static_cast<double>(n) * n, "element", [&] {
+            a.transpose_into(t);
+            keep(t.get(0, 0));
+        });
+    }
+}
+
+// Graph-like n x n matrices with about 8 nonzeros per row
+static void bench_sparse(BenchRunner& runner) {
+    for (int n : {4096, 65536}) {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> column(0, n - 1);
+        std::vector<int> rows, cols;
+        for (int r = 0; r < n; r++) {
+            for (int k = 0; k < 8; k++) {
+                rows.push_back(r);
+                cols.push_back(column(random));
+            }
+        }
+        std::vector<double> values = random_doubles(rows.size());
+        auto a = SparseMatrix::from_coo(n, n, rows.data(), cols.data(), values.data(), static_cast<int>(rows.size()));
+        std::vector<double> x = random_doubles(n), y(n);
+        Matrix dense(n, 16);
+        dense.copy_from(random_doubles(static_cast<std::size_t>(n) * 16).data());
+        for (int threads : thread_counts()) {
+            cpp_set_num_threads(threads);
+            runner.run(case_name("sparse_spmv", n, threads), 2.0 * a->nnz(), "flop", [&] {
+                a->spmv(x.data(), y.data());
+                keep(y[0]);
+            });
+            runner.run(case_name("sparse_multiply_dense", n, threads), 2.0 * a->nnz() * 16, "flop", [&] {
+                keep(a->multiply(dense)->get(0, 0));
+            });
+            runner.run(case_name("sparse_multiply_sparse", n, threads), a->nnz(), "nonzero", [&] {
+                keep(a->multiply(*a)->nnz());
+            });
+        }
+        cpp_set_num_threads(0);
+    }
+}
+
+static void bench_statistics(BenchRunner& runner) {
+    for (int n : {1000, 100000, 10000000}) {
+        std::vector<double> values = random_doubles(n);
+        for (int threads : thread_counts()) {
+            cpp_set_num_threads(threads);
+            runner.run(case_name("calculate_mean", n, threads), n, "element", [&] {
+                keep(calculate_mean_template(values.data(), n));
+            });
+            runner.run(case_name("calculate_variance", n, threads), n, "element", [&] {
+                keep(calculate_variance_template(values.data(), n));
+            });
+        }
+        cpp_set_num_threads(0);
+    }
+}
+
+static void bench_vector(BenchRunner& runner) {
+    for (int n : {1000, 100000, 10000000}) {
+        std::vector<int> values = random_ints(n);
+        VectorWrapper vector;
+        vector.reserve(n);
+        vector.add_range(values.data(), n);
+        for (int threads : thread_counts()) {
+            cpp_set_num_threads(threads);
+            runner.run(case_name("vector_sum_i64", n, threads), n, "element", [&] {
+                keep(vector.sum_i64());
+            });
+            // Each iteration restores the unsorted input, as the interop benchmarks do
+            runner.run(case_name("vector_sort", n, threads), n, "element", [&] {
+                vector.clear();
+                vector.add_range(values.data(), n);
+                vector.sort();
+                keep(vector.get(0));
+            });
+        }
+        cpp_set_num_threads(0);
+        runner.run(case_name("vector_add_range", n, -1), n, "element", [&] {
+            vector.clear();
+            vector.add_range(values.data(), n);
+            keep(vector.size());
+        });
+    }
+}
+
+static void bench_string(BenchRunner& runner) {
+    for (int n : {1000, 1000000}) {
+        std::string text(n, 'a');
+        for (int i = 0; i < n; i += 7) text[i] = 'Q';
+        StringWrapper wrapper(text);
+        runner.run(case_name("string_to_upper", n, -1), n, "byte", [&] {
+            wrapper.to_upper();
+            keep(wrapper.c_str()[0]);
+        });
+        runner.run(case_name("string_to_lower", n, -1), n, "byte", [&] {
+            wrapper.to_lower();
+            keep(wrapper.c_str()[0]);
+        });
+        runner.run(case_name("string_reverse", n, -1), n, "byte", [&] {
+            wrapper.reverse();
+            keep(wrapper.c_str()[0]);
+        });
+        // Builds an n-byte string from 16-byte pieces
+        runner.run(case_name("string_append", n, -1), n, "byte", [&] {
+            StringWrapper built;
+            for (int i = 0; i < n; i += 16) built.append("0123456789abcdef");
+            keep(built.length());
+        });
+        runner.run(case_name("string_prepend", n, -1), n, "byte", [&] {
+            StringWrapper built;
+            for (int i = 0; i < n; i += 16) built.prepend("0123456789abcdef");
+            keep(built.length());
+        });
+    }
+}
+
+static void bench_sort_array(BenchRunner& runner) {
+    for (int n : {1000, 100000, 10000000}) {
+        std::vector<int> values = random_ints(n);
+        std::vector<int> scratch(n);
+        runner.run(case_name("sort_array", n, -1), n, "element", [&] {
+            std::memcpy(scratch.data(), values.data(), n * sizeof(int));
+            sort_array(scratch.data(), n);
+            keep(scratch[0]);
+        });
+    }
+}
+
+static bool parse_options(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            options.filter = arg.substr(9);
+        } else if (arg.compare(0, 11, "--min-time=") == 0) {
+            options.min_time = std::atof(arg.c_str() + 11);
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            options.out = arg.substr(6);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=substring] [--min-time=seconds] [--out=file.json]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) return 2;
+
+    BenchRunner runner(options);
+    bench_matrix(runner);
+    bench_sparse(runner);
+    bench_statistics(runner);
+    bench_vector(runner);
+    bench_string(runner);
+    bench_sort_array(runner);
+
+    std::string json = runner.json();
+    if (options.out.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        std::ofstream file(options.out);
+        file << json;
+        if (!file) {
+            std::fprintf(stderr, "Failed to write %s\n", options.out.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "Wrote %s\n", options.out.c_str());
+    }
+    return 0;
+}
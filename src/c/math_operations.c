@@ -5,6 +5,12 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 // Global buffer for string operations (simple approach for demo)
 static char greeting_buffer[256];
 
@@ -59,10 +65,12 @@ Point create_point(int x, int y) {
     return p;
 }
 
+// Differences are taken in double: int subtraction and squaring overflow once
+// coordinates pass about 23170
 float calculate_distance(Point p1, Point p2) {
-    int dx = p2.x - p1.x;
-    int dy = p2.y - p1.y;
-    return sqrt(dx * dx + dy * dy);
+    double dx = (double)p2.x - (double)p1.x;
+    double dy = (double)p2.y - (double)p1.y;
+    return (float)sqrt(dx * dx + dy * dy);
 }
 
 Rectangle create_rectangle(float width, float height) {
@@ -76,6 +84,369 @@ float rectangle_area(Rectangle rect) {
     return rect.width * rect.height;
 }
 
+// Batch geometry kernels over structure-of-arrays coordinates. Two doubles per
+// SSE2/NEON register; the scalar loops finish the tail and cover other targets.
+#if defined(__x86_64__) || defined(__i386__)
+#define GEOMETRY_SSE2 1
+#elif defined(__aarch64__)
+#define GEOMETRY_NEON 1
+#endif
+
+ResultCode calculate_distances_soa(const double* xs1, const double* ys1,
+                                   const double* xs2, const double* ys2,
+                                   double* out, int n) {
+    if (n < 0) {
+        return RESULT_INVALID_PARAMETER;
+    }
+    if (n == 0) {
+        return RESULT_SUCCESS;
+    }
+    if (xs1 == NULL || ys1 == NULL || xs2 == NULL || ys2 == NULL || out == NULL) {
+        return RESULT_NULL_POINTER;
+    }
+
+    int i = 0;
+#if defined(GEOMETRY_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs2 + i), _mm_loadu_pd(xs1 + i));
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys2 + i), _mm_loadu_pd(ys1 + i));
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(d2));
+    }
+#elif defined(GEOMETRY_NEON)
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs2 + i), vld1q_f64(xs1 + i));
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys2 + i), vld1q_f64(ys1 + i));
+        vst1q_f64(out + i, vsqrtq_f64(vfmaq_f64(vmulq_f64(dx, dx), dy, dy)));
+    }
+#endif
+    for (; i < n; i++) {
+        double dx = xs2[i] - xs1[i];
+        double dy = ys2[i] - ys1[i];
+        out[i] = sqrt(dx * dx + dy * dy);
+    }
+    return RESULT_SUCCESS;
+}
+
+// Distances from (x, y) to each of the n points in xs/ys
+static void distance_row(double x, double y, const double* xs, const double* ys, double* out, int n) {
+    int i = 0;
+#if defined(GEOMETRY_SSE2)
+    __m128d qx = _mm_set1_pd(x);
+    __m128d qy = _mm_set1_pd(y);
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), qx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), qy);
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(d2));
+    }
+#elif defined(GEOMETRY_NEON)
+    float64x2_t qx = vdupq_n_f64(x);
+    float64x2_t qy = vdupq_n_f64(y);
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), qx);
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), qy);
+        vst1q_f64(out + i, vsqrtq_f64(vfmaq_f64(vmulq_f64(dx, dx), dy, dy)));
+    }
+#endif
+    for (; i < n; i++) {
+        double dx = xs[i] - x;
+        double dy = ys[i] - y;
+        out[i] = sqrt(dx * dx + dy * dy);
+    }
+}
+
+ResultCode pairwise_distance_matrix(const double* xs1, const double* ys1, int n1,
+                                    const double* xs2, const double* ys2, int n2,
+                                    double* out) {
+    if (n1 < 0 || n2 < 0) {
+        return RESULT_INVALID_PARAMETER;
+    }
+    if (n1 == 0 || n2 == 0) {
+        return RESULT_SUCCESS;
+    }
+    if (xs1 == NULL || ys1 == NULL || xs2 == NULL || ys2 == NULL || out == NULL) {
+        return RESULT_NULL_POINTER;
+    }
+
+    for (int i = 0; i < n1; i++) {
+        distance_row(xs1[i], ys1[i], xs2, ys2, out + (size_t)i * (size_t)n2, n2);
+    }
+    return RESULT_SUCCESS;
+}
+
+ResultCode rectangle_areas_batch(const Rectangle* rects, float* out, int n) {
+    if (n < 0) {
+        return RESULT_INVALID_PARAMETER;
+    }
+    if (n == 0) {
+        return RESULT_SUCCESS;
+    }
+    if (rects == NULL || out == NULL) {
+        return RESULT_NULL_POINTER;
+    }
+
+    int i = 0;
+    const float* fields = (const float*)rects;
+#if defined(GEOMETRY_SSE2)
+    // Four rectangles are eight interleaved floats; split them into widths and heights
+    for (; i + 4 <= n; i += 4) {
+        __m128 lo = _mm_loadu_ps(fields + 2 * i);
+        __m128 hi = _mm_loadu_ps(fields + 2 * i + 4);
+        __m128 widths = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 heights = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + i, _mm_mul_ps(widths, heights));
+    }
+#elif defined(GEOMETRY_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t pair = vld2q_f32(fields + 2 * i);
+        vst1q_f32(out + i, vmulq_f32(pair.val[0], pair.val[1]));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = rects[i].width * rects[i].height;
+    }
+    return RESULT_SUCCESS;
+}
+
+// Nearest-neighbour index: an implicit k-d tree. Points are permuted so that the
+// median of every range [lo, hi) sits at (lo + hi) / 2, splitting on x at even
+// depths and y at odd ones; the tree needs no node pointers.
+struct PointIndex {
+    int count;
+    double* xs;
+    double* ys;
+    int* ids;
+};
+
+static void point_index_swap(PointIndex* index, int a, int b) {
+    double x = index->xs[a];
+    double y = index->ys[a];
+    int id = index->ids[a];
+    index->xs[a] = index->xs[b];
+    index->ys[a] = index->ys[b];
+    index->ids[a] = index->ids[b];
+    index->xs[b] = x;
+    index->ys[b] = y;
+    index->ids[b] = id;
+}
+
+// Quickselect over [lo, hi) so position nth holds the nth smallest key on the axis
+static void point_index_select(PointIndex* index, int lo, int hi, int nth, int axis) {
+    hi--;
+    while (lo < hi) {
+        const double* keys = axis == 0 ? index->xs : index->ys;
+        int mid = lo + (hi - lo) / 2;
+        // Median of three as the pivot keeps sorted input from degrading
+        if (keys[mid] < keys[lo]) point_index_swap(index, mid, lo);
+        if (keys[hi] < keys[lo]) point_index_swap(index, hi, lo);
+        if (keys[hi] < keys[mid]) point_index_swap(index, hi, mid);
+        double pivot = keys[mid];
+
+        int i = lo;
+        int j = hi;
+        while (i <= j) {
+            while (keys[i] < pivot) i++;
+            while (keys[j] > pivot) j--;
+            if (i <= j) {
+                point_index_swap(index, i, j);
+                i++;
+                j--;
+            }
+        }
+        if (nth <= j) {
+            hi = j;
+        } else if (nth >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+static void point_index_build(PointIndex* index, int lo, int hi, int axis) {
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        point_index_select(index, lo, hi, mid, axis);
+        point_index_build(index, lo, mid, axis ^ 1);
+        lo = mid + 1;
+        axis ^= 1;
+    }
+}
+
+PointIndex* point_index_create(const double* xs, const double* ys, int count) {
+    if (xs == NULL || ys == NULL || count <= 0) {
+        return NULL;
+    }
+
+    PointIndex* index = (PointIndex*)malloc(sizeof(PointIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->count = count;
+    index->xs = (double*)malloc((size_t)count * sizeof(double));
+    index->ys = (double*)malloc((size_t)count * sizeof(double));
+    index->ids = (int*)malloc((size_t)count * sizeof(int));
+    if (index->xs == NULL || index->ys == NULL || index->ids == NULL) {
+        point_index_destroy(index);
+        return NULL;
+    }
+
+    memcpy(index->xs, xs, (size_t)count * sizeof(double));
+    memcpy(index->ys, ys, (size_t)count * sizeof(double));
+    for (int i = 0; i < count; i++) {
+        index->ids[i] = i;
+    }
+    point_index_build(index, 0, count, 0);
+    return index;
+}
+
+void point_index_destroy(PointIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->xs);
+    free(index->ys);
+    free(index->ids);
+    free(index);
+}
+
+int point_index_size(const PointIndex* index) {
+    return index == NULL ? 0 : index->count;
+}
+
+// Bounded max-heap of the best candidates so far, keyed on squared distance and
+// then on input position so ties resolve the same way on every query
+typedef struct {
+    double* d2;
+    int* ids;
+    int size;
+    int capacity;
+} NeighbourHeap;
+
+static int neighbour_worse(const NeighbourHeap* heap, int a, int b) {
+    return heap->d2[a] > heap->d2[b] || (heap->d2[a] == heap->d2[b] && heap->ids[a] > heap->ids[b]);
+}
+
+static void neighbour_heap_swap(NeighbourHeap* heap, int a, int b) {
+    double d2 = heap->d2[a];
+    int id = heap->ids[a];
+    heap->d2[a] = heap->d2[b];
+    heap->ids[a] = heap->ids[b];
+    heap->d2[b] = d2;
+    heap->ids[b] = id;
+}
+
+static void neighbour_sift_down(NeighbourHeap* heap, int root, int end) {
+    while (2 * root + 1 < end) {
+        int child = 2 * root + 1;
+        if (child + 1 < end && neighbour_worse(heap, child + 1, child)) {
+            child++;
+        }
+        if (!neighbour_worse(heap, child, root)) {
+            return;
+        }
+        neighbour_heap_swap(heap, root, child);
+        root = child;
+    }
+}
+
+static void neighbour_offer(NeighbourHeap* heap, double d2, int id) {
+    if (heap->size < heap->capacity) {
+        int child = heap->size++;
+        heap->d2[child] = d2;
+        heap->ids[child] = id;
+        while (child > 0) {
+            int parent = (child - 1) / 2;
+            if (!neighbour_worse(heap, child, parent)) {
+                break;
+            }
+            neighbour_heap_swap(heap, child, parent);
+            child = parent;
+        }
+        return;
+    }
+    if (d2 > heap->d2[0] || (d2 == heap->d2[0] && id > heap->ids[0])) {
+        return;
+    }
+    heap->d2[0] = d2;
+    heap->ids[0] = id;
+    neighbour_sift_down(heap, 0, heap->size);
+}
+
+static void point_index_search(const PointIndex* index, int lo, int hi, int axis,
+                               double x, double y, NeighbourHeap* heap) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        double dx = index->xs[mid] - x;
+        double dy = index->ys[mid] - y;
+        neighbour_offer(heap, dx * dx + dy * dy, index->ids[mid]);
+
+        // Descend into the query's side first; the far side only matters if the
+        // splitting line is closer than the current k-th best
+        double split = axis == 0 ? x - index->xs[mid] : y - index->ys[mid];
+        int near_lo = split < 0 ? lo : mid + 1;
+        int near_hi = split < 0 ? mid : hi;
+        point_index_search(index, near_lo, near_hi, axis ^ 1, x, y, heap);
+
+        if (heap->size == heap->capacity && split * split > heap->d2[0]) {
+            return;
+        }
+        lo = split < 0 ? mid + 1 : lo;
+        hi = split < 0 ? hi : mid;
+        axis ^= 1;
+    }
+}
+
+int point_index_knn(const PointIndex* index, double x, double y, int k, int* indices, double* distances) {
+    if (index == NULL || indices == NULL || distances == NULL) {
+        return -1;
+    }
+    if (k <= 0) {
+        return 0;
+    }
+
+    // The caller's buffers are the heap, then get sorted closest first in place
+    NeighbourHeap heap = { distances, indices, 0, k < index->count ? k : index->count };
+    point_index_search(index, 0, index->count, 0, x, y, &heap);
+    for (int end = heap.size - 1; end > 0; end--) {
+        neighbour_heap_swap(&heap, 0, end);
+        neighbour_sift_down(&heap, 0, end);
+    }
+    for (int i = 0; i < heap.size; i++) {
+        distances[i] = sqrt(distances[i]);
+    }
+    return heap.size;
+}
+
+ResultCode point_index_knn_batch(const PointIndex* index, const double* xs, const double* ys, int queries,
+                                 int k, int* indices, double* distances) {
+    if (queries < 0 || k < 0) {
+        return RESULT_INVALID_PARAMETER;
+    }
+    if (index == NULL) {
+        return RESULT_NULL_POINTER;
+    }
+    if (queries == 0 || k == 0) {
+        return RESULT_SUCCESS;
+    }
+    if (xs == NULL || ys == NULL || indices == NULL || distances == NULL) {
+        return RESULT_NULL_POINTER;
+    }
+
+    for (int q = 0; q < queries; q++) {
+        int* row_indices = indices + (size_t)q * (size_t)k;
+        double* row_distances = distances + (size_t)q * (size_t)k;
+        int found = point_index_knn(index, xs[q], ys[q], k, row_indices, row_distances);
+        // Rows are always k wide; slots past the point count are marked unused
+        for (int i = found; i < k; i++) {
+            row_indices[i] = -1;
+            row_distances[i] = INFINITY;
+        }
+    }
+    return RESULT_SUCCESS;
+}
+
 // Array operations
 void fill_array(int* array, int size, int value) {
     if (array == NULL || size <= 0) {
@@ -87,33 +458,148 @@ void fill_array(int* array, int size, int value) {
     }
 }
 
-int sum_array(const int* array, int size) {
+// Four independent accumulators break the loop-carried dependency and let the
+// compiler vectorize; integer sums are exact, so the order does not matter.
+long long sum_array_i64(const int* array, int size) {
     if (array == NULL || size <= 0) {
         return 0;
     }
     
-    int sum = 0;
+    long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        s0 += array[i];
+        s1 += array[i + 1];
+        s2 += array[i + 2];
+        s3 += array[i + 3];
+    }
+    for (; i < size; i++) {
+        s0 += array[i];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+// Wraps on overflow; use sum_array_i64 for the exact sum
+int sum_array(const int* array, int size) {
+    return (int)(unsigned int)sum_array_i64(array, size);
+}
+
+// Sorting
+// Arrays shorter than this are insertion sorted; radix passes cost more than they save
+#define SORT_INSERTION_THRESHOLD 64
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (32 / RADIX_BITS)
+
+static void insertion_sort(int* array, int size) {
+    for (int i = 1; i < size; i++) {
+        int value = array[i];
+        int j = i - 1;
+        while (j >= 0 && array[j] > value) {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = value;
+    }
+}
+
+static void sift_down(int* array, int start, int end) {
+    int root = start;
+    while (2 * root + 1 < end) {
+        int child = 2 * root + 1;
+        if (child + 1 < end && array[child] < array[child + 1]) {
+            child++;
+        }
+        if (array[root] >= array[child]) {
+            return;
+        }
+        int temp = array[root];
+        array[root] = array[child];
+        array[child] = temp;
+        root = child;
+    }
+}
+
+// In-place O(n log n) fallback when the radix scratch buffer cannot be allocated
+static void heap_sort(int* array, int size) {
+    for (int start = size / 2 - 1; start >= 0; start--) {
+        sift_down(array, start, size);
+    }
+    for (int end = size - 1; end > 0; end--) {
+        int temp = array[0];
+        array[0] = array[end];
+        array[end] = temp;
+        sift_down(array, 0, end);
+    }
+}
+
+// Flip the sign bit so signed order matches unsigned byte order
+static unsigned int radix_key(int value) {
+    return (unsigned int)value ^ 0x80000000u;
+}
+
+// LSD radix sort: one pass builds all byte histograms, then up to four stable
+// scatter passes alternate between the array and a scratch buffer. Passes whose
+// byte is identical for every element are skipped.
+static void radix_sort(int* array, int size, int* scratch) {
+    size_t counts[RADIX_PASSES][RADIX_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+
     for (int i = 0; i < size; i++) {
-        sum += array[i];
+        unsigned int key = radix_key(array[i]);
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    int* source = array;
+    int* destination = scratch;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        size_t* count = counts[pass];
+        int shift = pass * RADIX_BITS;
+        if (count[(radix_key(source[0]) >> shift) & (RADIX_BUCKETS - 1)] == (size_t)size) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            size_t bucket_count = count[bucket];
+            count[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (int i = 0; i < size; i++) {
+            int value = source[i];
+            destination[count[(radix_key(value) >> shift) & (RADIX_BUCKETS - 1)]++] = value;
+        }
+
+        int* temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    if (source != array) {
+        memcpy(array, source, (size_t)size * sizeof(int));
     }
-    return sum;
 }
 
-// Simple bubble sort for demo
 void sort_array(int* array, int size) {
     if (array == NULL || size <= 1) {
         return;
     }
-    
-    for (int i = 0; i < size - 1; i++) {
-        for (int j = 0; j < size - i - 1; j++) {
-            if (array[j] > array[j + 1]) {
-                int temp = array[j];
-                array[j] = array[j + 1];
-                array[j + 1] = temp;
-            }
-        }
+
+    if (size < SORT_INSERTION_THRESHOLD) {
+        insertion_sort(array, size);
+        return;
+    }
+
+    int* scratch = (int*)malloc((size_t)size * sizeof(int));
+    if (scratch == NULL) {
+        heap_sort(array, size);
+        return;
     }
+    radix_sort(array, size, scratch);
+    free(scratch);
 }
 
 // Callback function
@@ -35,6 +35,7 @@ float rectangle_area(Rectangle rect);
 // Array operations
 void fill_array(int* array, int size, int value);
 int sum_array(const int* array, int size);
+long long sum_array_i64(const int* array, int size);
 void sort_array(int* array, int size);
 
 // Callback function type
@@ -52,6 +53,35 @@ typedef enum {
 ResultCode safe_divide(double a, double b, double* result);
 ResultCode validate_array(const int* array, int size);
 
+// Batch geometry over parallel coordinate arrays. Each returns RESULT_SUCCESS,
+// RESULT_NULL_POINTER for a missing array or RESULT_INVALID_PARAMETER for a
+// negative count; n == 0 is a no-op.
+// out[i] = distance from (xs1[i], ys1[i]) to (xs2[i], ys2[i])
+ResultCode calculate_distances_soa(const double* xs1, const double* ys1,
+                                   const double* xs2, const double* ys2,
+                                   double* out, int n);
+// out is n1 x n2 row-major: out[i * n2 + j] = distance from point i of set 1 to point j of set 2
+ResultCode pairwise_distance_matrix(const double* xs1, const double* ys1, int n1,
+                                    const double* xs2, const double* ys2, int n2,
+                                    double* out);
+ResultCode rectangle_areas_batch(const Rectangle* rects, float* out, int n);
+
+// k-nearest-neighbour index over a fixed point set (a k-d tree). The points are
+// copied, so the input arrays can be released once create returns; it returns
+// NULL for a null array, count <= 0 or allocation failure.
+typedef struct PointIndex PointIndex;
+PointIndex* point_index_create(const double* xs, const double* ys, int count);
+void point_index_destroy(PointIndex* index);
+int point_index_size(const PointIndex* index);
+// Writes the min(k, size) points nearest (x, y), closest first: their input
+// positions to indices and distances to distances, both of length k. Ties go to
+// the lower position. Returns the number written, or -1 for a null argument.
+int point_index_knn(const PointIndex* index, double x, double y, int k, int* indices, double* distances);
+// Runs one query per (xs[q], ys[q]); row q of indices/distances (k wide) holds its
+// answer, with -1 / INFINITY in slots past the index size
+ResultCode point_index_knn_batch(const PointIndex* index, const double* xs, const double* ys, int queries,
+                                 int k, int* indices, double* distances);
+
 // Memory management
 char* allocate_string(int length);
 void free_string(char* str);
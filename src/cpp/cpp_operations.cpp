@@ -9,556 +9,5877 @@
 #include <iostream>
 #include <stdexcept>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <exception>
+#include <limits>
+#include <array>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <chrono>
 
-// Global error message for exception handling
-static std::string last_error_message;
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <cerrno>
+#include <cctype>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-// C++ Vector wrapper class
+// Per-thread error state. The message lives in a fixed buffer so recording an
+// error never allocates, and callers on different threads never see each other's errors.
+static const std::size_t kErrorMessageCapacity = 256;
+
+struct ErrorState {
+    CppResultCode code = CPP_SUCCESS;
+    char message[kErrorMessageCapacity] = {};
+};
+
+static ErrorState& error_state() {
+    static thread_local ErrorState state;
+    return state;
+}
+
+static void set_last_error(CppResultCode code, const char* message) {
+    ErrorState& state = error_state();
+    state.code = code;
+    std::strncpy(state.message, message ? message : "", kErrorMessageCapacity - 1);
+    state.message[kErrorMessageCapacity - 1] = '\0';
+}
+
+static CppResultCode set_last_error(const std::exception& e) {
+    CppResultCode code = CPP_UNKNOWN_ERROR;
+    if (dynamic_cast<const std::bad_alloc*>(&e)) code = CPP_MEMORY_ERROR;
+    else if (dynamic_cast<const std::out_of_range*>(&e)) code = CPP_OUT_OF_BOUNDS;
+    else if (dynamic_cast<const std::system_error*>(&e)) code = CPP_IO_ERROR;
+    else if (dynamic_cast<const std::logic_error*>(&e)) code = CPP_INVALID_OPERATION;
+    set_last_error(code, e.what());
+    return code;
+}
+
+// Opt-in instrumentation behind cpp_stats_*, compiled in with make INSTRUMENT=1.
+// Exported functions register themselves as sites on their first call. Each
+// thread counts into its own block with relaxed single-writer atomics, so the
+// hot path never locks or contends; a snapshot sums the live blocks with the
+// totals of threads that have exited. Reset records a baseline rather than
+// clearing counters that belong to other threads.
+#ifdef CPP_INSTRUMENT
+static const int kMaxInstrumentSites = 256;
+static const int kInstrumentFields = 3 + CPP_STATS_HISTOGRAM_BUCKETS;
+
+// calls, nanoseconds, bytes, then the latency histogram
+struct SiteCounters {
+    std::atomic<std::uint64_t> fields[kInstrumentFields];
+};
+
+struct ThreadInstrument {
+    SiteCounters sites[kMaxInstrumentSites];
+    int current_site = -1;
+};
+
+static inline void instrument_add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+class InstrumentRegistry {
+public:
+    int register_site(const char* name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (site_count_ == kMaxInstrumentSites) return -1;
+        names_[site_count_] = name;
+        return site_count_++;
+    }
+
+    void attach(ThreadInstrument* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(block);
+    }
+
+    // Folds an exiting thread's counts into the retired totals
+    void detach(ThreadInstrument* block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int site = 0; site < site_count_; site++) {
+            for (int field = 0; field < kInstrumentFields; field++) {
+                retired_[site][field] += block->sites[site].fields[field].load(std::memory_order_relaxed);
+            }
+        }
+        threads_.erase(std::remove(threads_.begin(), threads_.end(), block), threads_.end());
+    }
+
+    int snapshot(CppFunctionStats* entries, int capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int active = 0;
+        for (int site = 0; site < site_count_; site++) {
+            std::uint64_t totals[kInstrumentFields];
+            collect(site, totals);
+            for (int field = 0; field < kInstrumentFields; field++) {
+                totals[field] -= baseline_[site][field];
+            }
+            if (totals[0] == 0) continue;
+            if (entries && active < capacity) {
+                CppFunctionStats& entry = entries[active];
+                entry.name = names_[site];
+                entry.calls = static_cast<long long>(totals[0]);
+                entry.total_ns = static_cast<long long>(totals[1]);
+                entry.bytes_allocated = static_cast<long long>(totals[2]);
+                for (int bucket = 0; bucket < CPP_STATS_HISTOGRAM_BUCKETS; bucket++) {
+                    entry.histogram[bucket] = static_cast<long long>(totals[3 + bucket]);
+                }
+            }
+            active++;
+        }
+        return active;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int site = 0; site < site_count_; site++) {
+            collect(site, baseline_[site]);
+        }
+    }
+
+private:
+    void collect(int site, std::uint64_t* totals) const {
+        for (int field = 0; field < kInstrumentFields; field++) {
+            totals[field] = retired_[site][field];
+        }
+        for (const ThreadInstrument* block : threads_) {
+            for (int field = 0; field < kInstrumentFields; field++) {
+                totals[field] += block->sites[site].fields[field].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    const char* names_[kMaxInstrumentSites] = {};
+    int site_count_ = 0;
+    std::vector<ThreadInstrument*> threads_;
+    std::uint64_t retired_[kMaxInstrumentSites][kInstrumentFields] = {};
+    std::uint64_t baseline_[kMaxInstrumentSites][kInstrumentFields] = {};
+};
+
+// Never destroyed: threads can exit after static destructors have run
+static InstrumentRegistry& instrument_registry() {
+    static InstrumentRegistry* registry = new InstrumentRegistry();
+    return *registry;
+}
+
+struct ThreadInstrumentSlot {
+    ThreadInstrument* block;
+    ThreadInstrumentSlot() : block(new ThreadInstrument()) { instrument_registry().attach(block); }
+    ~ThreadInstrumentSlot() {
+        instrument_registry().detach(block);
+        delete block;
+    }
+};
+
+static ThreadInstrument& thread_instrument() {
+    static thread_local ThreadInstrumentSlot slot;
+    return *slot.block;
+}
+
+// Times one call; allocations made while it is innermost are charged to it
+class InstrumentScope {
+public:
+    explicit InstrumentScope(int site)
+        : thread_(thread_instrument()), site_(site), parent_(thread_.current_site),
+          start_(std::chrono::steady_clock::now()) {
+        if (site_ >= 0) thread_.current_site = site_;
+    }
+
+    ~InstrumentScope() {
+        if (site_ < 0) return;
+        std::uint64_t elapsed = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+        int bucket = elapsed == 0 ? 0 : std::min(63 - __builtin_clzll(elapsed), CPP_STATS_HISTOGRAM_BUCKETS - 1);
+        SiteCounters& counters = thread_.sites[site_];
+        instrument_add(counters.fields[0], 1);
+        instrument_add(counters.fields[1], elapsed);
+        instrument_add(counters.fields[3 + bucket], 1);
+        thread_.current_site = parent_;
+    }
+
+    InstrumentScope(const InstrumentScope&) = delete;
+    InstrumentScope& operator=(const InstrumentScope&) = delete;
+
+private:
+    ThreadInstrument& thread_;
+    int site_;
+    int parent_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+static inline void instrument_allocation(std::size_t bytes) {
+    ThreadInstrument& thread = thread_instrument();
+    if (thread.current_site >= 0) instrument_add(thread.sites[thread.current_site].fields[2], bytes);
+}
+
+// Counts an event under its own name; it shows up in snapshots with calls = count
+static inline void instrument_event(int site) {
+    if (site >= 0) instrument_add(thread_instrument().sites[site].fields[0], 1);
+}
+
+#define CPP_INSTRUMENT_FUNCTION() \
+    static const int cpp_instrument_site = instrument_registry().register_site(__func__); \
+    InstrumentScope cpp_instrument_scope(cpp_instrument_site)
+#define CPP_INSTRUMENT_EVENT(name) \
+    do { \
+        static const int cpp_event_site = instrument_registry().register_site(name); \
+        instrument_event(cpp_event_site); \
+    } while (0)
+#else
+#define CPP_INSTRUMENT_FUNCTION() ((void)0)
+#define CPP_INSTRUMENT_EVENT(name) ((void)0)
+
+static inline void instrument_allocation(std::size_t) {}
+#endif
+
+// Radix sort and int64 sum over the thread pool, defined with the other parallel kernels below
+static void radix_sort_int32(int* data, std::size_t count);
+static long long sum_int32(const int* data, std::size_t count);
+static std::size_t find_int32(const int* data, std::size_t count, std::size_t start, int value);
+
+// Open-addressing (linear probing) set of the distinct values, kept at most
+// half full. INT_MIN marks an empty slot, so its membership is a separate flag.
+static const int kEmptySlot = std::numeric_limits<int>::min();
+
+class HashIndex {
+public:
+    explicit HashIndex(const std::vector<int>& values) {
+        std::size_t capacity = 16;
+        while (capacity < values.size() * 2) capacity <<= 1;
+        unsigned shift = 32;
+        for (std::size_t c = capacity; c > 1; c >>= 1) shift--;
+        shift_ = shift;
+        mask_ = capacity - 1;
+        slots_.assign(capacity, kEmptySlot);
+        for (int value : values) insert(value);
+    }
+
+    bool contains(int value) const {
+        if (value == kEmptySlot) return has_empty_key_;
+        for (std::size_t slot = home(value);; slot = (slot + 1) & mask_) {
+            if (slots_[slot] == value) return true;
+            if (slots_[slot] == kEmptySlot) return false;
+        }
+    }
+
+private:
+    // Fibonacci hashing: the top bits of a multiplicative hash index the table
+    std::size_t home(int value) const {
+        return (static_cast<std::uint32_t>(value) * 0x9E3779B1u) >> shift_;
+    }
+
+    void insert(int value) {
+        if (value == kEmptySlot) {
+            has_empty_key_ = true;
+            return;
+        }
+        std::size_t slot = home(value);
+        while (slots_[slot] != kEmptySlot && slots_[slot] != value) slot = (slot + 1) & mask_;
+        slots_[slot] = value;
+    }
+
+    std::vector<int> slots_;
+    std::size_t mask_ = 0;
+    unsigned shift_ = 0;
+    bool has_empty_key_ = false;
+};
+
+// Sorted copy in Eytzinger (BFS heap) order: node k has children 2k and 2k+1,
+// so a search walks one cache line per level and the next levels can be
+// prefetched. rank_[k] is node k's position in sorted order.
+class SortedIndex {
+public:
+    explicit SortedIndex(const std::vector<int>& values)
+        : size_(values.size()), nodes_(values.size() + 1), rank_(values.size() + 1) {
+        std::vector<int> sorted(values);
+        radix_sort_int32(sorted.data(), sorted.size());
+        std::size_t next = 0;
+        fill(sorted, 1, next);
+    }
+
+    // Number of elements less than value
+    std::size_t lower_bound(int value) const {
+        std::size_t k = 1;
+        while (k <= size_) {
+            __builtin_prefetch(nodes_.data() + std::min(k * 16, size_));
+            k = 2 * k + (nodes_[k] < value);
+        }
+        // Undo the right turns taken after the last left turn; k == 0 means every element is smaller
+        k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+        return k == 0 ? size_ : rank_[k];
+    }
+
+private:
+    void fill(const std::vector<int>& sorted, std::size_t k, std::size_t& next) {
+        if (k > size_) return;
+        fill(sorted, 2 * k, next);
+        nodes_[k] = sorted[next];
+        rank_[k] = static_cast<int>(next++);
+        fill(sorted, 2 * k + 1, next);
+    }
+
+    std::size_t size_;
+    std::vector<int> nodes_;
+    std::vector<int> rank_;
+};
+
+// C++ Vector wrapper class. The optional indexes are dropped whenever the contents change.
 class VectorWrapper {
 private:
     std::vector<int> data;
+    std::unique_ptr<HashIndex> hash_index_;
+    std::unique_ptr<SortedIndex> sorted_index_;
+    
+    void invalidate() {
+        hash_index_.reset();
+        sorted_index_.reset();
+    }
     
 public:
-    void add(int value) { data.push_back(value); }
+    void add(int value) {
+        invalidate();
+        data.push_back(value);
+    }
     int get(int index) const { return data.at(index); }
     int size() const { return static_cast<int>(data.size()); }
-    void clear() { data.clear(); }
+    void clear() {
+        invalidate();
+        data.clear();
+    }
+    void reserve(std::size_t capacity) { data.reserve(capacity); }
+    const int* data_ptr() const { return data.data(); }
     
+    void build_index(bool hash, bool sorted) {
+        if (hash && !hash_index_) hash_index_.reset(new HashIndex(data));
+        if (sorted && !sorted_index_) sorted_index_.reset(new SortedIndex(data));
+    }
+    
+    int index_kinds() const {
+        return (hash_index_ ? CPP_VECTOR_INDEX_HASH : 0) | (sorted_index_ ? CPP_VECTOR_INDEX_SORTED : 0);
+    }
+    
+    // Lookups use an index when one is built and fall back to a linear scan otherwise
+    bool contains(int value) const {
+        if (hash_index_) return hash_index_->contains(value);
+        if (sorted_index_) return count_range(value, value) > 0;
+        return find_int32(data.data(), data.size(), 0, value) < data.size();
+    }
+    
+    std::size_t count_below(int value) const {
+        if (sorted_index_) return sorted_index_->lower_bound(value);
+        std::size_t count = 0;
+        for (int v : data) count += v < value;
+        return count;
+    }
+    
+    // Elements in [low, high]
+    std::size_t count_range(int low, int high) const {
+        if (low > high) return 0;
+        return count_below_or_equal(high) - count_below(low);
+    }
+    
+    void add_range(const int* values, std::size_t count) {
+        invalidate();
+        const int* begin = data.data();
+        std::less<const int*> before;
+        bool aliased = !data.empty() && !before(values, begin) && before(values, begin + data.size());
+        if (!aliased) {
+            data.insert(data.end(), values, values + count);
+            return;
+        }
+        // The source is our own storage (e.g. from vector_data), which growing would invalidate
+        std::size_t offset = static_cast<std::size_t>(values - begin);
+        std::size_t old_size = data.size();
+        data.resize(old_size + count);
+        std::memcpy(data.data() + old_size, data.data() + offset, count * sizeof(int));
+    }
+    
+    void copy_to(int* buffer) const {
+        std::memcpy(buffer, data.data(), data.size() * sizeof(int));
+    }
+    
+    // The int result wraps on overflow; sum_i64 is exact
     int sum() const {
-        return std::accumulate(data.begin(), data.end(), 0);
+        return static_cast<int>(static_cast<std::uint32_t>(sum_i64()));
+    }
+    
+    long long sum_i64() const {
+        return sum_int32(data.data(), data.size());
     }
     
+    // Sorting keeps the same values, so both indexes stay valid
     void sort() {
-        std::sort(data.begin(), data.end());
+        radix_sort_int32(data.data(), data.size());
+    }
+
+private:
+    std::size_t count_below_or_equal(int value) const {
+        return value == std::numeric_limits<int>::max() ? data.size() : count_below(value + 1);
     }
 };
 
-// C++ String wrapper class
-class StringWrapper {
+// UTF-8 text transforms. ASCII letters flip bit 0x20; 16-byte blocks with no
+// high bit set stay in the vector loop, and any other block takes the scalar
+// path, which also folds two-byte Latin-1 letters (U+00C0..U+00FE). Other
+// non-ASCII sequences are left untouched, so the byte length never changes.
+static const std::size_t kTextBlock = 16;
+
+static std::size_t fold_case_step(char* text, std::size_t count, std::size_t i, bool upper) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c < 0x80) {
+        unsigned char first = upper ? 'a' : 'A';
+        if (static_cast<unsigned char>(c - first) < 26) text[i] = static_cast<char>(c ^ 0x20);
+        return i + 1;
+    }
+    // 0xC3 leads U+00C0..U+00FF; lower and upper case differ by 0x20 in the trailing byte
+    if (c == 0xC3 && i + 1 < count && (static_cast<unsigned char>(text[i + 1]) & 0xC0) == 0x80) {
+        unsigned char code = static_cast<unsigned char>(0xC0 | (text[i + 1] & 0x3F));
+        if (upper && code >= 0xE0 && code <= 0xFE && code != 0xF7) text[i + 1] = static_cast<char>(text[i + 1] - 0x20);
+        if (!upper && code >= 0xC0 && code <= 0xDE && code != 0xD7) text[i + 1] = static_cast<char>(text[i + 1] + 0x20);
+        return i + 2;
+    }
+    return i + 1;
+}
+
+static void fold_case(char* text, std::size_t count, bool upper) {
+    std::size_t i = 0;
+    while (i < count) {
+        if (i + kTextBlock <= count) {
+#if defined(__x86_64__) || defined(__i386__)
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            if (_mm_movemask_epi8(v) == 0) {
+                // Signed compares are safe here: every byte is below 0x80
+                char first = upper ? 'a' : 'A';
+                __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(first - 1))),
+                                                 _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(first + 26))));
+                v = _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(text + i), v);
+                i += kTextBlock;
+                continue;
+            }
+#elif defined(__aarch64__)
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i));
+            if (vmaxvq_u8(v) < 0x80) {
+                uint8x16_t in_range = vcltq_u8(vsubq_u8(v, vdupq_n_u8(upper ? 'a' : 'A')), vdupq_n_u8(26));
+                v = veorq_u8(v, vandq_u8(in_range, vdupq_n_u8(0x20)));
+                vst1q_u8(reinterpret_cast<uint8_t*>(text + i), v);
+                i += kTextBlock;
+                continue;
+            }
+#endif
+        }
+        // Finish the current block a byte (or sequence) at a time, then retry the vector path
+        std::size_t stop = std::min(count, i + kTextBlock);
+        while (i < stop) i = fold_case_step(text, count, i, upper);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline __m128i reverse_bytes(__m128i v) {
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+#endif
+
+// Reverses code points: the bytes are reversed wholesale, then each multi-byte
+// sequence (now continuation bytes followed by their lead) is flipped back
+static void reverse_utf8(char* text, std::size_t count) {
+    std::size_t front = 0, back = count;
+#if defined(__x86_64__) || defined(__i386__)
+    for (; front + 2 * kTextBlock <= back; front += kTextBlock, back -= kTextBlock) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + front));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + back - kTextBlock));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(text + front), reverse_bytes(tail));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(text + back - kTextBlock), reverse_bytes(head));
+    }
+#elif defined(__aarch64__)
+    for (; front + 2 * kTextBlock <= back; front += kTextBlock, back -= kTextBlock) {
+        uint8x16_t head = vld1q_u8(reinterpret_cast<const uint8_t*>(text + front));
+        uint8x16_t tail = vld1q_u8(reinterpret_cast<const uint8_t*>(text + back - kTextBlock));
+        uint8x16_t r_tail = vrev64q_u8(tail), r_head = vrev64q_u8(head);
+        vst1q_u8(reinterpret_cast<uint8_t*>(text + front), vextq_u8(r_tail, r_tail, 8));
+        vst1q_u8(reinterpret_cast<uint8_t*>(text + back - kTextBlock), vextq_u8(r_head, r_head, 8));
+    }
+#endif
+    std::reverse(text + front, text + back);
+
+    for (std::size_t i = 0; i < count; i++) {
+#if defined(__x86_64__) || defined(__i386__)
+        // Skip ASCII-only blocks
+        while (i + kTextBlock <= count &&
+               _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i))) == 0) {
+            i += kTextBlock;
+        }
+        if (i >= count) break;
+#endif
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) continue;
+        std::size_t start = i;
+        while (i < count && (static_cast<unsigned char>(text[i]) & 0xC0) == 0x80) i++;
+        // A stray continuation run with no lead byte is left as it is
+        if (i < count && static_cast<unsigned char>(text[i]) >= 0xC0) std::reverse(text + start, text + i + 1);
+    }
+}
+
+// Chunked text for large append/prepend/insert-heavy strings: an implicit
+// treap of chunks ordered by position, where every node caches the bytes and
+// chunk count of its subtree. Edits split and merge in expected O(log n) and
+// never copy existing chunks, except that small edits at either end are folded
+// into the end chunk while it stays under kRopeChunk bytes.
+static const std::size_t kRopeChunk = 4096;
+
+class Rope {
 private:
-    std::string data;
+    struct Node {
+        std::string text;
+        std::uint32_t priority;
+        std::size_t bytes = 0;
+        int chunks = 0;
+        std::unique_ptr<Node> left, right;
+    };
+    typedef std::unique_ptr<Node> NodePtr;
     
-public:
-    StringWrapper(const std::string& initial = "") : data(initial) {}
+    NodePtr root_;
+    std::uint32_t seed_ = 0x9E3779B9u;
+    std::string empty_;
     
-    const char* c_str() const { return data.c_str(); }
-    void append(const std::string& text) { data += text; }
-    void prepend(const std::string& text) { data = text + data; }
-    int length() const { return static_cast<int>(data.length()); }
+    static std::size_t bytes(const NodePtr& node) { return node ? node->bytes : 0; }
+    static int chunks(const NodePtr& node) { return node ? node->chunks : 0; }
     
-    void reverse() {
-        std::reverse(data.begin(), data.end());
+    static void update(Node* node) {
+        node->bytes = bytes(node->left) + node->text.size() + bytes(node->right);
+        node->chunks = chunks(node->left) + 1 + chunks(node->right);
     }
     
-    void to_upper() {
-        std::transform(data.begin(), data.end(), data.begin(), ::toupper);
+    NodePtr make_node(std::string text) {
+        // xorshift32 priorities keep the expected depth logarithmic
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        NodePtr node(new Node());
+        node->text = std::move(text);
+        node->priority = seed_;
+        update(node.get());
+        return node;
     }
     
-    void to_lower() {
-        std::transform(data.begin(), data.end(), data.begin(), ::tolower);
+    static NodePtr merge(NodePtr a, NodePtr b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) {
+            a->right = merge(std::move(a->right), std::move(b));
+            update(a.get());
+            return a;
+        }
+        b->left = merge(std::move(a), std::move(b->left));
+        update(b.get());
+        return b;
     }
-};
-
-// C++ Matrix class
-class Matrix {
-private:
-    std::vector<std::vector<double>> data;
-    int rows_, cols_;
     
-public:
-    Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
-        data.resize(rows, std::vector<double>(cols, 0.0));
+    // Splits into [0, offset) and [offset, size); a chunk spanning offset is cut in two
+    void split(NodePtr node, std::size_t offset, NodePtr& left, NodePtr& right) {
+        if (!node) {
+            left.reset();
+            right.reset();
+            return;
+        }
+        std::size_t before = bytes(node->left);
+        std::size_t after = before + node->text.size();
+        if (offset <= before) {
+            split(std::move(node->left), offset, left, node->left);
+            update(node.get());
+            right = std::move(node);
+        } else if (offset >= after) {
+            split(std::move(node->right), offset - after, node->right, right);
+            update(node.get());
+            left = std::move(node);
+        } else {
+            NodePtr tail = make_node(node->text.substr(offset - before));
+            node->text.resize(offset - before);
+            NodePtr rest = std::move(node->right);
+            update(node.get());
+            left = std::move(node);
+            right = merge(std::move(tail), std::move(rest));
+        }
     }
     
-    void set(int row, int col, double value) {
-        data.at(row).at(col) = value;
+    // Path from the root to the first (or last) chunk
+    std::vector<Node*> spine(bool rightmost) const {
+        std::vector<Node*> path;
+        for (Node* node = root_.get(); node; node = rightmost ? node->right.get() : node->left.get()) {
+            path.push_back(node);
+        }
+        return path;
     }
     
-    double get(int row, int col) const {
-        return data.at(row).at(col);
+    template<typename F>
+    static void visit(const Node* node, F& f) {
+        if (!node) return;
+        visit(node->left.get(), f);
+        f(node->text);
+        visit(node->right.get(), f);
     }
     
-    int rows() const { return rows_; }
-    int cols() const { return cols_; }
+public:
+    std::size_t size() const { return bytes(root_); }
+    int chunk_count() const { return chunks(root_); }
     
-    std::unique_ptr<Matrix> multiply(const Matrix& other) const {
-        if (cols_ != other.rows_) {
-            throw std::invalid_argument("Matrix dimensions don't match for multiplication");
-        }
-        
-        auto result = std::make_unique<Matrix>(rows_, other.cols_);
-        for (int i = 0; i < rows_; i++) {
-            for (int j = 0; j < other.cols_; j++) {
-                double sum = 0.0;
-                for (int k = 0; k < cols_; k++) {
-                    sum += data[i][k] * other.data[k][j];
-                }
-                result->set(i, j, sum);
+    void insert(std::size_t offset, const char* text, std::size_t count) {
+        if (count == 0) return;
+        std::size_t total = size();
+        if (offset > total) throw std::out_of_range("Insert offset is past the end of the string");
+        if (offset == 0 || offset == total) {
+            std::vector<Node*> path = spine(offset == total);
+            if (!path.empty() && path.back()->text.size() + count <= kRopeChunk) {
+                // The source may alias this chunk, so copy it out before the chunk moves
+                std::string piece(text, count);
+                std::string& edge = path.back()->text;
+                if (offset == 0) edge.insert(0, piece); else edge.append(piece);
+                for (auto it = path.rbegin(); it != path.rend(); ++it) update(*it);
+                return;
             }
         }
-        return result;
+        NodePtr piece = make_node(std::string(text, count));
+        NodePtr left, right;
+        split(std::move(root_), offset, left, right);
+        root_ = merge(merge(std::move(left), std::move(piece)), std::move(right));
     }
     
-    std::unique_ptr<Matrix> transpose() const {
-        auto result = std::make_unique<Matrix>(cols_, rows_);
-        for (int i = 0; i < rows_; i++) {
-            for (int j = 0; j < cols_; j++) {
-                result->set(j, i, data[i][j]);
+    const std::string& chunk_at(int index) const {
+        if (index < 0 || index >= chunk_count()) throw std::out_of_range("Chunk index out of range");
+        const Node* node = root_.get();
+        for (;;) {
+            int before = chunks(node->left);
+            if (index < before) {
+                node = node->left.get();
+            } else if (index == before) {
+                return node->text;
+            } else {
+                index -= before + 1;
+                node = node->right.get();
             }
         }
-        return result;
     }
     
-    void print() const {
-        for (int i = 0; i < rows_; i++) {
-            for (int j = 0; j < cols_; j++) {
-                std::cout << data[i][j] << " ";
-            }
-            std::cout << std::endl;
+    // Collapses every chunk into one contiguous chunk and returns it
+    std::string& flatten() {
+        if (!root_) return empty_;
+        if (root_->chunks > 1) {
+            std::string flat;
+            flat.reserve(size());
+            auto copy = [&flat](const std::string& text) { flat += text; };
+            visit(root_.get(), copy);
+            root_ = make_node(std::move(flat));
         }
+        return root_->text;
     }
 };
 
-// Smart Resource class demonstrating RAII
-class SmartResource {
+// C++ String wrapper class. The text sits at the end of buffer_ behind
+// front_ spare bytes, so prepend fills that headroom in place and only
+// regrows (doubling) when it runs out: amortized O(1) per byte, like append.
+// Strings created as ropes keep their text in rope_ instead; c_str() and the
+// whole-string transforms flatten it first, chunk_at reads it as it is.
+class StringWrapper {
 private:
-    std::unique_ptr<double[]> data;
-    int size_;
+    std::string buffer_;
+    std::size_t front_ = 0;
+    std::unique_ptr<Rope> rope_;
+    
+    char* text() { return rope_ ? &rope_->flatten()[0] : &buffer_[front_]; }
     
 public:
-    SmartResource(int size) : size_(size), data(std::make_unique<double[]>(size)) {
-        // Initialize with zeros
-        for (int i = 0; i < size; i++) {
-            data[i] = 0.0;
+    StringWrapper(const std::string& initial = "") : buffer_(initial) {}
+    
+    static std::unique_ptr<StringWrapper> rope(const char* text, std::size_t count) {
+        std::unique_ptr<StringWrapper> wrapper(new StringWrapper());
+        wrapper->rope_.reset(new Rope());
+        wrapper->rope_->insert(0, text, count);
+        return wrapper;
+    }
+    
+    const char* c_str() { return rope_ ? rope_->flatten().c_str() : buffer_.c_str() + front_; }
+    std::size_t byte_length() const { return rope_ ? rope_->size() : buffer_.size() - front_; }
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void prepend(const std::string& text) { prepend(text.data(), text.size()); }
+    int length() const { return static_cast<int>(byte_length()); }
+    
+    // Length-delimited byte ranges; the text may contain NULs and may point into this string
+    void append(const char* text, std::size_t count) {
+        if (rope_) {
+            rope_->insert(rope_->size(), text, count);
+        } else {
+            buffer_.append(text, count);
         }
     }
     
-    void set(int index, double value) {
-        if (index >= 0 && index < size_) {
-            data[index] = value;
+    void prepend(const char* text, std::size_t count) {
+        if (rope_) {
+            rope_->insert(0, text, count);
+            return;
         }
+        if (count <= front_) {
+            front_ -= count;
+            std::memmove(&buffer_[front_], text, count);
+            return;
+        }
+        // The source may alias the old buffer, so build the new one before releasing it
+        std::size_t size = byte_length();
+        std::size_t headroom = std::max(count, size);
+        std::string grown;
+        grown.reserve(headroom + count + size);
+        grown.append(headroom, '\0');
+        grown.append(text, count);
+        grown.append(c_str(), size);
+        buffer_.swap(grown);
+        front_ = headroom;
     }
     
-    double get(int index) const {
-        if (index >= 0 && index < size_) {
-            return data[index];
+    void insert(std::size_t offset, const char* text, std::size_t count) {
+        if (offset > byte_length()) throw std::out_of_range("Insert offset is past the end of the string");
+        if (rope_) {
+            rope_->insert(offset, text, count);
+        } else {
+            buffer_.insert(front_ + offset, text, count);
         }
-        return 0.0;
     }
     
-    int size() const { return size_; }
+    // Flat strings are a single chunk (none when empty)
+    int chunk_count() const { return rope_ ? rope_->chunk_count() : (byte_length() > 0 ? 1 : 0); }
+    
+    std::pair<const char*, std::size_t> chunk_at(int index) const {
+        if (rope_) {
+            const std::string& chunk = rope_->chunk_at(index);
+            return std::make_pair(chunk.data(), chunk.size());
+        }
+        if (index != 0 || byte_length() == 0) throw std::out_of_range("Chunk index out of range");
+        return std::make_pair(buffer_.data() + front_, byte_length());
+    }
+    
+    void reverse() { reverse_utf8(text(), byte_length()); }
+    void to_upper() { fold_case(text(), byte_length(), true); }
+    void to_lower() { fold_case(text(), byte_length(), false); }
 };
 
-// Iterator wrapper class
-class IteratorWrapper {
-private:
-    std::vector<int> data;
-    std::vector<int>::iterator current;
-    
+// Cache-line aligned storage used by the numeric kernels
+static const std::size_t kCacheLineSize = 64;
+
+// Arrays borrowed from an Arena use a non-owning deleter
+struct AlignedFree {
+    bool owned = true;
+    void operator()(void* ptr) const {
+        if (owned) std::free(ptr);
+    }
+};
+
+template<typename T>
+using AlignedArray = std::unique_ptr<T[], AlignedFree>;
+
+template<typename T>
+AlignedArray<T> make_aligned_array(std::size_t count) {
+    void* ptr = nullptr;
+    std::size_t bytes = std::max<std::size_t>(count * sizeof(T), kCacheLineSize);
+    if (posix_memalign(&ptr, kCacheLineSize, bytes) != 0) {
+        throw std::bad_alloc();
+    }
+    std::memset(ptr, 0, bytes);
+    instrument_allocation(bytes);
+    return AlignedArray<T>(static_cast<T*>(ptr));
+}
+
+// Handle table behind the Vector, String, Matrix, SparseMatrix, SmartResource,
+// Function and Iterator handles. A handle packs a slot index with that slot's
+// generation, which every destroy bumps, so a stale, double-freed or wrongly typed
+// handle fails an O(1) check instead of reaching freed memory. Slots live in slabs
+// that are allocated once and never move, so lookups take no lock; released
+// slots go on a lock-free free list whose head carries an ABA tag.
+// Destroying a handle while another thread is still using it remains an error.
+enum class HandleKind : std::uint8_t {
+    Free,
+    Vector,
+    String,
+    MatrixF64,
+    MatrixF32,
+    MatrixI32,
+    SmartResource,
+    Function,
+    Iterator,
+    SparseMatrix
+};
+
+// Maps each handle type to its kind; specialized next to the C API
+template<typename T>
+struct HandleKindOf;
+
+static const unsigned kHandleIndexBits = 24;
+static const unsigned kHandleSlabBits = 12;
+static const std::size_t kHandleSlabSize = std::size_t(1) << kHandleSlabBits;
+static const std::size_t kMaxHandleSlabs = std::size_t(1) << (kHandleIndexBits - kHandleSlabBits);
+// index + 1 must fit in kHandleIndexBits, so the last slot is never used
+static const std::uint32_t kMaxHandleSlots = (std::uint32_t(1) << kHandleIndexBits) - 1;
+// The top bit stays clear, so no handle reads as 0 or -1
+static const std::uintptr_t kHandleGenerationMask = ~std::uintptr_t(0) >> (kHandleIndexBits + 1);
+
+class HandleTable {
 public:
-    IteratorWrapper(const int* array, int size) : data(array, array + size) {
-        current = data.begin();
+    HandleTable() {
+        for (std::atomic<Slot*>& slab : slabs_) slab.store(nullptr, std::memory_order_relaxed);
+    }
+
+    HandleTable(const HandleTable&) = delete;
+    HandleTable& operator=(const HandleTable&) = delete;
+
+    // Arena-owned handles can only be removed by their arena
+    void* insert(void* object, HandleKind kind, bool arena_owned = false) {
+        std::uint32_t index = acquire_slot();
+        Slot& slot = at(index);
+        slot.object.store(object, std::memory_order_relaxed);
+        slot.arena_owned = arena_owned;
+        slot.kind.store(kind, std::memory_order_release);
+        std::uintptr_t generation = slot.generation.load(std::memory_order_relaxed);
+        return reinterpret_cast<void*>((generation << kHandleIndexBits) | (index + 1));
+    }
+
+    void* lookup(void* handle, HandleKind kind) const {
+        std::uintptr_t generation;
+        const Slot* slot = find(handle, generation);
+        if (!slot || slot->generation.load(std::memory_order_acquire) != generation) return nullptr;
+        if (slot->kind.load(std::memory_order_acquire) != kind) return nullptr;
+        void* object = slot->object.load(std::memory_order_acquire);
+        // A destroy and re-create between the checks above would change the generation
+        return slot->generation.load(std::memory_order_acquire) == generation ? object : nullptr;
+    }
+
+    // Retires the handle and returns its object, or nullptr if the handle was
+    // already stale. Only one of several racing removes can win the slot.
+    void* remove(void* handle, HandleKind kind, bool arena_owned = false) {
+        std::uintptr_t generation;
+        Slot* slot = find(handle, generation);
+        if (!slot || slot->kind.load(std::memory_order_acquire) != kind || slot->arena_owned != arena_owned) {
+            return nullptr;
+        }
+        if (!slot->generation.compare_exchange_strong(generation, (generation + 1) & kHandleGenerationMask,
+                                                      std::memory_order_acq_rel)) {
+            return nullptr;
+        }
+        void* object = slot->object.exchange(nullptr, std::memory_order_acq_rel);
+        slot->kind.store(HandleKind::Free, std::memory_order_release);
+        release_slot(static_cast<std::uint32_t>((reinterpret_cast<std::uintptr_t>(handle) &
+                                                 kMaxHandleSlots) - 1));
+        return object;
+    }
+
+private:
+    struct Slot {
+        std::atomic<void*> object{nullptr};
+        std::atomic<std::uintptr_t> generation{1};
+        std::atomic<std::uint32_t> next_free{0};
+        std::atomic<HandleKind> kind{HandleKind::Free};
+        bool arena_owned = false;
+    };
+
+    Slot& at(std::uint32_t index) const {
+        return slabs_[index >> kHandleSlabBits].load(std::memory_order_acquire)[index & (kHandleSlabSize - 1)];
+    }
+
+    Slot* find(void* handle, std::uintptr_t& generation) const {
+        std::uintptr_t value = reinterpret_cast<std::uintptr_t>(handle);
+        std::uintptr_t index = (value & kMaxHandleSlots);
+        if (index == 0 || index > next_unused_.load(std::memory_order_acquire)) return nullptr;
+        index--;
+        Slot* slab = slabs_[index >> kHandleSlabBits].load(std::memory_order_acquire);
+        if (!slab) return nullptr;
+        generation = value >> kHandleIndexBits;
+        return &slab[index & (kHandleSlabSize - 1)];
+    }
+
+    // Free-list head: ABA tag in the high 32 bits, index + 1 (0 = empty) in the low 32
+    std::uint32_t acquire_slot() {
+        std::uint64_t head = free_head_.load(std::memory_order_acquire);
+        while (static_cast<std::uint32_t>(head) != 0) {
+            std::uint32_t index = static_cast<std::uint32_t>(head) - 1;
+            std::uint64_t next = at(index).next_free.load(std::memory_order_relaxed);
+            std::uint64_t replacement = (((head >> 32) + 1) << 32) | next;
+            if (free_head_.compare_exchange_weak(head, replacement, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                return index;
+            }
+        }
+        std::uint32_t index = next_unused_.load(std::memory_order_relaxed);
+        do {
+            if (index >= kMaxHandleSlots) throw std::length_error("Handle table is full");
+        } while (!next_unused_.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+        std::atomic<Slot*>& slab = slabs_[index >> kHandleSlabBits];
+        if (!slab.load(std::memory_order_acquire)) {
+            std::unique_ptr<Slot[]> fresh(new Slot[kHandleSlabSize]);
+            Slot* expected = nullptr;
+            if (slab.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel)) fresh.release();
+        }
+        return index;
+    }
+
+    void release_slot(std::uint32_t index) {
+        std::uint64_t head = free_head_.load(std::memory_order_relaxed);
+        std::uint64_t replacement;
+        do {
+            at(index).next_free.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+            replacement = (((head >> 32) + 1) << 32) | (index + 1);
+        } while (!free_head_.compare_exchange_weak(head, replacement, std::memory_order_release,
+                                                   std::memory_order_relaxed));
     }
+
+    mutable std::array<std::atomic<Slot*>, kMaxHandleSlabs> slabs_;
+    std::atomic<std::uint32_t> next_unused_{0};
+    std::atomic<std::uint64_t> free_head_{0};
+};
+
+// Never destroyed, so handles released by late finalizers still find the table
+static HandleTable& handle_table() {
+    static HandleTable* table = new HandleTable();
+    return *table;
+}
+
+// Bump allocator behind the cpp_arena_* API. Objects are carved out of
+// cache-line aligned blocks and destroyed together on reset, newest first.
+// Blocks are kept across resets, so a steady create/reset loop stops calling
+// malloc once the arena has grown to its working size. Not thread-safe.
+class Arena {
+public:
+    explicit Arena(std::size_t block_size) : block_size_(std::max(block_size, kCacheLineSize)) {}
+    ~Arena() { destroy_objects(); }
     
-    bool has_next() const {
-        return current != data.end();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    
+    // alignment must be a power of two no larger than kCacheLineSize
+    void* allocate(std::size_t bytes, std::size_t alignment) {
+        while (current_ < blocks_.size()) {
+            Block& block = blocks_[current_];
+            std::size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (offset + bytes <= block.size) {
+                offset_ = offset + bytes;
+                return block.memory.get() + offset;
+            }
+            current_++;
+            offset_ = 0;
+        }
+        std::size_t size = std::max(block_size_, bytes);
+        blocks_.push_back(Block{make_aligned_array<unsigned char>(size), size});
+        current_ = blocks_.size() - 1;
+        offset_ = bytes;
+        return blocks_.back().memory.get();
     }
     
-    int next() {
-        if (has_next()) {
-            return *current++;
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        Finalizer* finalizer = nullptr;
+        if (!std::is_trivially_destructible<T>::value) {
+            finalizer = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
         }
-        return 0;
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (finalizer) {
+            finalizer->destroy = [](void* target) { static_cast<T*>(target)->~T(); };
+            finalizer->object = object;
+            finalizer->next = finalizers_;
+            finalizers_ = finalizer;
+        }
+        return object;
+    }
+    
+    // Registers an object created in this arena; its handle is retired on reset or destroy
+    template<typename T>
+    void* adopt_handle(T* object) {
+        HandleRecord* record = static_cast<HandleRecord*>(allocate(sizeof(HandleRecord), alignof(HandleRecord)));
+        record->kind = HandleKindOf<T>::value;
+        record->handle = handle_table().insert(object, record->kind, true);
+        record->next = handles_;
+        handles_ = record;
+        return record->handle;
     }
     
     void reset() {
-        current = data.begin();
+        destroy_objects();
+        current_ = 0;
+        offset_ = 0;
     }
     
-    bool find(int value) {
-        auto it = std::find(data.begin(), data.end(), value);
-        if (it != data.end()) {
-            current = it;
-            return true;
+    std::size_t bytes_used() const {
+        std::size_t used = offset_;
+        for (std::size_t i = 0; i < current_ && i < blocks_.size(); i++) {
+            used += blocks_[i].size;
         }
-        return false;
+        return used;
+    }
+
+private:
+    struct Block {
+        AlignedArray<unsigned char> memory;
+        std::size_t size;
+    };
+    
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+    
+    struct HandleRecord {
+        void* handle;
+        HandleKind kind;
+        HandleRecord* next;
+    };
+    
+    void destroy_objects() {
+        for (HandleRecord* record = handles_; record; record = record->next) {
+            handle_table().remove(record->handle, record->kind, true);
+        }
+        handles_ = nullptr;
+        for (Finalizer* finalizer = finalizers_; finalizer; finalizer = finalizer->next) {
+            finalizer->destroy(finalizer->object);
+        }
+        finalizers_ = nullptr;
     }
+    
+    std::vector<Block> blocks_;
+    std::size_t block_size_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+    Finalizer* finalizers_ = nullptr;
+    HandleRecord* handles_ = nullptr;
 };
 
-// Template functions for mathematical operations
+static const std::size_t kDefaultArenaBlockSize = 64 * 1024;
+
+// Binary matrix files: a 64-byte header followed by the row-major elements in
+// native byte order. The data starts on a cache line and the header is the start
+// of the mapping, so a mapped file can back a matrix directly.
+static const char kMatrixFileMagic[8] = {'F', 'S', 'C', 'P', 'P', 'M', 'A', 'T'};
+static const std::uint32_t kMatrixFileVersion = 1;
+
+enum MatrixFileElement : std::uint32_t {
+    kMatrixFileFloat64 = 1,
+    kMatrixFileFloat32 = 2,
+    kMatrixFileInt32 = 3
+};
+
+struct MatrixFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t element_type;
+    std::int64_t rows;
+    std::int64_t cols;
+    std::uint64_t data_offset;
+    char reserved[24];
+};
+
+static_assert(sizeof(MatrixFileHeader) == kCacheLineSize, "matrix file data must start on a cache line");
+
+template<typename T> struct MatrixFileType;
+template<> struct MatrixFileType<double> { enum : std::uint32_t { value = kMatrixFileFloat64 }; };
+template<> struct MatrixFileType<float> { enum : std::uint32_t { value = kMatrixFileFloat32 }; };
+template<> struct MatrixFileType<int> { enum : std::uint32_t { value = kMatrixFileInt32 }; };
+
+static std::system_error io_error(const char* what, const char* path) {
+    return std::system_error(errno, std::generic_category(), std::string(what) + " '" + path + "'");
+}
+
+// Writes to a sibling temporary and renames it over the target, so readers that
+// still map the old file keep a consistent view and a failed save leaves it intact.
+static void write_matrix_file(const char* path, std::uint32_t element_type, std::int64_t rows,
+                              std::int64_t cols, const void* data, std::size_t bytes) {
+    MatrixFileHeader header = {};
+    std::memcpy(header.magic, kMatrixFileMagic, sizeof(header.magic));
+    header.version = kMatrixFileVersion;
+    header.element_type = element_type;
+    header.rows = rows;
+    header.cols = cols;
+    header.data_offset = sizeof(MatrixFileHeader);
+
+    std::string temp_path = std::string(path) + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) throw io_error("Cannot create", temp_path.c_str());
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (bytes == 0 || std::fwrite(data, bytes, 1, file) == 1);
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp_path.c_str(), path) != 0) {
+        std::system_error error = io_error("Cannot write", path);
+        std::remove(temp_path.c_str());
+        throw error;
+    }
+}
+
+// Read-only opens map the file copy-on-write: pages load lazily, writes stay
+// private to the process and never reach the file. Writable opens map it shared,
+// so element updates persist. The mapping stays valid after the descriptor closes.
+class MappedFile {
+private:
+    void* base_;
+    std::size_t length_;
+
+public:
+    MappedFile(const char* path, bool writable) : base_(MAP_FAILED), length_(0) {
+        int fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) throw io_error("Cannot open", path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            std::system_error error = io_error("Cannot stat", path);
+            ::close(fd);
+            throw error;
+        }
+        length_ = static_cast<std::size_t>(info.st_size);
+        if (length_ < sizeof(MatrixFileHeader)) {
+            ::close(fd);
+            throw std::invalid_argument("Matrix file is too small for its header");
+        }
+        base_ = ::mmap(nullptr, length_, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        int map_errno = errno;
+        ::close(fd);
+        if (base_ == MAP_FAILED) {
+            errno = map_errno;
+            throw io_error("Cannot map", path);
+        }
+    }
+
+    ~MappedFile() {
+        if (base_ != MAP_FAILED) ::munmap(base_, length_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const MatrixFileHeader& header() const { return *static_cast<const MatrixFileHeader*>(base_); }
+
+    // Validates the header against the expected element type and file size
+    void* elements(std::uint32_t element_type, std::size_t element_size) const {
+        const MatrixFileHeader& h = header();
+        if (std::memcmp(h.magic, kMatrixFileMagic, sizeof(h.magic)) != 0 || h.version != kMatrixFileVersion) {
+            throw std::invalid_argument("Not a matrix file");
+        }
+        if (h.element_type != element_type) {
+            throw std::invalid_argument("Matrix file has a different element type");
+        }
+        if (h.rows < 0 || h.cols < 0 || h.rows > std::numeric_limits<int>::max() ||
+            h.cols > std::numeric_limits<int>::max() || h.data_offset < sizeof(MatrixFileHeader) ||
+            h.data_offset % kCacheLineSize != 0) {
+            throw std::invalid_argument("Matrix file header is corrupt");
+        }
+        std::size_t bytes = static_cast<std::size_t>(h.rows) * static_cast<std::size_t>(h.cols) * element_size;
+        if (h.data_offset > length_ || bytes > length_ - h.data_offset) {
+            throw std::invalid_argument("Matrix file is truncated");
+        }
+        return static_cast<char*>(base_) + h.data_offset;
+    }
+};
+
+// Persistent work-stealing thread pool shared by the parallel kernels.
+// Each worker owns a deque: it pops its own work from the back and steals from
+// the front of the others when idle. The thread that starts a parallel region
+// also runs tasks until the region completes, so nested regions cannot deadlock
+// and a pool of size N uses N - 1 background threads plus the caller.
+class ThreadPool {
+public:
+    explicit ThreadPool(int num_threads) : queues_(std::max(num_threads, 1)) {
+        for (auto& queue : queues_) {
+            queue.reset(new WorkQueue());
+        }
+        for (int i = 1; i < static_cast<int>(queues_.size()); i++) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.get_id() == std::this_thread::get_id()) {
+                worker.detach();
+            } else {
+                worker.join();
+            }
+        }
+    }
+
+    int size() const { return static_cast<int>(queues_.size()); }
+
+    // Run body(i) for every i in [0, count) and return once all calls finished.
+    // The first exception thrown by a task is rethrown on the calling thread.
+    void parallel_for(int count, const std::function<void(int)>& body) {
+        if (count <= 0) return;
+        if (count == 1 || queues_.size() == 1) {
+            for (int i = 0; i < count; i++) body(i);
+            return;
+        }
+
+        TaskGroup group(body, count);
+        int home = owning_queue();
+        for (int i = 0; i < count; i++) {
+            WorkQueue& queue = *queues_[(home + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(Task{&group, i});
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            pending_.fetch_add(count);
+        }
+        wake_.notify_all();
+
+        Task task;
+        while (take_task(home, task)) {
+            run(task);
+        }
+        {
+            // Every task of this group has been claimed; wait for the ones still running elsewhere
+            std::unique_lock<std::mutex> lock(group.done_mutex);
+            group.done.wait(lock, [&group] { return group.remaining == 0; });
+        }
+
+        if (group.error) {
+            std::rethrow_exception(group.error);
+        }
+    }
+
+private:
+    struct TaskGroup {
+        TaskGroup(const std::function<void(int)>& body, int count) : body(body), remaining(count) {}
+
+        const std::function<void(int)>& body;
+        int remaining;  // guarded by done_mutex
+        std::mutex done_mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        TaskGroup* group;
+        int index;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Queue index of the calling thread if it is one of our workers, else the shared slot 0
+    int owning_queue() const {
+        return current_pool() == this ? current_worker() : 0;
+    }
+
+    static const ThreadPool*& current_pool() {
+        static thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static int& current_worker() {
+        static thread_local int index = 0;
+        return index;
+    }
+
+    bool take_task(int home, Task& task) {
+        {
+            WorkQueue& own = *queues_[home];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                pending_.fetch_sub(1);
+                return true;
+            }
+        }
+        for (std::size_t offset = 1; offset < queues_.size(); offset++) {
+            WorkQueue& victim = *queues_[(home + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                pending_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(const Task& task) {
+        TaskGroup& group = *task.group;
+        try {
+            group.body(task.index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(group.done_mutex);
+            if (!group.error) group.error = std::current_exception();
+        }
+        // The group lives on the caller's stack, so it must not be touched after this unlock
+        std::lock_guard<std::mutex> lock(group.done_mutex);
+        if (--group.remaining == 0) {
+            group.done.notify_all();
+        }
+    }
+
+    void worker_loop(int index) {
+        current_pool() = this;
+        current_worker() = index;
+        Task task;
+        while (true) {
+            if (take_task(index, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this] { return stopping_ || pending_.load() > 0; });
+            if (stopping_) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> pending_{0};
+    bool stopping_ = false;
+};
+
+static int default_thread_count() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+// The active pool is swapped atomically on resize; regions already running keep
+// the old pool alive through their reference until they finish.
+static std::shared_ptr<ThreadPool>& thread_pool_slot() {
+    static std::shared_ptr<ThreadPool> pool;
+    return pool;
+}
+
+static std::shared_ptr<ThreadPool> thread_pool() {
+    std::shared_ptr<ThreadPool> pool = std::atomic_load(&thread_pool_slot());
+    if (!pool) {
+        static std::mutex init_mutex;
+        std::lock_guard<std::mutex> lock(init_mutex);
+        pool = std::atomic_load(&thread_pool_slot());
+        if (!pool) {
+            pool = std::make_shared<ThreadPool>(default_thread_count());
+            std::atomic_store(&thread_pool_slot(), pool);
+        }
+    }
+    return pool;
+}
+
+static void parallel_for(int count, const std::function<void(int)>& body) {
+    thread_pool()->parallel_for(count, body);
+}
+
+// Parallel LSD radix sort for int32 (8-bit digits, sign bit flipped).
+// Each pass histograms contiguous chunks in parallel, turns the histograms into
+// per-chunk scatter offsets, then scatters the chunks in parallel. Chunks keep
+// their relative order, so every pass stays stable as LSD radix sort requires.
+// Passes whose digit is the same for every element are skipped.
+static const int kSortInsertionThreshold = 64;
+static const std::size_t kParallelSortThreshold = 1 << 18;
+static const std::size_t kSortChunkMin = 1 << 16;
+static const int kRadixBuckets = 256;
+
+static inline std::uint32_t radix_key(int value) {
+    return static_cast<std::uint32_t>(value) ^ 0x80000000u;
+}
+
+static void insertion_sort_int32(int* data, std::size_t count) {
+    for (std::size_t i = 1; i < count; i++) {
+        int value = data[i];
+        std::size_t j = i;
+        while (j > 0 && data[j - 1] > value) {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = value;
+    }
+}
+
+static void radix_sort_int32(int* data, std::size_t count) {
+    if (count < static_cast<std::size_t>(kSortInsertionThreshold)) {
+        insertion_sort_int32(data, count);
+        return;
+    }
+
+    std::size_t chunks = 1;
+    if (count >= kParallelSortThreshold) {
+        std::size_t workers = static_cast<std::size_t>(thread_pool()->size());
+        chunks = std::max<std::size_t>(1, std::min(workers * 4, count / kSortChunkMin));
+    }
+
+    std::unique_ptr<int[]> scratch(new int[count]);
+    std::vector<std::array<std::size_t, kRadixBuckets>> offsets(chunks);
+    auto chunk_begin = [count, chunks](std::size_t chunk) { return chunk * count / chunks; };
+
+    int* source = data;
+    int* destination = scratch.get();
+    for (int shift = 0; shift < 32; shift += 8) {
+        parallel_for(static_cast<int>(chunks), [&](int chunk) {
+            std::array<std::size_t, kRadixBuckets>& histogram = offsets[chunk];
+            histogram.fill(0);
+            for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++) {
+                histogram[(radix_key(source[i]) >> shift) & 0xFF]++;
+            }
+        });
+
+        std::size_t first_bucket_total = 0;
+        std::size_t first_bucket = (radix_key(source[0]) >> shift) & 0xFF;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            first_bucket_total += offsets[chunk][first_bucket];
+        }
+        if (first_bucket_total == count) continue;
+
+        std::size_t offset = 0;
+        for (int bucket = 0; bucket < kRadixBuckets; bucket++) {
+            for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+                std::size_t bucket_count = offsets[chunk][bucket];
+                offsets[chunk][bucket] = offset;
+                offset += bucket_count;
+            }
+        }
+
+        parallel_for(static_cast<int>(chunks), [&](int chunk) {
+            std::array<std::size_t, kRadixBuckets>& next = offsets[chunk];
+            for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); i++) {
+                int value = source[i];
+                destination[next[(radix_key(value) >> shift) & 0xFF]++] = value;
+            }
+        });
+        std::swap(source, destination);
+    }
+
+    if (source != data) {
+        std::memcpy(data, source, count * sizeof(int));
+    }
+}
+
+// Parallel int32 sum. The input is cut into fixed-size chunks that are summed
+// independently and added in chunk order. Sums are exact in int64, so the result
+// never depends on the thread count.
+static const std::size_t kParallelReduceThreshold = 1 << 18;
+static const std::size_t kReduceChunk = 1 << 16;
+
+static long long sum_int32_serial(const int* data, std::size_t count) {
+    long long sum = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static long long sum_int32(const int* data, std::size_t count) {
+    if (count < kParallelReduceThreshold) {
+        return sum_int32_serial(data, count);
+    }
+    int chunks = static_cast<int>((count + kReduceChunk - 1) / kReduceChunk);
+    std::vector<long long> partials(chunks);
+    parallel_for(chunks, [&](int chunk) {
+        std::size_t begin = static_cast<std::size_t>(chunk) * kReduceChunk;
+        partials[chunk] = sum_int32_serial(data + begin, std::min(kReduceChunk, count - begin));
+    });
+    return std::accumulate(partials.begin(), partials.end(), 0LL);
+}
+
+// Blocked GEMM kernel: C += alpha * A * B
+// Follows the classic Goto/BLIS layering: B is packed into KC x NC panels of
+// NR-wide column slivers (sized for L3), A into MC x KC blocks of MR-high row
+// slivers (sized for L2), and an MR x NR register-blocked micro-kernel streams
+// both contiguously. Operands are addressed through row/column strides so the
+// same kernel can consume transposed views without materializing them.
+// The kernel is instantiated per element type; GemmTraits picks the micro-tile
+// (float gets twice the columns for the same register footprint) and the
+// packed type (int32 computes in uint32 so overflow wraps instead of being UB).
+static const int kGemmKC = 256;
+static const int kGemmMC = 128;
+static const int kGemmNC = 4096;
+
+template<typename T> struct GemmTraits;
+
+template<> struct GemmTraits<double> {
+    typedef double Packed;
+    enum { MR = 4, NR = 8 };
+};
+
+template<> struct GemmTraits<float> {
+    typedef float Packed;
+    enum { MR = 4, NR = 16 };
+};
+
+template<> struct GemmTraits<int> {
+    typedef std::uint32_t Packed;
+    enum { MR = 4, NR = 16 };
+};
+
+// a * b and a + b in the packed type, converted back to T
 template<typename T>
-T calculate_mean_template(const T* values, int count) {
-    if (count <= 0) return T(0);
-    T sum = std::accumulate(values, values + count, T(0));
-    return sum / count;
+static T gemm_mul(T a, T b) {
+    typedef typename GemmTraits<T>::Packed Packed;
+    return static_cast<T>(static_cast<Packed>(a) * static_cast<Packed>(b));
+}
+
+template<typename T>
+static T gemm_add(T a, typename GemmTraits<T>::Packed b) {
+    typedef typename GemmTraits<T>::Packed Packed;
+    return static_cast<T>(static_cast<Packed>(a) + b);
+}
+
+template<typename T>
+struct BasicStridedView {
+    const T* ptr;
+    std::ptrdiff_t row_stride;
+    std::ptrdiff_t col_stride;
+
+    T operator()(int row, int col) const {
+        return ptr[row * row_stride + col * col_stride];
+    }
+
+    BasicStridedView transposed() const { return BasicStridedView{ptr, col_stride, row_stride}; }
+};
+
+typedef BasicStridedView<double> StridedView;
+
+// Packing buffers are reused across calls on the same thread
+template<typename P>
+struct GemmWorkspace {
+    AlignedArray<P> packed_a;
+    AlignedArray<P> packed_b;
+    std::size_t capacity_a = 0;
+    std::size_t capacity_b = 0;
+
+    P* a_buffer(std::size_t count) {
+        if (count > capacity_a) {
+            packed_a = make_aligned_array<P>(count);
+            capacity_a = count;
+        }
+        return packed_a.get();
+    }
+
+    P* b_buffer(std::size_t count) {
+        if (count > capacity_b) {
+            packed_b = make_aligned_array<P>(count);
+            capacity_b = count;
+        }
+        return packed_b.get();
+    }
+};
+
+template<typename P>
+static GemmWorkspace<P>& gemm_workspace() {
+    static thread_local GemmWorkspace<P> workspace;
+    return workspace;
+}
+
+// Pack an mc x kc block of alpha * A into MR-row slivers, zero-padding the last one
+template<typename T>
+static void gemm_pack_a(const BasicStridedView<T>& a, T alpha, int row0, int col0, int mc, int kc,
+                        typename GemmTraits<T>::Packed* dst) {
+    typedef typename GemmTraits<T>::Packed Packed;
+    const int MR = GemmTraits<T>::MR;
+    for (int i = 0; i < mc; i += MR) {
+        int mr = std::min(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < MR; r++) {
+                *dst++ = r < mr ? static_cast<Packed>(alpha) * static_cast<Packed>(a(row0 + i + r, col0 + k)) : Packed(0);
+            }
+        }
+    }
+}
+
+// Pack a kc x nc panel of B into NR-column slivers, zero-padding the last one
+template<typename T>
+static void gemm_pack_b(const BasicStridedView<T>& b, int row0, int col0, int kc, int nc,
+                        typename GemmTraits<T>::Packed* dst) {
+    typedef typename GemmTraits<T>::Packed Packed;
+    const int NR = GemmTraits<T>::NR;
+    for (int j = 0; j < nc; j += NR) {
+        int nr = std::min(NR, nc - j);
+        for (int k = 0; k < kc; k++) {
+            for (int c = 0; c < NR; c++) {
+                *dst++ = c < nr ? static_cast<Packed>(b(row0 + k, col0 + j + c)) : Packed(0);
+            }
+        }
+    }
+}
+
+// MR x NR micro-kernel over packed slivers; accumulators stay in registers
+template<typename T>
+static void gemm_micro_kernel(int kc, const typename GemmTraits<T>::Packed* __restrict__ a,
+                              const typename GemmTraits<T>::Packed* __restrict__ b,
+                              T* __restrict__ c, int ldc, int mr, int nr) {
+    typedef typename GemmTraits<T>::Packed Packed;
+    const int MR = GemmTraits<T>::MR;
+    const int NR = GemmTraits<T>::NR;
+    Packed acc[MR][NR] = {};
+    for (int k = 0; k < kc; k++) {
+        for (int r = 0; r < MR; r++) {
+            Packed a_rk = a[r];
+            for (int col = 0; col < NR; col++) {
+                acc[r][col] += a_rk * b[col];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    if (mr == MR && nr == NR) {
+        for (int r = 0; r < MR; r++) {
+            for (int col = 0; col < NR; col++) {
+                c[r * ldc + col] = gemm_add(c[r * ldc + col], acc[r][col]);
+            }
+        }
+    } else {
+        for (int r = 0; r < mr; r++) {
+            for (int col = 0; col < nr; col++) {
+                c[r * ldc + col] = gemm_add(c[r * ldc + col], acc[r][col]);
+            }
+        }
+    }
+}
+
+// Multiply a packed mc x kc block of A by a packed kc x nc panel of B into C
+template<typename T>
+static void gemm_macro_kernel(int mc, int nc, int kc, const typename GemmTraits<T>::Packed* packed_a,
+                              const typename GemmTraits<T>::Packed* packed_b, T* c, int ldc) {
+    const int MR = GemmTraits<T>::MR;
+    const int NR = GemmTraits<T>::NR;
+    for (int j = 0; j < nc; j += NR) {
+        int nr = std::min(NR, nc - j);
+        const auto* b_sliver = packed_b + static_cast<std::size_t>(j) * kc;
+        for (int i = 0; i < mc; i += MR) {
+            int mr = std::min(MR, mc - i);
+            const auto* a_sliver = packed_a + static_cast<std::size_t>(i) * kc;
+            gemm_micro_kernel<T>(kc, a_sliver, b_sliver, c + static_cast<std::size_t>(i) * ldc + j, ldc, mr, nr);
+        }
+    }
+}
+
+// Products smaller than this many multiply-adds stay on the calling thread
+static const double kGemmParallelThreshold = 1 << 20;
+// Column span of one parallel output tile (a multiple of every NR)
+static const int kGemmTileCols = 256;
+
+// C (m x n, row-major with leading dimension ldc) += alpha * A (m x k) * B (k x n)
+// Output tiles (MC rows x kGemmTileCols columns) are spread across the thread
+// pool. Every element of C is still produced by exactly one task in the same
+// summation order, so the result does not depend on the thread count.
+template<typename T>
+static void gemm_accumulate(int m, int n, int k, T alpha, const BasicStridedView<T>& a,
+                            const BasicStridedView<T>& b, T* c, int ldc) {
+    if (m <= 0 || n <= 0 || k <= 0) return;
+
+    typedef typename GemmTraits<T>::Packed Packed;
+    const int MR = GemmTraits<T>::MR;
+    const int NR = GemmTraits<T>::NR;
+    GemmWorkspace<Packed>& workspace = gemm_workspace<Packed>();
+    int nc_max = std::min(kGemmNC, n);
+    int kc_max = std::min(kGemmKC, k);
+    int mc_max = std::min(kGemmMC, m);
+    std::size_t b_panel = static_cast<std::size_t>((nc_max + NR - 1) / NR) * NR * kc_max;
+    std::size_t a_block = static_cast<std::size_t>((mc_max + MR - 1) / MR) * MR * kc_max;
+    Packed* packed_b = workspace.b_buffer(b_panel);
+
+    bool parallel = static_cast<double>(m) * n * k >= kGemmParallelThreshold;
+    if (!parallel) {
+        Packed* packed_a = workspace.a_buffer(a_block);
+        for (int jc = 0; jc < n; jc += kGemmNC) {
+            int nc = std::min(kGemmNC, n - jc);
+            for (int pc = 0; pc < k; pc += kGemmKC) {
+                int kc = std::min(kGemmKC, k - pc);
+                gemm_pack_b(b, pc, jc, kc, nc, packed_b);
+                for (int ic = 0; ic < m; ic += kGemmMC) {
+                    int mc = std::min(kGemmMC, m - ic);
+                    gemm_pack_a(a, alpha, ic, pc, mc, kc, packed_a);
+                    gemm_macro_kernel<T>(mc, nc, kc, packed_a, packed_b,
+                                         c + static_cast<std::size_t>(ic) * ldc + jc, ldc);
+                }
+            }
+        }
+        return;
+    }
+
+    int row_blocks = (m + kGemmMC - 1) / kGemmMC;
+    for (int jc = 0; jc < n; jc += kGemmNC) {
+        int nc = std::min(kGemmNC, n - jc);
+        int col_tiles = (nc + kGemmTileCols - 1) / kGemmTileCols;
+        for (int pc = 0; pc < k; pc += kGemmKC) {
+            int kc = std::min(kGemmKC, k - pc);
+
+            // Slivers of the shared B panel are independent, so pack them in parallel too
+            parallel_for(col_tiles, [&](int tile) {
+                int j = tile * kGemmTileCols;
+                int width = std::min(kGemmTileCols, nc - j);
+                gemm_pack_b(b, pc, jc + j, kc, width, packed_b + static_cast<std::size_t>(j) * kc);
+            });
+
+            parallel_for(row_blocks * col_tiles, [&](int tile) {
+                int ic = (tile / col_tiles) * kGemmMC;
+                int j = (tile % col_tiles) * kGemmTileCols;
+                int mc = std::min(kGemmMC, m - ic);
+                int width = std::min(kGemmTileCols, nc - j);
+                Packed* packed_a = gemm_workspace<Packed>().a_buffer(a_block);
+                gemm_pack_a(a, alpha, ic, pc, mc, kc, packed_a);
+                gemm_macro_kernel<T>(mc, width, kc, packed_a, packed_b + static_cast<std::size_t>(j) * kc,
+                                     c + static_cast<std::size_t>(ic) * ldc + jc + j, ldc);
+            });
+        }
+    }
+}
+
+// Cache-oblivious transposes: blocks are halved along their longer side until
+// they fit in L1, so every cache level is used well without tuning a tile size
+static const int kTransposeLeaf = 32;
+
+// dst (cols x rows, leading dimension ldd) = transpose of src (rows x cols, leading dimension lds)
+template<typename T>
+static void transpose_block(const T* src, int lds, T* dst, int ldd, int rows, int cols) {
+    if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                dst[static_cast<std::size_t>(j) * ldd + i] = src[static_cast<std::size_t>(i) * lds + j];
+            }
+        }
+    } else if (rows >= cols) {
+        int half = rows / 2;
+        transpose_block(src, lds, dst, ldd, half, cols);
+        transpose_block(src + static_cast<std::size_t>(half) * lds, lds, dst + half, ldd, rows - half, cols);
+    } else {
+        int half = cols / 2;
+        transpose_block(src, lds, dst, ldd, rows, half);
+        transpose_block(src + half, lds, dst + static_cast<std::size_t>(half) * ldd, ldd, rows, cols - half);
+    }
+}
+
+// Swap a (rows x cols) with the transpose of b (cols x rows); both share leading dimension ld
+template<typename T>
+static void transpose_swap(T* a, T* b, int ld, int rows, int cols) {
+    if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                std::swap(a[static_cast<std::size_t>(i) * ld + j], b[static_cast<std::size_t>(j) * ld + i]);
+            }
+        }
+    } else if (rows >= cols) {
+        int half = rows / 2;
+        transpose_swap(a, b, ld, half, cols);
+        transpose_swap(a + static_cast<std::size_t>(half) * ld, b + half, ld, rows - half, cols);
+    } else {
+        int half = cols / 2;
+        transpose_swap(a, b, ld, rows, half);
+        transpose_swap(a + half, b + static_cast<std::size_t>(half) * ld, ld, rows, cols - half);
+    }
+}
+
+// Transpose the n x n block on the diagonal at data in place
+template<typename T>
+static void transpose_square(T* data, int ld, int n) {
+    if (n <= kTransposeLeaf) {
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                std::swap(data[static_cast<std::size_t>(i) * ld + j], data[static_cast<std::size_t>(j) * ld + i]);
+            }
+        }
+        return;
+    }
+    int half = n / 2;
+    transpose_square(data, ld, half);
+    transpose_square(data + static_cast<std::size_t>(half) * ld + half, ld, n - half);
+    transpose_swap(data + half, data + static_cast<std::size_t>(half) * ld, ld, half, n - half);
+}
+
+// Content stamps identify what a matrix holds for the result cache. 0 marks
+// storage the library cannot watch (exposed through data_ptr or borrowed from a
+// resource or file), 1 a matrix written since its last stamp; fresh stamps start at 2.
+static const std::uint64_t kUntrackedStamp = 0;
+static const std::uint64_t kModifiedStamp = 1;
+
+static std::uint64_t next_content_stamp() {
+    static std::atomic<std::uint64_t> next{kModifiedStamp + 1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// C++ Matrix class, one instantiation per element type
+// Elements live in one contiguous, cache-line aligned row-major buffer
+template<typename T>
+class BasicMatrix {
+private:
+    AlignedArray<T> data;
+    int rows_, cols_;
+    // Owns the storage: the matrix's own buffer (held shared from allocation, so
+    // shared_alias never modifies a matrix other threads may be reading), a file
+    // mapping (open_mapped), a buffer (over_storage) or the cached result a
+    // shared_view reads. Only arena storage has no owner here.
+    std::shared_ptr<const void> keep_alive_;
+    // Writes go through writable(), which marks the content modified; a shared
+    // view copies the storage on its first write
+    mutable std::atomic<std::uint64_t> stamp_{kModifiedStamp};
+    bool copy_on_write_ = false;
+    
+    T* writable() {
+        if (copy_on_write_) {
+            AlignedArray<T> copy = make_aligned_array<T>(element_count());
+            std::memcpy(copy.get(), data.get(), element_count() * sizeof(T));
+            own(std::move(copy));
+            copy_on_write_ = false;
+        }
+        if (stamp_.load(std::memory_order_relaxed) != kUntrackedStamp) {
+            stamp_.store(kModifiedStamp, std::memory_order_relaxed);
+        }
+        return data.get();
+    }
+
+    void own(AlignedArray<T> storage) {
+        auto owner = std::make_shared<AlignedArray<T>>(std::move(storage));
+        data = AlignedArray<T>(owner->get(), AlignedFree{false});
+        keep_alive_ = std::move(owner);
+    }
+
+    std::size_t index(int row, int col) const {
+        if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+            throw std::out_of_range("Matrix index out of range");
+        }
+        return static_cast<std::size_t>(row) * cols_ + col;
+    }
+    
+    static void check_dimensions(int rows, int cols) {
+        if (rows < 0 || cols < 0) {
+            throw std::invalid_argument("Matrix dimensions must be non-negative");
+        }
+    }
+    
+    void check_multiply(const BasicMatrix& other) const {
+        if (cols_ != other.rows_) {
+            throw std::invalid_argument("Matrix dimensions don't match for multiplication");
+        }
+    }
+    
+    // Shape only; the caller attaches storage
+    BasicMatrix(int rows, int cols, int) : rows_(rows), cols_(cols) {}
+    
+    // result must be a zeroed rows_ x other.cols_ matrix
+    void multiply_to(const BasicMatrix& other, BasicMatrix& result) const {
+        gemm_accumulate(rows_, other.cols_, cols_, T(1), view(), other.view(), result.writable(), other.cols_);
+    }
+    
+    // result must be a distinct cols_ x rows_ matrix
+    void transpose_to(BasicMatrix& result) const {
+        transpose_block(data.get(), cols_, result.writable(), rows_, rows_, cols_);
+    }
+    
+    // BLAS semantics: beta == 0 overwrites, so NaNs already in the matrix do not survive
+    void scale(T beta) {
+        T* values = writable();
+        std::size_t count = element_count();
+        if (beta == T(0)) {
+            std::fill(values, values + count, T(0));
+        } else if (beta != T(1)) {
+            for (std::size_t i = 0; i < count; i++) {
+                values[i] = gemm_mul(values[i], beta);
+            }
+        }
+    }
+    
+public:
+    BasicMatrix(int rows, int cols) : rows_(rows), cols_(cols) {
+        check_dimensions(rows, cols);
+        own(make_aligned_array<T>(element_count()));
+    }
+    
+    // Storage is borrowed from the arena and released when it resets
+    BasicMatrix(int rows, int cols, Arena& arena) : rows_(rows), cols_(cols) {
+        check_dimensions(rows, cols);
+        std::size_t bytes = element_count() * sizeof(T);
+        void* storage = arena.allocate(bytes, kCacheLineSize);
+        std::memset(storage, 0, bytes);
+        data = AlignedArray<T>(static_cast<T*>(storage), AlignedFree{false});
+    }
+    
+    // Storage is a mapped matrix file, paged in on first access
+    static std::unique_ptr<BasicMatrix> open_mapped(const char* path, bool readonly) {
+        auto mapping = std::make_shared<MappedFile>(path, !readonly);
+        T* storage = static_cast<T*>(mapping->elements(MatrixFileType<T>::value, sizeof(T)));
+        const MatrixFileHeader& header = mapping->header();
+        return over_storage(std::move(mapping), storage, static_cast<int>(header.rows), static_cast<int>(header.cols));
+    }
+    
+    // Zero-copy matrix over rows * cols elements owned by owner, which the matrix keeps alive
+    static std::unique_ptr<BasicMatrix> over_storage(std::shared_ptr<void> owner, T* storage, int rows, int cols) {
+        check_dimensions(rows, cols);
+        std::unique_ptr<BasicMatrix> matrix(new BasicMatrix(rows, cols, 0));
+        matrix->data = AlignedArray<T>(storage, AlignedFree{false});
+        matrix->keep_alive_ = std::move(owner);
+        matrix->stamp_.store(kUntrackedStamp, std::memory_order_relaxed);
+        return matrix;
+    }
+    
+    // Zero-copy, copy-on-write view of an immutable matrix (a cached result).
+    // It carries the source's stamp, so products of views hit the cache too.
+    static std::unique_ptr<BasicMatrix> shared_view(const std::shared_ptr<const BasicMatrix>& source) {
+        std::unique_ptr<BasicMatrix> matrix(new BasicMatrix(source->rows_, source->cols_, 0));
+        matrix->data = AlignedArray<T>(const_cast<T*>(source->data.get()), AlignedFree{false});
+        matrix->keep_alive_ = source;
+        matrix->copy_on_write_ = true;
+        matrix->stamp_.store(source->stamp_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return matrix;
+    }
+    
+    // Untracked matrix over the same elements that shares their owner, so it stays
+    // readable after this matrix is destroyed. Only reads this matrix, so it is
+    // safe alongside other readers; arena storage, freed when the arena resets,
+    // is copied instead.
+    std::unique_ptr<BasicMatrix> shared_alias() const {
+        std::unique_ptr<BasicMatrix> alias(new BasicMatrix(rows_, cols_, 0));
+        if (keep_alive_) {
+            alias->data = AlignedArray<T>(data.get(), AlignedFree{false});
+            alias->keep_alive_ = keep_alive_;
+        } else {
+            alias->own(make_aligned_array<T>(element_count()));
+            std::memcpy(alias->data.get(), data.get(), element_count() * sizeof(T));
+        }
+        alias->stamp_.store(kUntrackedStamp, std::memory_order_relaxed);
+        return alias;
+    }
+    
+    // Stamp of the current content, assigning a fresh one after writes; 0 if untracked.
+    // Concurrent readers of an unchanged matrix agree on the stamp.
+    std::uint64_t content_stamp() const {
+        std::uint64_t stamp = stamp_.load(std::memory_order_relaxed);
+        if (stamp != kModifiedStamp) return stamp;
+        std::uint64_t fresh = next_content_stamp();
+        return stamp_.compare_exchange_strong(stamp, fresh, std::memory_order_relaxed) ? fresh : stamp;
+    }
+    
+    void save(const char* path) const {
+        write_matrix_file(path, MatrixFileType<T>::value, rows_, cols_, data.get(), element_count() * sizeof(T));
+    }
+    
+    void set(int row, int col, T value) {
+        std::size_t position = index(row, col);
+        writable()[position] = value;
+    }
+    
+    T get(int row, int col) const {
+        return data[index(row, col)];
+    }
+    
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    std::size_t element_count() const { return static_cast<std::size_t>(rows_) * cols_; }
+
+    T* data_ptr() { return writable(); }
+    const T* data_ptr() const { return data.get(); }
+    
+    // Hands the storage to a caller that may write it at any time, so the
+    // matrix is never again served from or stored in the result cache
+    T* expose_data() {
+        T* values = writable();
+        stamp_.store(kUntrackedStamp, std::memory_order_relaxed);
+        return values;
+    }
+
+    void copy_from(const T* source) {
+        std::memcpy(writable(), source, element_count() * sizeof(T));
+    }
+
+    void copy_to(T* destination) const {
+        std::memcpy(destination, data.get(), element_count() * sizeof(T));
+    }
+
+    BasicStridedView<T> view() const { return BasicStridedView<T>{data.get(), cols_, 1}; }
+    
+    std::unique_ptr<BasicMatrix> multiply(const BasicMatrix& other) const {
+        check_multiply(other);
+        auto result = std::make_unique<BasicMatrix>(rows_, other.cols_);
+        multiply_to(other, *result);
+        return result;
+    }
+    
+    BasicMatrix* multiply(const BasicMatrix& other, Arena& arena) const {
+        check_multiply(other);
+        BasicMatrix* result = arena.create<BasicMatrix>(rows_, other.cols_, arena);
+        multiply_to(other, *result);
+        return result;
+    }
+    
+    std::unique_ptr<BasicMatrix> transpose() const {
+        auto result = std::make_unique<BasicMatrix>(cols_, rows_);
+        transpose_to(*result);
+        return result;
+    }
+    
+    BasicMatrix* transpose(Arena& arena) const {
+        BasicMatrix* result = arena.create<BasicMatrix>(cols_, rows_, arena);
+        transpose_to(*result);
+        return result;
+    }
+    
+    // this = alpha * a * b + beta * this, reusing this matrix's storage.
+    // Only an output that aliases an operand needs a temporary copy.
+    void gemm(T alpha, const BasicMatrix& a, const BasicMatrix& b, T beta) {
+        a.check_multiply(b);
+        if (rows_ != a.rows_ || cols_ != b.cols_) {
+            throw std::invalid_argument("Output matrix has the wrong shape for the product");
+        }
+        if (this == &a || this == &b) {
+            BasicMatrix snapshot(rows_, cols_);
+            snapshot.copy_from(data.get());
+            gemm(alpha, this == &a ? snapshot : a, this == &b ? snapshot : b, beta);
+            return;
+        }
+        scale(beta);
+        if (alpha != T(0)) {
+            gemm_accumulate(a.rows_, b.cols_, a.cols_, alpha, a.view(), b.view(), writable(), cols_);
+        }
+    }
+    
+    void transpose_into(BasicMatrix& result) const {
+        if (result.rows_ != cols_ || result.cols_ != rows_) {
+            throw std::invalid_argument("Output matrix has the wrong shape for the transpose");
+        }
+        if (&result == this) {
+            result.transpose_in_place();
+        } else {
+            transpose_to(result);
+        }
+    }
+    
+    void transpose_in_place() {
+        if (rows_ != cols_) {
+            throw std::invalid_argument("In-place transpose requires a square matrix");
+        }
+        transpose_square(writable(), cols_, rows_);
+    }
+    
+    void print() const {
+        for (int i = 0; i < rows_; i++) {
+            for (int j = 0; j < cols_; j++) {
+                std::cout << data[static_cast<std::size_t>(i) * cols_ + j] << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
+};
+
+typedef BasicMatrix<double> Matrix;
+typedef BasicMatrix<float> MatrixF32;
+typedef BasicMatrix<int> MatrixI32;
+
+// Sparse matrices
+// Compressed sparse row storage: row i holds entries row_ptr_[i] .. row_ptr_[i + 1]
+// of col_idx_ / values_, sorted by column and free of duplicates. Row loops are
+// split into chunks of about equal nonzero count, so a few dense rows do not
+// leave other workers idle. Products follow Gustavson's row-wise algorithm:
+// each output row is gathered in a dense per-chunk accumulator, in a symbolic
+// pass that sizes every row and a numeric pass that fills them in place.
+static const std::size_t kSparseParallelThreshold = 1 << 15;  // multiply-adds
+
+class SparseMatrix {
+private:
+    int rows_, cols_;
+    std::vector<int> row_ptr_;
+    std::vector<int> col_idx_;
+    std::vector<double> values_;
+    
+    SparseMatrix(int rows, int cols) : rows_(rows), cols_(cols), row_ptr_(static_cast<std::size_t>(rows) + 1, 0) {}
+    
+    static void check_dimensions(int rows, int cols) {
+        if (rows < 0 || cols < 0) {
+            throw std::invalid_argument("Matrix dimensions must be non-negative");
+        }
+    }
+    
+    // First row r whose weight prefix row_ptr_[r] + r reaches target; the
+    // prefix is strictly increasing, so every row lands in exactly one chunk
+    int row_at(std::size_t target) const {
+        int low = 0, high = rows_;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (static_cast<std::size_t>(row_ptr_[mid]) + mid < target) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+    
+    // Runs body(begin, end) over row ranges, in parallel when work is large
+    template<typename Body>
+    void for_rows(std::size_t work, Body body) const {
+        if (work < kSparseParallelThreshold || rows_ < 2) {
+            body(0, rows_);
+            return;
+        }
+        std::size_t total = static_cast<std::size_t>(nnz()) + rows_;
+        int chunks = static_cast<int>(std::min<std::size_t>(std::min<std::size_t>(work / (kSparseParallelThreshold / 4),
+                                                                                 thread_pool()->size() * 4), rows_));
+        parallel_for(chunks, [&](int chunk) {
+            body(row_at(total * chunk / chunks), row_at(total * (chunk + 1) / chunks));
+        });
+    }
+    
+    void check_row_col(int row, int col) const {
+        if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+            throw std::out_of_range("Matrix index out of range");
+        }
+    }
+    
+public:
+    // Bulk builder from coordinate triplets in any order; duplicates are summed
+    // in input order and explicit zeros are kept
+    static std::unique_ptr<SparseMatrix> from_coo(int rows, int cols, const int* row_indices, const int* col_indices,
+                                                  const double* values, int count) {
+        check_dimensions(rows, cols);
+        if (count < 0) throw std::invalid_argument("Entry count must be non-negative");
+        std::unique_ptr<SparseMatrix> matrix(new SparseMatrix(rows, cols));
+        std::vector<int>& row_ptr = matrix->row_ptr_;
+        for (int i = 0; i < count; i++) {
+            if (row_indices[i] < 0 || row_indices[i] >= rows || col_indices[i] < 0 || col_indices[i] >= cols) {
+                throw std::out_of_range("Sparse entry index out of range");
+            }
+            row_ptr[row_indices[i] + 1]++;
+        }
+        for (int r = 0; r < rows; r++) row_ptr[r + 1] += row_ptr[r];
+        
+        // Counting sort by row keeps the input order within each row
+        std::vector<int> order(count);
+        std::vector<int> next(row_ptr.begin(), row_ptr.end() - 1);
+        for (int i = 0; i < count; i++) order[next[row_indices[i]]++] = i;
+        
+        matrix->col_idx_.reserve(count);
+        matrix->values_.reserve(count);
+        int start = 0;
+        for (int r = 0; r < rows; r++) {
+            int end = row_ptr[r + 1];
+            std::stable_sort(order.begin() + start, order.begin() + end,
+                             [col_indices](int a, int b) { return col_indices[a] < col_indices[b]; });
+            row_ptr[r] = static_cast<int>(matrix->col_idx_.size());
+            for (int k = start; k < end; k++) {
+                int col = col_indices[order[k]];
+                if (k > start && col == matrix->col_idx_.back()) {
+                    matrix->values_.back() += values[order[k]];
+                } else {
+                    matrix->col_idx_.push_back(col);
+                    matrix->values_.push_back(values[order[k]]);
+                }
+            }
+            start = end;
+        }
+        row_ptr[rows] = static_cast<int>(matrix->col_idx_.size());
+        return matrix;
+    }
+    
+    // Keeps the nonzero elements of a dense matrix
+    static std::unique_ptr<SparseMatrix> from_dense(const Matrix& dense) {
+        std::unique_ptr<SparseMatrix> matrix(new SparseMatrix(dense.rows(), dense.cols()));
+        const double* data = dense.data_ptr();
+        std::size_t cols = static_cast<std::size_t>(dense.cols());
+        for (int r = 0; r < matrix->rows_; r++) {
+            const double* row = data + r * cols;
+            for (std::size_t c = 0; c < cols; c++) {
+                if (row[c] != 0.0) {
+                    matrix->col_idx_.push_back(static_cast<int>(c));
+                    matrix->values_.push_back(row[c]);
+                }
+            }
+            if (matrix->col_idx_.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+                throw std::length_error("Sparse matrix has more than INT_MAX nonzeros");
+            }
+            matrix->row_ptr_[r + 1] = static_cast<int>(matrix->col_idx_.size());
+        }
+        return matrix;
+    }
+    
+    std::unique_ptr<Matrix> to_dense() const {
+        auto dense = std::make_unique<Matrix>(rows_, cols_);
+        double* data = dense->data_ptr();
+        for_rows(static_cast<std::size_t>(nnz()), [&](int begin, int end) {
+            for (int r = begin; r < end; r++) {
+                double* row = data + static_cast<std::size_t>(r) * cols_;
+                for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) row[col_idx_[k]] = values_[k];
+            }
+        });
+        return dense;
+    }
+    
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int nnz() const { return row_ptr_[rows_]; }
+    
+    double get(int row, int col) const {
+        check_row_col(row, col);
+        auto first = col_idx_.begin() + row_ptr_[row];
+        auto last = col_idx_.begin() + row_ptr_[row + 1];
+        auto found = std::lower_bound(first, last, col);
+        return found != last && *found == col ? values_[found - col_idx_.begin()] : 0.0;
+    }
+    
+    // Writes the first capacity entries in row-major order
+    void copy_coo(int* row_indices, int* col_indices, double* values, int capacity) const {
+        int count = std::min(capacity, nnz());
+        for (int r = 0, k = 0; k < count; r++) {
+            for (; k < row_ptr_[r + 1] && k < count; k++) {
+                row_indices[k] = r;
+                col_indices[k] = col_idx_[k];
+                values[k] = values_[k];
+            }
+        }
+    }
+    
+    // y = A x with x of cols() and y of rows() elements; y may overlap x
+    void spmv(const double* x, double* y) const {
+        std::vector<double> snapshot;
+        std::uintptr_t xs = reinterpret_cast<std::uintptr_t>(x), ys = reinterpret_cast<std::uintptr_t>(y);
+        if (ys < xs + cols_ * sizeof(double) && xs < ys + rows_ * sizeof(double)) {
+            snapshot.assign(x, x + cols_);
+            x = snapshot.data();
+        }
+        for_rows(static_cast<std::size_t>(nnz()), [&](int begin, int end) {
+            for (int r = begin; r < end; r++) {
+                double sum = 0.0;
+                for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) sum += values_[k] * x[col_idx_[k]];
+                y[r] = sum;
+            }
+        });
+    }
+    
+    // Sparse x dense: each nonzero scales a row of b into the output row
+    std::unique_ptr<Matrix> multiply(const Matrix& b) const {
+        if (cols_ != b.rows()) {
+            throw std::invalid_argument("Matrix dimensions don't match for multiplication");
+        }
+        auto result = std::make_unique<Matrix>(rows_, b.cols());
+        std::size_t n = static_cast<std::size_t>(b.cols());
+        const double* source = b.data_ptr();
+        double* out = result->data_ptr();
+        for_rows(static_cast<std::size_t>(nnz()) * n, [&](int begin, int end) {
+            for (int r = begin; r < end; r++) {
+                double* row = out + r * n;
+                for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) {
+                    double v = values_[k];
+                    const double* other = source + col_idx_[k] * n;
+                    for (std::size_t j = 0; j < n; j++) row[j] += v * other[j];
+                }
+            }
+        });
+        return result;
+    }
+    
+    // Sparse x sparse (Gustavson); output rows are sorted by column
+    std::unique_ptr<SparseMatrix> multiply(const SparseMatrix& b) const {
+        if (cols_ != b.rows_) {
+            throw std::invalid_argument("Matrix dimensions don't match for multiplication");
+        }
+        std::unique_ptr<SparseMatrix> result(new SparseMatrix(rows_, b.cols_));
+        std::vector<int>& row_ptr = result->row_ptr_;
+        std::size_t work = 0;
+        for (int k = 0; k < nnz(); k++) {
+            work += static_cast<std::size_t>(b.row_ptr_[col_idx_[k] + 1] - b.row_ptr_[col_idx_[k]]);
+        }
+        
+        // Symbolic pass: marker[j] == r once column j appears in output row r
+        for_rows(work, [&](int begin, int end) {
+            std::vector<int> marker(b.cols_, -1);
+            for (int r = begin; r < end; r++) {
+                int count = 0;
+                for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) {
+                    int inner = col_idx_[k];
+                    for (int p = b.row_ptr_[inner]; p < b.row_ptr_[inner + 1]; p++) {
+                        if (marker[b.col_idx_[p]] != r) {
+                            marker[b.col_idx_[p]] = r;
+                            count++;
+                        }
+                    }
+                }
+                row_ptr[r + 1] = count;
+            }
+        });
+        long long total = 0;
+        for (int r = 0; r < rows_; r++) {
+            total += row_ptr[r + 1];
+            if (total > std::numeric_limits<int>::max()) {
+                throw std::length_error("Sparse product has more than INT_MAX nonzeros");
+            }
+            row_ptr[r + 1] = static_cast<int>(total);
+        }
+        result->col_idx_.resize(static_cast<std::size_t>(total));
+        result->values_.resize(static_cast<std::size_t>(total));
+        
+        // Numeric pass into the sized rows
+        for_rows(work, [&](int begin, int end) {
+            std::vector<int> marker(b.cols_, -1);
+            std::vector<double> accumulator(b.cols_);
+            int* columns = result->col_idx_.data();
+            double* values = result->values_.data();
+            for (int r = begin; r < end; r++) {
+                int position = row_ptr[r];
+                for (int k = row_ptr_[r]; k < row_ptr_[r + 1]; k++) {
+                    int inner = col_idx_[k];
+                    double v = values_[k];
+                    for (int p = b.row_ptr_[inner]; p < b.row_ptr_[inner + 1]; p++) {
+                        int col = b.col_idx_[p];
+                        if (marker[col] != r) {
+                            marker[col] = r;
+                            columns[position++] = col;
+                            accumulator[col] = v * b.values_[p];
+                        } else {
+                            accumulator[col] += v * b.values_[p];
+                        }
+                    }
+                }
+                // A row filling an eighth of the width is cheaper to collect in order than to sort
+                if (static_cast<std::size_t>(position - row_ptr[r]) * 8 >= static_cast<std::size_t>(b.cols_)) {
+                    position = row_ptr[r];
+                    for (int col = 0; col < b.cols_; col++) {
+                        if (marker[col] == r) columns[position++] = col;
+                    }
+                } else {
+                    std::sort(columns + row_ptr[r], columns + position);
+                }
+                for (int p = row_ptr[r]; p < position; p++) values[p] = accumulator[columns[p]];
+            }
+        });
+        return result;
+    }
+};
+
+// Lazy matrix expressions
+// matrix_expr_* handles share an immutable tree of leaves (matrix handles,
+// resolved on every evaluation), transposes, products and sums. Evaluation
+// first normalizes the tree: transposes are pushed down to the leaves
+// ((AB)^T = B^T A^T) where they become strided views the GEMM kernel reads
+// directly, and nested products and sums are flattened. Each product chain is
+// then ordered with the classic matrix-chain dynamic program, and sums
+// accumulate every term straight into the output, so only intermediate
+// products of chains get temporaries.
+struct ExprNode {
+    enum class Kind { Leaf, Transpose, Multiply, Add };
+    
+    Kind kind;
+    int rows, cols;
+    void* matrix;  // MatrixHandle of a leaf
+    std::shared_ptr<const ExprNode> left, right;
+};
+
+// Defined with the handle table below; nullptr (and the error recorded) for a stale handle
+static const Matrix* resolve_matrix_handle(void* handle);
+
+class MatrixExpr {
+public:
+    explicit MatrixExpr(std::shared_ptr<const ExprNode> node) : node_(std::move(node)) {}
+    
+    static MatrixExpr leaf(void* handle, const Matrix& matrix) {
+        return MatrixExpr(make_node(ExprNode::Kind::Leaf, matrix.rows(), matrix.cols(), handle, nullptr, nullptr));
+    }
+    
+    MatrixExpr transpose() const {
+        return MatrixExpr(make_node(ExprNode::Kind::Transpose, node_->cols, node_->rows, nullptr, node_, nullptr));
+    }
+    
+    MatrixExpr multiply(const MatrixExpr& other) const {
+        if (node_->cols != other.node_->rows) {
+            throw std::invalid_argument("Matrix dimensions don't match for multiplication");
+        }
+        return MatrixExpr(make_node(ExprNode::Kind::Multiply, node_->rows, other.node_->cols, nullptr,
+                                    node_, other.node_));
+    }
+    
+    MatrixExpr add(const MatrixExpr& other) const {
+        if (node_->rows != other.node_->rows || node_->cols != other.node_->cols) {
+            throw std::invalid_argument("Matrix dimensions don't match for addition");
+        }
+        return MatrixExpr(make_node(ExprNode::Kind::Add, node_->rows, node_->cols, nullptr, node_, other.node_));
+    }
+    
+    int rows() const { return node_->rows; }
+    int cols() const { return node_->cols; }
+    
+    std::unique_ptr<Matrix> evaluate() const {
+        auto result = std::make_unique<Matrix>(rows(), cols());
+        PlanNode plan = normalize(*node_, false);
+        accumulate(plan, result->data_ptr(), result->cols());
+        return result;
+    }
+    
+    void evaluate_into(Matrix& out) const {
+        if (out.rows() != rows() || out.cols() != cols()) {
+            throw std::invalid_argument("Output matrix has the wrong shape for the expression");
+        }
+        if (references(*node_, &out)) {
+            // The output is also an operand, so it cannot be overwritten while being read
+            auto result = evaluate();
+            out.copy_from(result->data_ptr());
+            return;
+        }
+        // Resolving the leaves first keeps out intact if one is stale
+        PlanNode plan = normalize(*node_, false);
+        std::fill(out.data_ptr(), out.data_ptr() + out.element_count(), 0.0);
+        accumulate(plan, out.data_ptr(), out.cols());
+    }
+
+private:
+    // Normalized tree: leaves are (possibly transposed) views, products and
+    // sums hold their flattened operands in order
+    struct PlanNode {
+        ExprNode::Kind kind;
+        int rows, cols;
+        StridedView view;
+        std::vector<PlanNode> children;
+    };
+    
+    static std::shared_ptr<const ExprNode> make_node(ExprNode::Kind kind, int rows, int cols, void* matrix,
+                                                     std::shared_ptr<const ExprNode> left,
+                                                     std::shared_ptr<const ExprNode> right) {
+        auto node = std::make_shared<ExprNode>();
+        node->kind = kind;
+        node->rows = rows;
+        node->cols = cols;
+        node->matrix = matrix;
+        node->left = std::move(left);
+        node->right = std::move(right);
+        return node;
+    }
+    
+    static bool references(const ExprNode& node, const Matrix* matrix) {
+        if (node.kind == ExprNode::Kind::Leaf) return resolve_matrix_handle(node.matrix) == matrix;
+        return (node.left && references(*node.left, matrix)) || (node.right && references(*node.right, matrix));
+    }
+    
+    static void append_flattened(PlanNode& parent, PlanNode child) {
+        if (child.kind == parent.kind) {
+            for (auto& grandchild : child.children) {
+                parent.children.push_back(std::move(grandchild));
+            }
+        } else {
+            parent.children.push_back(std::move(child));
+        }
+    }
+    
+    static PlanNode normalize(const ExprNode& node, bool transposed) {
+        int rows = transposed ? node.cols : node.rows;
+        int cols = transposed ? node.rows : node.cols;
+        switch (node.kind) {
+            case ExprNode::Kind::Leaf: {
+                const Matrix* matrix = resolve_matrix_handle(node.matrix);
+                if (!matrix) throw std::invalid_argument("Stale or invalid handle");
+                StridedView view = matrix->view();
+                return PlanNode{ExprNode::Kind::Leaf, rows, cols, transposed ? view.transposed() : view, {}};
+            }
+            case ExprNode::Kind::Transpose:
+                return normalize(*node.left, !transposed);
+            case ExprNode::Kind::Multiply: {
+                PlanNode product{ExprNode::Kind::Multiply, rows, cols, StridedView{nullptr, 0, 0}, {}};
+                const ExprNode& first = transposed ? *node.right : *node.left;
+                const ExprNode& second = transposed ? *node.left : *node.right;
+                append_flattened(product, normalize(first, transposed));
+                append_flattened(product, normalize(second, transposed));
+                return product;
+            }
+            case ExprNode::Kind::Add:
+                break;
+        }
+        PlanNode sum{ExprNode::Kind::Add, rows, cols, StridedView{nullptr, 0, 0}, {}};
+        append_flattened(sum, normalize(*node.left, transposed));
+        append_flattened(sum, normalize(*node.right, transposed));
+        return sum;
+    }
+    
+    // c (node.rows x node.cols, leading dimension ldc) += value of node
+    static void accumulate(const PlanNode& node, double* c, int ldc) {
+        switch (node.kind) {
+            case ExprNode::Kind::Leaf:
+                for (int i = 0; i < node.rows; i++) {
+                    double* row = c + static_cast<std::size_t>(i) * ldc;
+                    for (int j = 0; j < node.cols; j++) {
+                        row[j] += node.view(i, j);
+                    }
+                }
+                return;
+            case ExprNode::Kind::Add:
+                for (const auto& term : node.children) {
+                    accumulate(term, c, ldc);
+                }
+                return;
+            case ExprNode::Kind::Multiply:
+            case ExprNode::Kind::Transpose:
+                break;
+        }
+        std::vector<int> split = chain_order(node.children);
+        accumulate_chain(node.children, split, 0, static_cast<int>(node.children.size()) - 1, c, ldc);
+    }
+    
+    // split[i * n + j] is the best place to cut the product of factors i..j
+    static std::vector<int> chain_order(const std::vector<PlanNode>& factors) {
+        int n = static_cast<int>(factors.size());
+        std::vector<double> cost(static_cast<std::size_t>(n) * n, 0.0);
+        std::vector<int> split(static_cast<std::size_t>(n) * n, 0);
+        for (int length = 2; length <= n; length++) {
+            for (int i = 0; i + length - 1 < n; i++) {
+                int j = i + length - 1;
+                double best = std::numeric_limits<double>::infinity();
+                for (int k = i; k < j; k++) {
+                    double flops = static_cast<double>(factors[i].rows) * factors[k].cols * factors[j].cols;
+                    double total = cost[i * n + k] + cost[(k + 1) * n + j] + flops;
+                    if (total < best) {
+                        best = total;
+                        split[i * n + j] = k;
+                    }
+                }
+                cost[i * n + j] = best;
+            }
+        }
+        return split;
+    }
+    
+    // A single leaf factor is read in place; anything else is evaluated into a temporary
+    static StridedView operand(const std::vector<PlanNode>& factors, const std::vector<int>& split,
+                               int first, int last, std::unique_ptr<Matrix>& storage) {
+        if (first == last && factors[first].kind == ExprNode::Kind::Leaf) {
+            return factors[first].view;
+        }
+        storage = std::make_unique<Matrix>(factors[first].rows, factors[last].cols);
+        accumulate_chain(factors, split, first, last, storage->data_ptr(), storage->cols());
+        return storage->view();
+    }
+    
+    static void accumulate_chain(const std::vector<PlanNode>& factors, const std::vector<int>& split,
+                                 int first, int last, double* c, int ldc) {
+        if (first == last) {
+            accumulate(factors[first], c, ldc);
+            return;
+        }
+        int n = static_cast<int>(factors.size());
+        int k = split[first * n + last];
+        std::unique_ptr<Matrix> left_storage, right_storage;
+        StridedView left = operand(factors, split, first, k, left_storage);
+        StridedView right = operand(factors, split, k + 1, last, right_storage);
+        gemm_accumulate(factors[first].rows, factors[last].cols, factors[k].cols, 1.0, left, right, c, ldc);
+    }
+    
+    std::shared_ptr<const ExprNode> node_;
+};
+
+// Native scratch buffer of doubles behind SmartResourceHandle. Storage is
+// cache-line aligned. Buffers of kResourceMapThreshold bytes or more come from
+// anonymous mmap, whose pages the kernel zeroes on first touch, so creating a
+// large buffer costs no memset. CPP_RESOURCE_HUGE_PAGES asks for 2 MiB pages:
+// explicit MAP_HUGETLB pages when the system has some reserved, otherwise
+// transparent huge pages via madvise. The storage is reference counted so that
+// matrices created over it keep it alive after the resource is destroyed.
+static const std::size_t kResourceMapThreshold = 1 << 20;
+static const std::size_t kHugePageSize = 2 << 20;
+// Bulk fills and copies this large are split across the thread pool
+static const std::size_t kResourceParallelThreshold = 1 << 20;
+
+class SmartResource {
+private:
+    std::shared_ptr<double> data_;
+    int size_;
+    bool huge_pages_ = false;
+    
+    static std::shared_ptr<double> map_storage(std::size_t bytes, bool huge_pages, bool& explicit_huge) {
+        explicit_huge = false;
+        void* memory = MAP_FAILED;
+        std::size_t length = bytes;
+#ifdef MAP_HUGETLB
+        if (huge_pages) {
+            length = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+            memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            explicit_huge = memory != MAP_FAILED;
+        }
+#endif
+        if (memory == MAP_FAILED) {
+            length = bytes;
+            memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            if (huge_pages) ::madvise(memory, length, MADV_HUGEPAGE);
+#endif
+        }
+        instrument_allocation(length);
+        return std::shared_ptr<double>(static_cast<double*>(memory), [length](double* p) { ::munmap(p, length); });
+    }
+    
+    // Runs body(begin, end) over [offset, offset + count), in parallel when large
+    template<typename Body>
+    static void for_range(std::size_t offset, std::size_t count, Body body) {
+        if (count < kResourceParallelThreshold) {
+            body(offset, offset + count);
+            return;
+        }
+        int chunks = static_cast<int>(std::min<std::size_t>(count / (kResourceParallelThreshold / 4),
+                                                            thread_pool()->size() * 4));
+        parallel_for(chunks, [&](int chunk) {
+            body(offset + count * chunk / chunks, offset + count * (chunk + 1) / chunks);
+        });
+    }
+    
+    void check_range(int offset, int count) const {
+        if (offset < 0 || count < 0 || offset > size_ - count) {
+            throw std::out_of_range("Resource range out of bounds");
+        }
+    }
+    
+public:
+    explicit SmartResource(int size, bool huge_pages = false) : size_(size) {
+        if (size < 0) throw std::invalid_argument("Resource size must be non-negative");
+        std::size_t bytes = std::max<std::size_t>(static_cast<std::size_t>(size) * sizeof(double), kCacheLineSize);
+        if (bytes >= kResourceMapThreshold || huge_pages) {
+            data_ = map_storage(bytes, huge_pages, huge_pages_);
+        } else {
+            AlignedArray<double> storage = make_aligned_array<double>(static_cast<std::size_t>(size));
+            data_ = std::shared_ptr<double>(storage.release(), [](double* p) { std::free(p); });
+        }
+    }
+    
+    void set(int index, double value) {
+        if (index >= 0 && index < size_) {
+            data_.get()[index] = value;
+        }
+    }
+    
+    double get(int index) const {
+        if (index >= 0 && index < size_) {
+            return data_.get()[index];
+        }
+        return 0.0;
+    }
+    
+    int size() const { return size_; }
+    double* data() const { return data_.get(); }
+    const std::shared_ptr<double>& storage() const { return data_; }
+    // True when the buffer sits on explicit (MAP_HUGETLB) huge pages
+    bool huge_pages() const { return huge_pages_; }
+    
+    void fill(int offset, int count, double value) {
+        check_range(offset, count);
+        double* values = data_.get();
+        for_range(static_cast<std::size_t>(offset), static_cast<std::size_t>(count),
+                  [=](std::size_t begin, std::size_t end) { std::fill(values + begin, values + end, value); });
+    }
+    
+    void copy_in(int offset, const double* source, int count) {
+        check_range(offset, count);
+        if (count == 0) return;
+        double* values = data_.get();
+        std::size_t first = static_cast<std::size_t>(offset);
+        for_range(first, static_cast<std::size_t>(count), [=](std::size_t begin, std::size_t end) {
+            std::memcpy(values + begin, source + (begin - first), (end - begin) * sizeof(double));
+        });
+    }
+    
+    void copy_out(int offset, double* destination, int count) const {
+        check_range(offset, count);
+        if (count == 0) return;
+        const double* values = data_.get();
+        std::size_t first = static_cast<std::size_t>(offset);
+        for_range(first, static_cast<std::size_t>(count), [=](std::size_t begin, std::size_t end) {
+            std::memcpy(destination + (begin - first), values + begin, (end - begin) * sizeof(double));
+        });
+    }
+};
+
+// Binary operation behind a FunctionHandle. Scalar calls on the built-ins still
+// go through std::function; batch calls switch once and run a plain loop the
+// compiler can vectorize, with no indirect call per element.
+enum class BinaryOp { Add, Multiply, Power };
+
+// std::pow does not vectorize, so large power batches are split across the pool
+static const std::size_t kPowerParallelThreshold = 1 << 14;
+
+static double apply_binary(BinaryOp op, double a, double b) {
+    switch (op) {
+        case BinaryOp::Add: return a + b;
+        case BinaryOp::Multiply: return a * b;
+        case BinaryOp::Power: break;
+    }
+    return std::pow(a, b);
+}
+
+// Expression tree behind a composed FunctionHandle. Nodes are immutable and
+// shared, so composing reuses the operands' subtrees and a pipeline stays valid
+// after the handles it was built from are destroyed.
+struct FunctionNode;
+typedef std::shared_ptr<const FunctionNode> FunctionNodePtr;
+
+static const int kMaxFunctionInputs = 64;
+// Bounds the expanded tree, since a shared subtree is walked once per use
+static const int kMaxFunctionNodes = 4096;
+
+struct FunctionNode {
+    enum class Kind { Input, Constant, Apply };
+    
+    Kind kind;
+    int input;
+    double value;
+    BinaryOp op;
+    FunctionNodePtr left;
+    FunctionNodePtr right;
+    int arity;  // one past the highest input read
+    int size;   // nodes in the expanded tree
+    
+    FunctionNode(Kind kind, int input, double value, BinaryOp op, FunctionNodePtr left, FunctionNodePtr right)
+        : kind(kind), input(input), value(value), op(op), left(std::move(left)), right(std::move(right)),
+          arity(kind == Kind::Input ? input + 1 : 0), size(1) {
+        if (kind == Kind::Apply) {
+            arity = std::max(this->left->arity, this->right->arity);
+            size = this->left->size + this->right->size + 1;
+        }
+    }
+    
+    static FunctionNodePtr make_input(int index) {
+        if (index < 0 || index >= kMaxFunctionInputs) throw std::out_of_range("Function input index out of range");
+        return std::make_shared<const FunctionNode>(Kind::Input, index, 0.0, BinaryOp::Add, nullptr, nullptr);
+    }
+    
+    static FunctionNodePtr make_constant(double value) {
+        return std::make_shared<const FunctionNode>(Kind::Constant, 0, value, BinaryOp::Add, nullptr, nullptr);
+    }
+    
+    // Operations on two constants fold to a constant, as does x^0 (1 even for NaN),
+    // so compiled operands are only constant where the tree holds a Constant
+    static FunctionNodePtr make_apply(BinaryOp op, FunctionNodePtr left, FunctionNodePtr right) {
+        if (left->kind == Kind::Constant && right->kind == Kind::Constant) {
+            return make_constant(apply_binary(op, left->value, right->value));
+        }
+        if (op == BinaryOp::Power && right->kind == Kind::Constant && right->value == 0.0) {
+            return make_constant(1.0);
+        }
+        if (left->size + right->size >= kMaxFunctionNodes) {
+            throw std::invalid_argument("Function pipeline is too large");
+        }
+        return std::make_shared<const FunctionNode>(Kind::Apply, 0, 0.0, op, std::move(left), std::move(right));
+    }
+    
+    // This function with input 0 replaced by first and input 1 by second; higher inputs are kept
+    static FunctionNodePtr substitute(const FunctionNodePtr& node, const FunctionNodePtr& first,
+                                      const FunctionNodePtr& second) {
+        switch (node->kind) {
+            case Kind::Input:
+                return node->input == 0 ? first : node->input == 1 ? second : node;
+            case Kind::Constant:
+                return node;
+            case Kind::Apply:
+                break;
+        }
+        if (node->arity == 0) return node;
+        return make_apply(node->op, substitute(node->left, first, second), substitute(node->right, first, second));
+    }
+    
+    // Postfix form with exact constants; equal keys compile to the same kernel
+    void append_shape(std::string& key) const {
+        char buffer[40];
+        switch (kind) {
+            case Kind::Input:
+                std::snprintf(buffer, sizeof buffer, "x%d ", input);
+                key += buffer;
+                return;
+            case Kind::Constant:
+                std::snprintf(buffer, sizeof buffer, "%a ", value);
+                key += buffer;
+                return;
+            case Kind::Apply:
+                break;
+        }
+        left->append_shape(key);
+        right->append_shape(key);
+        key += op == BinaryOp::Add ? "+ " : op == BinaryOp::Multiply ? "* " : "^ ";
+    }
+};
+
+// Elements per block of a fused kernel; a few blocks of scratch stay in L1
+static const std::size_t kFusedBlock = 256;
+static const std::size_t kFusedParallelThreshold = 1 << 16;
+// Constant integer exponents up to this magnitude become multiplications
+static const int kFusedMaxIntegerExponent = 32;
+// Destination slot of the final step: the caller's output array
+static const int kFusedOutputSlot = -1;
+
+// A pipeline compiled to straight-line steps that each sweep one block. Operand
+// slots are the inputs followed by block-sized scratch registers, so there are
+// no array-sized temporaries and the only dispatch is one switch per step per
+// block; each step's inner loop is a plain vectorizable loop.
+class FusedKernel {
+public:
+    enum class Code { Copy, Fill, Add, AddConstant, Multiply, MultiplyConstant, MultiplyAdd,
+                      Power, PowerConstant, ConstantPower, Reciprocal };
+    
+    explicit FusedKernel(const FunctionNode& root) : arity_(root.arity), registers_(0) {
+        std::vector<int> free_registers;
+        Operand result = compile(root, free_registers);
+        if (result.constant) {
+            steps_.push_back(Step{Code::Fill, kFusedOutputSlot, -1, -1, -1, result.value});
+        } else if (result.slot >= arity_ && steps_.back().dst == result.slot) {
+            steps_.back().dst = kFusedOutputSlot;
+        } else {
+            steps_.push_back(Step{Code::Copy, kFusedOutputSlot, result.slot, -1, -1, 0.0});
+        }
+    }
+    
+    int arity() const { return arity_; }
+    int steps() const { return static_cast<int>(steps_.size()); }
+    
+    // out[i] = f(inputs[0][i], ...); out may alias an input element for element
+    void evaluate(const double* const* inputs, double* out, std::size_t count) const {
+        if (count < kFusedParallelThreshold) {
+            run(inputs, out, 0, count);
+            return;
+        }
+        int chunks = static_cast<int>(std::min<std::size_t>(count / (kFusedParallelThreshold / 4),
+                                                            thread_pool()->size() * 4));
+        parallel_for(chunks, [&](int chunk) {
+            run(inputs, out, count * chunk / chunks, count * (chunk + 1) / chunks);
+        });
+    }
+    
+private:
+    struct Step {
+        Code code;
+        int dst;
+        int a;
+        int b;
+        int c;
+        double value;
+    };
+    
+    struct Operand {
+        bool constant;
+        int slot;
+        double value;
+    };
+    
+    int arity_;
+    int registers_;
+    std::vector<Step> steps_;
+    
+    int acquire(std::vector<int>& free_registers) {
+        if (free_registers.empty()) return arity_ + registers_++;
+        int slot = free_registers.back();
+        free_registers.pop_back();
+        return slot;
+    }
+    
+    void release(const Operand& operand, std::vector<int>& free_registers) const {
+        if (!operand.constant && operand.slot >= arity_) free_registers.push_back(operand.slot);
+    }
+    
+    Operand emit(Code code, std::vector<int>& free_registers, Operand a, Operand b = Operand{true, -1, 0.0},
+                 Operand c = Operand{true, -1, 0.0}, double value = 0.0) {
+        release(a, free_registers);
+        release(b, free_registers);
+        release(c, free_registers);
+        // Reusing an operand's register as the destination is safe: steps are element-wise
+        int dst = acquire(free_registers);
+        steps_.push_back(Step{code, dst, a.slot, b.slot, c.slot, value});
+        return Operand{false, dst, 0.0};
+    }
+    
+    // x^n by square-and-multiply, then a reciprocal for negative n; n != 0
+    Operand emit_integer_power(Operand base, int exponent, std::vector<int>& free_registers) {
+        unsigned int n = static_cast<unsigned int>(exponent < 0 ? -exponent : exponent);
+        Operand result = Operand{true, -1, 0.0};
+        bool have_result = false;
+        Operand square = base;
+        for (;;) {
+            if (n & 1u) {
+                if (!have_result) {
+                    result = square;
+                    have_result = true;
+                } else {
+                    // square stays live, so only result's register may be reused
+                    release(result, free_registers);
+                    int dst = acquire(free_registers);
+                    steps_.push_back(Step{Code::Multiply, dst, result.slot, square.slot, -1, 0.0});
+                    result = Operand{false, dst, 0.0};
+                }
+            }
+            n >>= 1;
+            if (n == 0) break;
+            bool shared = have_result && result.slot == square.slot;
+            if (!shared) release(square, free_registers);
+            int dst = acquire(free_registers);
+            steps_.push_back(Step{Code::Multiply, dst, square.slot, square.slot, -1, 0.0});
+            square = Operand{false, dst, 0.0};
+        }
+        if (square.slot != result.slot) release(square, free_registers);
+        return exponent < 0 ? emit(Code::Reciprocal, free_registers, result) : result;
+    }
+    
+    Operand compile(const FunctionNode& node, std::vector<int>& free_registers) {
+        switch (node.kind) {
+            case FunctionNode::Kind::Input: return Operand{false, node.input, 0.0};
+            case FunctionNode::Kind::Constant: return Operand{true, -1, node.value};
+            case FunctionNode::Kind::Apply: break;
+        }
+        
+        // a * b + c in one pass when none of the three is a constant
+        if (node.op == BinaryOp::Add) {
+            const FunctionNode* product = node.left->kind == FunctionNode::Kind::Apply &&
+                                          node.left->op == BinaryOp::Multiply ? node.left.get()
+                                        : node.right->kind == FunctionNode::Kind::Apply &&
+                                          node.right->op == BinaryOp::Multiply ? node.right.get() : nullptr;
+            const FunctionNode* addend = product == node.left.get() ? node.right.get() : node.left.get();
+            if (product && product->left->kind != FunctionNode::Kind::Constant &&
+                product->right->kind != FunctionNode::Kind::Constant &&
+                addend->kind != FunctionNode::Kind::Constant) {
+                Operand a = compile(*product->left, free_registers);
+                Operand b = compile(*product->right, free_registers);
+                Operand c = compile(*addend, free_registers);
+                return emit(Code::MultiplyAdd, free_registers, a, b, c);
+            }
+        }
+        
+        Operand a = compile(*node.left, free_registers);
+        Operand b = compile(*node.right, free_registers);
+        switch (node.op) {
+            case BinaryOp::Add:
+                if (a.constant) std::swap(a, b);
+                return b.constant ? emit(Code::AddConstant, free_registers, a, Operand{true, -1, 0.0},
+                                         Operand{true, -1, 0.0}, b.value)
+                                  : emit(Code::Add, free_registers, a, b);
+            case BinaryOp::Multiply:
+                if (a.constant) std::swap(a, b);
+                return b.constant ? emit(Code::MultiplyConstant, free_registers, a, Operand{true, -1, 0.0},
+                                         Operand{true, -1, 0.0}, b.value)
+                                  : emit(Code::Multiply, free_registers, a, b);
+            case BinaryOp::Power:
+                break;
+        }
+        if (a.constant) {
+            return emit(Code::ConstantPower, free_registers, b, Operand{true, -1, 0.0}, Operand{true, -1, 0.0}, a.value);
+        }
+        if (!b.constant) return emit(Code::Power, free_registers, a, b);
+        if (b.value == std::floor(b.value) && std::fabs(b.value) <= kFusedMaxIntegerExponent) {
+            return emit_integer_power(a, static_cast<int>(b.value), free_registers);
+        }
+        return emit(Code::PowerConstant, free_registers, a, Operand{true, -1, 0.0}, Operand{true, -1, 0.0}, b.value);
+    }
+    
+    void run(const double* const* inputs, double* out, std::size_t begin, std::size_t end) const {
+        // Register files of up to eight blocks live on the stack
+        double local[8 * kFusedBlock];
+        std::vector<double> heap;
+        double* scratch = local;
+        if (registers_ > 8) {
+            heap.resize(static_cast<std::size_t>(registers_) * kFusedBlock);
+            scratch = heap.data();
+        }
+        
+        for (std::size_t block = begin; block < end; block += kFusedBlock) {
+            std::size_t n = std::min(kFusedBlock, end - block);
+            auto read = [&](int slot) -> const double* {
+                return slot < arity_ ? inputs[slot] + block : scratch + (slot - arity_) * kFusedBlock;
+            };
+            for (const Step& step : steps_) {
+                double* d = step.dst == kFusedOutputSlot ? out + block : scratch + (step.dst - arity_) * kFusedBlock;
+                const double* a = step.a >= 0 ? read(step.a) : nullptr;
+                const double* b = step.b >= 0 ? read(step.b) : nullptr;
+                const double* c = step.c >= 0 ? read(step.c) : nullptr;
+                double value = step.value;
+                switch (step.code) {
+                    case Code::Copy: for (std::size_t i = 0; i < n; i++) d[i] = a[i]; break;
+                    case Code::Fill: for (std::size_t i = 0; i < n; i++) d[i] = value; break;
+                    case Code::Add: for (std::size_t i = 0; i < n; i++) d[i] = a[i] + b[i]; break;
+                    case Code::AddConstant: for (std::size_t i = 0; i < n; i++) d[i] = a[i] + value; break;
+                    case Code::Multiply: for (std::size_t i = 0; i < n; i++) d[i] = a[i] * b[i]; break;
+                    case Code::MultiplyConstant: for (std::size_t i = 0; i < n; i++) d[i] = a[i] * value; break;
+                    case Code::MultiplyAdd: for (std::size_t i = 0; i < n; i++) d[i] = a[i] * b[i] + c[i]; break;
+                    case Code::Power: for (std::size_t i = 0; i < n; i++) d[i] = std::pow(a[i], b[i]); break;
+                    case Code::PowerConstant: for (std::size_t i = 0; i < n; i++) d[i] = std::pow(a[i], value); break;
+                    case Code::ConstantPower: for (std::size_t i = 0; i < n; i++) d[i] = std::pow(value, a[i]); break;
+                    case Code::Reciprocal: for (std::size_t i = 0; i < n; i++) d[i] = 1.0 / a[i]; break;
+                }
+            }
+        }
+    }
+};
+
+// Compiled kernels keyed by pipeline shape, so rebuilding the same pipeline
+// (for example once per F# query) reuses the compiled program. The oldest
+// entry is evicted once the cache is full.
+static const std::size_t kFusedKernelCacheCapacity = 256;
+
+class FusedKernelCache {
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const FusedKernel>> kernels_;
+    std::deque<std::string> order_;
+    long long hits_ = 0;
+    long long misses_ = 0;
+    
+public:
+    std::shared_ptr<const FusedKernel> get(const FunctionNode& root) {
+        std::string key;
+        root.append_shape(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = kernels_.find(key);
+        if (found != kernels_.end()) {
+            hits_++;
+            return found->second;
+        }
+        misses_++;
+        std::shared_ptr<const FusedKernel> kernel = std::make_shared<const FusedKernel>(root);
+        if (kernels_.size() >= kFusedKernelCacheCapacity) {
+            kernels_.erase(order_.front());
+            order_.pop_front();
+        }
+        kernels_.emplace(key, kernel);
+        order_.push_back(std::move(key));
+        return kernel;
+    }
+    
+    void stats(long long* hits, long long* misses, int* entries) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hits) *hits = hits_;
+        if (misses) *misses = misses_;
+        if (entries) *entries = static_cast<int>(kernels_.size());
+    }
+};
+
+// Leaked so kernels held by handles in other static destructors stay valid
+static FusedKernelCache& fused_kernel_cache() {
+    static FusedKernelCache* cache = new FusedKernelCache();
+    return *cache;
+}
+
+class FunctionWrapper {
+private:
+    BinaryOp op_;
+    FunctionNodePtr root_;
+    std::function<double(double, double)> function_;   // built-in operations
+    std::shared_ptr<const FusedKernel> kernel_;        // composed pipelines
+    
+    static std::function<double(double, double)> make_function(BinaryOp op) {
+        switch (op) {
+            case BinaryOp::Add: return [](double a, double b) { return a + b; };
+            case BinaryOp::Multiply: return [](double a, double b) { return a * b; };
+            case BinaryOp::Power: break;
+        }
+        return [](double a, double b) { return std::pow(a, b); };
+    }
+    
+    static void power_range(const double* a, const double* b, double* out, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            out[i] = std::pow(a[i], b[i]);
+        }
+    }
+    
+    void require_inputs(int available) const {
+        if (arity() > available) {
+            throw std::invalid_argument("Function reads " + std::to_string(arity()) + " inputs but " +
+                                        std::to_string(available) + " were given");
+        }
+    }
+    
+public:
+    explicit FunctionWrapper(BinaryOp op)
+        : op_(op),
+          root_(FunctionNode::make_apply(op, FunctionNode::make_input(0), FunctionNode::make_input(1))),
+          function_(make_function(op)) {}
+    
+    explicit FunctionWrapper(FunctionNodePtr root)
+        : op_(BinaryOp::Add), root_(std::move(root)), kernel_(fused_kernel_cache().get(*root_)) {}
+    
+    const FunctionNodePtr& root() const { return root_; }
+    int arity() const { return root_->arity; }
+    
+    double call(double a, double b) const {
+        if (function_) return function_(a, b);
+        require_inputs(2);
+        const double* inputs[2] = {&a, &b};
+        double result;
+        kernel_->evaluate(inputs, &result, 1);
+        return result;
+    }
+    
+    // out may alias a or b element for element
+    void call_batch(const double* a, const double* b, double* out, std::size_t count) const {
+        if (kernel_) {
+            require_inputs(2);
+            const double* inputs[2] = {a, b};
+            kernel_->evaluate(inputs, out, count);
+            return;
+        }
+        switch (op_) {
+            case BinaryOp::Add:
+                for (std::size_t i = 0; i < count; i++) out[i] = a[i] + b[i];
+                break;
+            case BinaryOp::Multiply:
+                for (std::size_t i = 0; i < count; i++) out[i] = a[i] * b[i];
+                break;
+            case BinaryOp::Power:
+                if (count < kPowerParallelThreshold) {
+                    power_range(a, b, out, 0, count);
+                    break;
+                }
+                int chunks = static_cast<int>(std::min<std::size_t>(count / kPowerParallelThreshold,
+                                                                    thread_pool()->size() * 4));
+                parallel_for(chunks, [&](int chunk) {
+                    power_range(a, b, out, count * chunk / chunks, count * (chunk + 1) / chunks);
+                });
+                break;
+        }
+    }
+    
+    // inputs holds input_count arrays of count elements; the caller checked them for null
+    void evaluate(const double* const* inputs, int input_count, double* out, std::size_t count) const {
+        require_inputs(input_count);
+        if (kernel_) {
+            kernel_->evaluate(inputs, out, count);
+        } else {
+            call_batch(inputs[0], inputs[1], out, count);
+        }
+    }
+};
+
+// Linear int32 search, 16 elements (four SSE2/NEON compares) per step.
+// Returns the index of the first match at or after start, or count if none.
+static std::size_t find_int32(const int* data, std::size_t count, std::size_t start, int value) {
+    std::size_t i = start;
+#if defined(__x86_64__) || defined(__i386__)
+    __m128i needle = _mm_set1_epi32(value);
+    for (; i + 16 <= count; i += 16) {
+        const __m128i* block = reinterpret_cast<const __m128i*>(data + i);
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(_mm_loadu_si128(block), needle),
+                         _mm_cmpeq_epi32(_mm_loadu_si128(block + 1), needle)),
+            _mm_or_si128(_mm_cmpeq_epi32(_mm_loadu_si128(block + 2), needle),
+                         _mm_cmpeq_epi32(_mm_loadu_si128(block + 3), needle)));
+        if (_mm_movemask_epi8(hits) != 0) break;
+    }
+#elif defined(__aarch64__)
+    int32x4_t needle = vdupq_n_s32(value);
+    for (; i + 16 <= count; i += 16) {
+        uint32x4_t hits = vorrq_u32(vorrq_u32(vceqq_s32(vld1q_s32(data + i), needle),
+                                              vceqq_s32(vld1q_s32(data + i + 4), needle)),
+                                    vorrq_u32(vceqq_s32(vld1q_s32(data + i + 8), needle),
+                                              vceqq_s32(vld1q_s32(data + i + 12), needle)));
+        if (vmaxvq_u32(hits) != 0) break;
+    }
+#endif
+    for (; i < count; i++) {
+        if (data[i] == value) return i;
+    }
+    return count;
+}
+
+// Writes the first capacity match positions and returns the total number of matches
+static std::size_t find_all_int32(const int* data, std::size_t count, int value, int* positions, std::size_t capacity) {
+    std::size_t found = 0;
+    for (std::size_t i = find_int32(data, count, 0, value); i < count; i = find_int32(data, count, i + 1, value)) {
+        if (found < capacity) positions[found] = static_cast<int>(i);
+        found++;
+    }
+    return found;
+}
+
+// Iterator over an int array. The default mode copies the input; a borrowed
+// iterator reads the caller's buffer in place, which must then stay alive and
+// unchanged until the iterator is destroyed.
+class IteratorWrapper {
+private:
+    std::vector<int> owned_;
+    const int* data_;
+    std::size_t size_;
+    std::size_t current_ = 0;
+    
+public:
+    IteratorWrapper(const int* array, int size) : owned_(array, array + size) {
+        data_ = owned_.data();
+        size_ = owned_.size();
+    }
+    
+    struct Borrowed {};
+    IteratorWrapper(const int* array, int size, Borrowed) : data_(array), size_(static_cast<std::size_t>(size)) {}
+    
+    bool has_next() const {
+        return current_ < size_;
+    }
+    
+    int next() {
+        if (has_next()) {
+            return data_[current_++];
+        }
+        return 0;
+    }
+    
+    // Copies up to max elements from the current position and advances past them
+    std::size_t next_batch(int* out, std::size_t max) {
+        std::size_t count = std::min(max, size_ - current_);
+        if (count > 0) std::memcpy(out, data_ + current_, count * sizeof(int));
+        current_ += count;
+        return count;
+    }
+    
+    void reset() {
+        current_ = 0;
+    }
+    
+    // Searches from the start; on a match the iterator is positioned at it
+    bool find(int value) {
+        std::size_t index = find_int32(data_, size_, 0, value);
+        if (index < size_) {
+            current_ = index;
+            return true;
+        }
+        return false;
+    }
+    
+    std::size_t find_all(int value, int* positions, std::size_t capacity) const {
+        return find_all_int32(data_, size_, value, positions, capacity);
+    }
+};
+
+// Statistics kernels
+// Ranges are reduced as a pairwise tree over fixed kStatsBlock-element leaves.
+// Each leaf streams its (L1-resident) block twice: once for sum/min/max and
+// once for the squared deviations from the block mean (corrected two-pass).
+// Leaves are merged with Chan et al.'s update, so the whole reduction reads
+// memory once and its rounding error grows with log(n) rather than n.
+static const int kStatsBlock = 1024;
+
+struct StatsPartial {
+    double count = 0.0;
+    double sum = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;  // sum of squared deviations from mean
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+};
+
+static StatsPartial merge_stats(const StatsPartial& a, const StatsPartial& b) {
+    if (a.count == 0.0) return b;
+    if (b.count == 0.0) return a;
+    StatsPartial merged;
+    merged.count = a.count + b.count;
+    double delta = b.mean - a.mean;
+    merged.mean = a.mean + delta * (b.count / merged.count);
+    merged.m2 = a.m2 + b.m2 + delta * delta * (a.count * b.count / merged.count);
+    merged.sum = a.sum + b.sum;
+    merged.min = std::min(a.min, b.min);
+    merged.max = std::max(a.max, b.max);
+    return merged;
+}
+
+// Finish a leaf from its raw sums; d_sum corrects m2 for rounding in the mean
+static StatsPartial make_leaf(int n, double sum, double min, double max, double d_sum, double d2_sum) {
+    StatsPartial leaf;
+    leaf.count = n;
+    leaf.sum = sum;
+    leaf.mean = sum / n;
+    leaf.m2 = std::max(0.0, d2_sum - d_sum * d_sum / n);
+    leaf.min = min;
+    leaf.max = max;
+    return leaf;
+}
+
+// Portable leaf for any element type; accumulates in double
+template<typename T>
+static StatsPartial stats_leaf_scalar(const T* x, int n) {
+    double s[4] = {0.0, 0.0, 0.0, 0.0};
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            double v = static_cast<double>(x[i + lane]);
+            s[lane] += v;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+    }
+    for (; i < n; i++) {
+        double v = static_cast<double>(x[i]);
+        s[0] += v;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    double sum = (s[0] + s[1]) + (s[2] + s[3]);
+    double mean = sum / n;
+    double d_sum = 0.0, d2_sum = 0.0;
+    for (i = 0; i < n; i++) {
+        double d = static_cast<double>(x[i]) - mean;
+        d_sum += d;
+        d2_sum += d * d;
+    }
+    return make_leaf(n, sum, lo, hi, d_sum, d2_sum);
+}
+
+template<typename T>
+static double sum_leaf_scalar(const T* x, int n) {
+    double s[4] = {0.0, 0.0, 0.0, 0.0};
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int lane = 0; lane < 4; lane++) {
+            s[lane] += static_cast<double>(x[i + lane]);
+        }
+    }
+    for (; i < n; i++) {
+        s[0] += static_cast<double>(x[i]);
+    }
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+static inline double hsum_avx2(__m256d v) {
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double hmin_avx2(__m256d v) {
+    __m128d pair = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double hmax_avx2(__m256d v) {
+    __m128d pair = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2,fma")))
+static StatsPartial stats_leaf_avx2(const double* x, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d lo = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d hi = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d a = _mm256_loadu_pd(x + i);
+        __m256d b = _mm256_loadu_pd(x + i + 4);
+        s0 = _mm256_add_pd(s0, a);
+        s1 = _mm256_add_pd(s1, b);
+        lo = _mm256_min_pd(lo, _mm256_min_pd(a, b));
+        hi = _mm256_max_pd(hi, _mm256_max_pd(a, b));
+    }
+    double sum = hsum_avx2(_mm256_add_pd(s0, s1));
+    double min = hmin_avx2(lo), max = hmax_avx2(hi);
+    for (int j = i; j < n; j++) {
+        sum += x[j];
+        min = std::min(min, x[j]);
+        max = std::max(max, x[j]);
+    }
+
+    double mean = sum / n;
+    __m256d vmean = _mm256_set1_pd(mean);
+    __m256d d0 = _mm256_setzero_pd(), d1 = _mm256_setzero_pd();
+    __m256d q0 = _mm256_setzero_pd(), q1 = _mm256_setzero_pd();
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256d a = _mm256_sub_pd(_mm256_loadu_pd(x + i), vmean);
+        __m256d b = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), vmean);
+        d0 = _mm256_add_pd(d0, a);
+        d1 = _mm256_add_pd(d1, b);
+        q0 = _mm256_fmadd_pd(a, a, q0);
+        q1 = _mm256_fmadd_pd(b, b, q1);
+    }
+    double d_sum = hsum_avx2(_mm256_add_pd(d0, d1));
+    double d2_sum = hsum_avx2(_mm256_add_pd(q0, q1));
+    for (; i < n; i++) {
+        double d = x[i] - mean;
+        d_sum += d;
+        d2_sum += d * d;
+    }
+    return make_leaf(n, sum, min, max, d_sum, d2_sum);
+}
+
+__attribute__((target("avx2,fma")))
+static double sum_leaf_avx2(const double* x, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(x + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(x + i + 4));
+        s2 = _mm256_add_pd(s2, _mm256_loadu_pd(x + i + 8));
+        s3 = _mm256_add_pd(s3, _mm256_loadu_pd(x + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(x + i));
+    }
+    double sum = hsum_avx2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    for (; i < n; i++) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+// GCC 12 builds the 512-bit casts, extracts, min and max (and so _mm512_reduce_*)
+// on an undefined passthrough that -Wuninitialized flags. The full-mask forms
+// take an explicit passthrough and compile to the same instructions.
+__attribute__((target("avx512f")))
+static inline __m256d low_half_avx512(__m512d v) {
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 0);
+}
+
+__attribute__((target("avx512f")))
+static inline __m256d high_half_avx512(__m512d v) {
+    return _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 1);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d min_avx512(__m512d a, __m512d b) {
+    return _mm512_mask_min_pd(a, 0xFF, a, b);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d max_avx512(__m512d a, __m512d b) {
+    return _mm512_mask_max_pd(a, 0xFF, a, b);
+}
+
+// Folds the 256-bit halves, then finishes with the AVX2 reducers
+__attribute__((target("avx512f")))
+static inline double hsum_avx512(__m512d v) {
+    return hsum_avx2(_mm256_add_pd(low_half_avx512(v), high_half_avx512(v)));
+}
+
+__attribute__((target("avx512f")))
+static inline double hmin_avx512(__m512d v) {
+    return hmin_avx2(_mm256_min_pd(low_half_avx512(v), high_half_avx512(v)));
+}
+
+__attribute__((target("avx512f")))
+static inline double hmax_avx512(__m512d v) {
+    return hmax_avx2(_mm256_max_pd(low_half_avx512(v), high_half_avx512(v)));
+}
+
+__attribute__((target("avx512f")))
+static StatsPartial stats_leaf_avx512(const double* x, int n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    __m512d lo = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d hi = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d a = _mm512_loadu_pd(x + i);
+        __m512d b = _mm512_loadu_pd(x + i + 8);
+        s0 = _mm512_add_pd(s0, a);
+        s1 = _mm512_add_pd(s1, b);
+        lo = min_avx512(lo, min_avx512(a, b));
+        hi = max_avx512(hi, max_avx512(a, b));
+    }
+    double sum = hsum_avx512(_mm512_add_pd(s0, s1));
+    double min = hmin_avx512(lo), max = hmax_avx512(hi);
+    for (int j = i; j < n; j++) {
+        sum += x[j];
+        min = std::min(min, x[j]);
+        max = std::max(max, x[j]);
+    }
+
+    double mean = sum / n;
+    __m512d vmean = _mm512_set1_pd(mean);
+    __m512d d0 = _mm512_setzero_pd(), d1 = _mm512_setzero_pd();
+    __m512d q0 = _mm512_setzero_pd(), q1 = _mm512_setzero_pd();
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m512d a = _mm512_sub_pd(_mm512_loadu_pd(x + i), vmean);
+        __m512d b = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), vmean);
+        d0 = _mm512_add_pd(d0, a);
+        d1 = _mm512_add_pd(d1, b);
+        q0 = _mm512_fmadd_pd(a, a, q0);
+        q1 = _mm512_fmadd_pd(b, b, q1);
+    }
+    double d_sum = hsum_avx512(_mm512_add_pd(d0, d1));
+    double d2_sum = hsum_avx512(_mm512_add_pd(q0, q1));
+    for (; i < n; i++) {
+        double d = x[i] - mean;
+        d_sum += d;
+        d2_sum += d * d;
+    }
+    return make_leaf(n, sum, min, max, d_sum, d2_sum);
+}
+
+__attribute__((target("avx512f")))
+static double sum_leaf_avx512(const double* x, int n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    __m512d s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(x + i));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(x + i + 8));
+        s2 = _mm512_add_pd(s2, _mm512_loadu_pd(x + i + 16));
+        s3 = _mm512_add_pd(s3, _mm512_loadu_pd(x + i + 24));
+    }
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(x + i));
+    }
+    double sum = hsum_avx512(_mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+    for (; i < n; i++) {
+        sum += x[i];
+    }
+    return sum;
+}
+#endif
+
+#if defined(__aarch64__)
+static StatsPartial stats_leaf_neon(const double* x, int n) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+    float64x2_t lo = vdupq_n_f64(std::numeric_limits<double>::infinity());
+    float64x2_t hi = vdupq_n_f64(-std::numeric_limits<double>::infinity());
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t a = vld1q_f64(x + i);
+        float64x2_t b = vld1q_f64(x + i + 2);
+        s0 = vaddq_f64(s0, a);
+        s1 = vaddq_f64(s1, b);
+        lo = vminq_f64(lo, vminq_f64(a, b));
+        hi = vmaxq_f64(hi, vmaxq_f64(a, b));
+    }
+    double sum = vaddvq_f64(vaddq_f64(s0, s1));
+    double min = vminvq_f64(lo), max = vmaxvq_f64(hi);
+    for (int j = i; j < n; j++) {
+        sum += x[j];
+        min = std::min(min, x[j]);
+        max = std::max(max, x[j]);
+    }
+
+    double mean = sum / n;
+    float64x2_t vmean = vdupq_n_f64(mean);
+    float64x2_t d0 = vdupq_n_f64(0.0), d1 = vdupq_n_f64(0.0);
+    float64x2_t q0 = vdupq_n_f64(0.0), q1 = vdupq_n_f64(0.0);
+    for (i = 0; i + 4 <= n; i += 4) {
+        float64x2_t a = vsubq_f64(vld1q_f64(x + i), vmean);
+        float64x2_t b = vsubq_f64(vld1q_f64(x + i + 2), vmean);
+        d0 = vaddq_f64(d0, a);
+        d1 = vaddq_f64(d1, b);
+        q0 = vfmaq_f64(q0, a, a);
+        q1 = vfmaq_f64(q1, b, b);
+    }
+    double d_sum = vaddvq_f64(vaddq_f64(d0, d1));
+    double d2_sum = vaddvq_f64(vaddq_f64(q0, q1));
+    for (; i < n; i++) {
+        double d = x[i] - mean;
+        d_sum += d;
+        d2_sum += d * d;
+    }
+    return make_leaf(n, sum, min, max, d_sum, d2_sum);
+}
+
+static double sum_leaf_neon(const double* x, int n) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+    float64x2_t s2 = vdupq_n_f64(0.0), s3 = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = vaddq_f64(s0, vld1q_f64(x + i));
+        s1 = vaddq_f64(s1, vld1q_f64(x + i + 2));
+        s2 = vaddq_f64(s2, vld1q_f64(x + i + 4));
+        s3 = vaddq_f64(s3, vld1q_f64(x + i + 6));
+    }
+    double sum = vaddvq_f64(vaddq_f64(vaddq_f64(s0, s1), vaddq_f64(s2, s3)));
+    for (; i < n; i++) {
+        sum += x[i];
+    }
+    return sum;
+}
+#endif
+
+// Leaf kernels for double, chosen once from the features of the running CPU
+struct StatsKernels {
+    StatsPartial (*stats_leaf)(const double*, int);
+    double (*sum_leaf)(const double*, int);
+};
+
+static StatsKernels select_stats_kernels() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return StatsKernels{stats_leaf_avx512, sum_leaf_avx512};
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return StatsKernels{stats_leaf_avx2, sum_leaf_avx2};
+    }
+#elif defined(__aarch64__)
+    return StatsKernels{stats_leaf_neon, sum_leaf_neon};
+#endif
+    return StatsKernels{stats_leaf_scalar<double>, sum_leaf_scalar<double>};
+}
+
+static const StatsKernels& stats_kernels() {
+    static const StatsKernels kernels = select_stats_kernels();
+    return kernels;
+}
+
+template<typename T>
+struct StatsLeaves {
+    static StatsPartial stats(const T* x, int n) { return stats_leaf_scalar(x, n); }
+    static double sum(const T* x, int n) { return sum_leaf_scalar(x, n); }
+};
+
+template<>
+struct StatsLeaves<double> {
+    static StatsPartial stats(const double* x, int n) { return stats_kernels().stats_leaf(x, n); }
+    static double sum(const double* x, int n) { return stats_kernels().sum_leaf(x, n); }
+};
+
+// Split point on a leaf boundary so the tree shape depends only on n
+static std::size_t stats_split(std::size_t n) {
+    std::size_t leaves = (n + kStatsBlock - 1) / kStatsBlock;
+    return (leaves / 2) * kStatsBlock;
+}
+
+// Large subtrees evaluate their two halves on the thread pool. The tree itself
+// is unchanged, so parallel results are bitwise identical to serial ones.
+template<typename T>
+static StatsPartial stats_pairwise(const T* x, std::size_t n) {
+    if (n <= static_cast<std::size_t>(kStatsBlock)) {
+        return n > 0 ? StatsLeaves<T>::stats(x, static_cast<int>(n)) : StatsPartial();
+    }
+    std::size_t half = stats_split(n);
+    if (n >= kParallelReduceThreshold) {
+        StatsPartial halves[2];
+        parallel_for(2, [&](int i) {
+            halves[i] = i == 0 ? stats_pairwise(x, half) : stats_pairwise(x + half, n - half);
+        });
+        return merge_stats(halves[0], halves[1]);
+    }
+    return merge_stats(stats_pairwise(x, half), stats_pairwise(x + half, n - half));
+}
+
+template<typename T>
+static double sum_pairwise(const T* x, std::size_t n) {
+    if (n <= static_cast<std::size_t>(kStatsBlock)) {
+        return n > 0 ? StatsLeaves<T>::sum(x, static_cast<int>(n)) : 0.0;
+    }
+    std::size_t half = stats_split(n);
+    if (n >= kParallelReduceThreshold) {
+        double halves[2];
+        parallel_for(2, [&](int i) {
+            halves[i] = i == 0 ? sum_pairwise(x, half) : sum_pairwise(x + half, n - half);
+        });
+        return halves[0] + halves[1];
+    }
+    return sum_pairwise(x, half) + sum_pairwise(x + half, n - half);
+}
+
+// Template functions for mathematical operations
+template<typename T>
+T calculate_mean_template(const T* values, int count) {
+    if (count <= 0) return T(0);
+    return static_cast<T>(sum_pairwise(values, count) / count);
+}
+
+template<typename T>
+T calculate_variance_template(const T* values, int count) {
+    if (count <= 0) return T(0);
+    StatsPartial stats = stats_pairwise(values, count);
+    return static_cast<T>(stats.m2 / stats.count);
+}
+
+// Streaming statistics behind the stats_* API. Each batch is reduced with the
+// same pairwise kernel as calculate_statistics and folded into the running
+// total with Chan's parallel update, so memory stays O(1) however much is pushed.
+// Not thread-safe: keep one accumulator per thread and merge them at the end.
+class StatsAccumulator {
+private:
+    StatsPartial total_;
+
+public:
+    void push(const double* values, std::size_t count) {
+        if (count > 0) total_ = merge_stats(total_, stats_pairwise(values, count));
+    }
+
+    void merge(const StatsAccumulator& other) { total_ = merge_stats(total_, other.total_); }
+    void reset() { total_ = StatsPartial(); }
+    const StatsPartial& partial() const { return total_; }
+};
+
+// Asynchronous jobs behind the job_* API. One runner thread executes jobs in
+// submission order; the kernels inside still fan out over the shared thread
+// pool, so a single job already uses every core. A job is reference counted:
+// the handle holds one reference and the runner another while it is queued or
+// running, so job_destroy may be called at any point.
+class Job {
+public:
+    Job(std::function<Matrix*()> work, JobCallback callback, void* user_state)
+        : work_(std::move(work)), callback_(callback), user_state_(user_state) {}
+
+    void retain() { refs_.fetch_add(1); }
+
+    void release() {
+        if (refs_.fetch_sub(1) == 1) delete this;
+    }
+
+    CppResultCode status() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return report();
+    }
+
+    // timeout_ms < 0 waits until the job finishes; CPP_PENDING means it timed out
+    CppResultCode wait(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto finished = [this] { return status_ != CPP_PENDING; };
+        if (timeout_ms < 0) {
+            finished_.wait(lock, finished);
+        } else {
+            finished_.wait_for(lock, std::chrono::milliseconds(timeout_ms), finished);
+        }
+        return report();
+    }
+
+    // A queued job never runs; a running one finishes but its result is dropped
+    bool cancel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status_ != CPP_PENDING) return false;
+        cancel_requested_ = true;
+        return true;
+    }
+
+    Matrix* take_result() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return result_.release();
+    }
+
+    // Called on the runner thread; the callback runs after waiters are released
+    void execute() {
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled = cancel_requested_;
+        }
+        std::unique_ptr<Matrix> result;
+        CppResultCode code = CPP_CANCELLED;
+        if (!cancelled) {
+            try {
+                result.reset(work_());
+                code = CPP_SUCCESS;
+            } catch (const std::exception& e) {
+                code = set_last_error(e);
+                error_ = error_state().message;
+            }
+        }
+        work_ = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cancel_requested_) {
+                code = CPP_CANCELLED;
+                result.reset();
+            }
+            result_ = std::move(result);
+            status_ = code;
+        }
+        finished_.notify_all();
+        if (callback_) callback_(this, code, user_state_);
+    }
+
+private:
+    // Failures are re-published on the thread that asks about them
+    CppResultCode report() const {
+        if (status_ != CPP_PENDING && status_ != CPP_SUCCESS && status_ != CPP_CANCELLED) {
+            set_last_error(status_, error_.c_str());
+        }
+        return status_;
+    }
+
+    std::function<Matrix*()> work_;
+    JobCallback callback_;
+    void* user_state_;
+    std::atomic<int> refs_{1};
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    CppResultCode status_ = CPP_PENDING;
+    bool cancel_requested_ = false;
+    std::unique_ptr<Matrix> result_;
+    std::string error_;
+};
+
+class JobRunner {
+public:
+    JobRunner() : thread_([this] { run(); }) {}
+
+    ~JobRunner() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        thread_.join();
+        for (Job* job : queue_) {
+            job->release();
+        }
+    }
+
+    void submit(Job* job) {
+        job->retain();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(job);
+        }
+        wake_.notify_one();
+    }
+
+private:
+    void run() {
+        while (true) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (stopping_) return;
+                job = queue_.front();
+                queue_.pop_front();
+            }
+            job->execute();
+            job->release();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job*> queue_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+static JobRunner& job_runner() {
+    static JobRunner runner;
+    return runner;
+}
+
+template<> struct HandleKindOf<VectorWrapper> { static const HandleKind value = HandleKind::Vector; };
+template<> struct HandleKindOf<StringWrapper> { static const HandleKind value = HandleKind::String; };
+template<> struct HandleKindOf<BasicMatrix<double>> { static const HandleKind value = HandleKind::MatrixF64; };
+template<> struct HandleKindOf<BasicMatrix<float>> { static const HandleKind value = HandleKind::MatrixF32; };
+template<> struct HandleKindOf<BasicMatrix<int>> { static const HandleKind value = HandleKind::MatrixI32; };
+template<> struct HandleKindOf<SmartResource> { static const HandleKind value = HandleKind::SmartResource; };
+template<> struct HandleKindOf<FunctionWrapper> { static const HandleKind value = HandleKind::Function; };
+template<> struct HandleKindOf<IteratorWrapper> { static const HandleKind value = HandleKind::Iterator; };
+template<> struct HandleKindOf<SparseMatrix> { static const HandleKind value = HandleKind::SparseMatrix; };
+
+// Takes ownership of a heap object and returns its handle; the object is
+// deleted if the table is full
+template<typename T>
+static void* new_handle(T* object) {
+    std::unique_ptr<T> owned(object);
+    void* handle = handle_table().insert(object, HandleKindOf<T>::value);
+    owned.release();
+    return handle;
+}
+
+template<typename T>
+static void* new_handle(std::unique_ptr<T> object) {
+    return new_handle(object.release());
+}
+
+// nullptr for a null handle; a stale or wrongly typed one also records an error
+template<typename T>
+static T* handle_cast(void* handle) {
+    if (!handle) return nullptr;
+    void* object = handle_table().lookup(handle, HandleKindOf<T>::value);
+    if (!object) set_last_error(CPP_INVALID_OPERATION, "Stale or invalid handle");
+    return static_cast<T*>(object);
+}
+
+// Destroying a stale handle (e.g. a double destroy) is a no-op
+template<typename T>
+static void delete_handle(void* handle) {
+    if (handle) delete static_cast<T*>(handle_table().remove(handle, HandleKindOf<T>::value));
+}
+
+static const Matrix* resolve_matrix_handle(void* handle) {
+    return handle_cast<Matrix>(handle);
+}
+
+// Matrix entry points shared by the double, float and int32 C APIs
+template<typename T>
+static void* typed_matrix_create(int rows, int cols) {
+    try {
+        return new_handle(new BasicMatrix<T>(rows, cols));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+template<typename T>
+static void* typed_matrix_create_from_buffer(const T* data, int rows, int cols) {
+    try {
+        auto matrix = std::make_unique<BasicMatrix<T>>(rows, cols);
+        if (matrix->element_count() > 0) {
+            if (!data) {
+                set_last_error(CPP_NULL_POINTER, "Source buffer is null");
+                return nullptr;
+            }
+            matrix->copy_from(data);
+        }
+        return new_handle(std::move(matrix));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+template<typename T>
+static void typed_matrix_set(void* handle, int row, int col, T value) {
+    if (BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle)) {
+        try {
+            matrix->set(row, col, value);
+        } catch (const std::exception& e) {
+            set_last_error(e);
+        }
+    }
+}
+
+template<typename T>
+static T typed_matrix_get(void* handle, int row, int col) {
+    if (BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle)) {
+        try {
+            return matrix->get(row, col);
+        } catch (const std::exception& e) {
+            set_last_error(e);
+        }
+    }
+    return T(0);
+}
+
+template<typename T>
+static CppResultCode typed_matrix_copy_from_buffer(void* handle, const T* data, int count) {
+    BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    if (!matrix) return CPP_NULL_POINTER;
+    if (matrix->element_count() == 0) return CPP_SUCCESS;
+    if (!data) return CPP_NULL_POINTER;
+    if (count < 0 || static_cast<std::size_t>(count) < matrix->element_count()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Source buffer is smaller than the matrix");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    matrix->copy_from(data);
+    return CPP_SUCCESS;
+}
+
+template<typename T>
+static CppResultCode typed_matrix_copy_to_buffer(void* handle, T* buffer, int count) {
+    const BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    if (!matrix) return CPP_NULL_POINTER;
+    if (matrix->element_count() == 0) return CPP_SUCCESS;
+    if (!buffer) return CPP_NULL_POINTER;
+    if (count < 0 || static_cast<std::size_t>(count) < matrix->element_count()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Destination buffer is smaller than the matrix");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    matrix->copy_to(buffer);
+    return CPP_SUCCESS;
+}
+
+// Opt-in cache of matrix_multiply / matrix_transpose results, keyed on the
+// operands' content stamps so any write invalidates by changing the key. Hits
+// return a copy-on-write view of the cached result rather than recomputing it.
+// Entries are evicted least recently used first to stay within the byte budget;
+// views keep an evicted result's storage alive until they are destroyed.
+struct MatrixCacheKey {
+    int operation;  // kind and element type
+    std::uint64_t left;
+    std::uint64_t right;
+    
+    bool operator==(const MatrixCacheKey& other) const {
+        return operation == other.operation && left == other.left && right == other.right;
+    }
+};
+
+struct MatrixCacheKeyHash {
+    std::size_t operator()(const MatrixCacheKey& key) const {
+        std::uint64_t h = key.left * 0x9E3779B97F4A7C15ull ^ (key.right + 0x632BE59BD9B4E019ull + (key.left << 6));
+        return static_cast<std::size_t>(h ^ (h >> 29) ^ static_cast<std::uint64_t>(key.operation));
+    }
+};
+
+template<typename T> struct MatrixCacheType;
+template<> struct MatrixCacheType<double> { static const int value = 0; };
+template<> struct MatrixCacheType<float> { static const int value = 1; };
+template<> struct MatrixCacheType<int> { static const int value = 2; };
+
+class MatrixResultCache {
+private:
+    struct Entry {
+        MatrixCacheKey key;
+        std::shared_ptr<const void> result;
+        std::size_t bytes;
+    };
+    
+    std::mutex mutex_;
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<MatrixCacheKey, std::list<Entry>::iterator, MatrixCacheKeyHash> index_;
+    std::atomic<std::size_t> budget_{0};
+    std::size_t bytes_ = 0;
+    long long hits_ = 0;
+    long long misses_ = 0;
+    long long evictions_ = 0;
+    
+    void evict_to(std::size_t budget) {
+        while (bytes_ > budget) {
+            Entry& oldest = entries_.back();
+            bytes_ -= oldest.bytes;
+            index_.erase(oldest.key);
+            entries_.pop_back();
+            evictions_++;
+        }
+    }
+    
+public:
+    bool enabled() const { return budget_.load(std::memory_order_relaxed) > 0; }
+    
+    void set_budget(std::size_t budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_.store(budget, std::memory_order_relaxed);
+        evict_to(budget);
+    }
+    
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+    
+    std::shared_ptr<const void> find(const MatrixCacheKey& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(key);
+        if (found == index_.end()) {
+            misses_++;
+            CPP_INSTRUMENT_EVENT("matrix_cache_miss");
+            return nullptr;
+        }
+        hits_++;
+        CPP_INSTRUMENT_EVENT("matrix_cache_hit");
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->result;
+    }
+    
+    // Results larger than the whole budget are not kept; a racing insert of the same key keeps the first
+    void insert(const MatrixCacheKey& key, std::shared_ptr<const void> result, std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t budget = budget_.load(std::memory_order_relaxed);
+        if (bytes > budget || index_.count(key)) return;
+        evict_to(budget - bytes);
+        entries_.push_front(Entry{key, std::move(result), bytes});
+        index_.emplace(key, entries_.begin());
+        bytes_ += bytes;
+    }
+    
+    void stats(CppMatrixCacheStats& stats) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.evictions = evictions_;
+        stats.entries = static_cast<long long>(entries_.size());
+        stats.bytes = static_cast<long long>(bytes_);
+        stats.budget = static_cast<long long>(budget_.load(std::memory_order_relaxed));
+    }
+};
+
+// Never destroyed, like the handle table: cached results may outlive static destructors
+static MatrixResultCache& matrix_result_cache() {
+    static MatrixResultCache* cache = new MatrixResultCache();
+    return *cache;
+}
+
+// Runs compute() through the cache when it is enabled and every operand is tracked
+template<typename T, typename Compute>
+static std::unique_ptr<BasicMatrix<T>> cached_matrix_result(int kind, const BasicMatrix<T>& left,
+                                                           const BasicMatrix<T>* right, Compute compute) {
+    MatrixResultCache& cache = matrix_result_cache();
+    if (!cache.enabled()) return compute();
+    MatrixCacheKey key{kind * 4 + MatrixCacheType<T>::value, left.content_stamp(),
+                       right ? right->content_stamp() : 0};
+    if (key.left == kUntrackedStamp || (right && key.right == kUntrackedStamp)) return compute();
+    
+    if (std::shared_ptr<const void> hit = cache.find(key)) {
+        return BasicMatrix<T>::shared_view(std::static_pointer_cast<const BasicMatrix<T>>(hit));
+    }
+    std::shared_ptr<const BasicMatrix<T>> result(compute().release());
+    result->content_stamp();
+    cache.insert(key, result, result->element_count() * sizeof(T));
+    return BasicMatrix<T>::shared_view(result);
+}
+
+static const int kCachedMultiply = 0;
+static const int kCachedTranspose = 1;
+
+template<typename T>
+static void* typed_matrix_multiply(void* a, void* b) {
+    BasicMatrix<T>* left = handle_cast<BasicMatrix<T>>(a);
+    BasicMatrix<T>* right = handle_cast<BasicMatrix<T>>(b);
+    if (!left || !right) return nullptr;
+    try {
+        return new_handle(cached_matrix_result<T>(kCachedMultiply, *left, right,
+                                                  [&] { return left->multiply(*right); }));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+template<typename T>
+static void* typed_matrix_transpose(void* handle) {
+    BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    if (!matrix) return nullptr;
+    try {
+        return new_handle(cached_matrix_result<T>(kCachedTranspose, *matrix, nullptr,
+                                                  [&] { return matrix->transpose(); }));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+template<typename T>
+static CppResultCode typed_matrix_gemm(T alpha, void* a, void* b, T beta, void* c) {
+    BasicMatrix<T>* left = handle_cast<BasicMatrix<T>>(a);
+    BasicMatrix<T>* right = handle_cast<BasicMatrix<T>>(b);
+    BasicMatrix<T>* out = handle_cast<BasicMatrix<T>>(c);
+    if (!left || !right || !out) return CPP_NULL_POINTER;
+    try {
+        out->gemm(alpha, *left, *right, beta);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+template<typename T>
+static CppResultCode typed_matrix_transpose_into(void* handle, void* out) {
+    BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    BasicMatrix<T>* target = handle_cast<BasicMatrix<T>>(out);
+    if (!matrix || !target) return CPP_NULL_POINTER;
+    try {
+        matrix->transpose_into(*target);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+template<typename T>
+static void* typed_matrix_open_mmap(const char* path, int readonly) {
+    if (!path) {
+        set_last_error(CPP_NULL_POINTER, "Path is null");
+        return nullptr;
+    }
+    try {
+        return new_handle(BasicMatrix<T>::open_mapped(path, readonly != 0));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+template<typename T>
+static CppResultCode typed_matrix_save(void* handle, const char* path) {
+    BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    if (!matrix || !path) return CPP_NULL_POINTER;
+    try {
+        matrix->save(path);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+template<typename T>
+static CppResultCode typed_matrix_transpose_in_place(void* handle) {
+    BasicMatrix<T>* matrix = handle_cast<BasicMatrix<T>>(handle);
+    if (!matrix) return CPP_NULL_POINTER;
+    try {
+        matrix->transpose_in_place();
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+static void fill_stats_result(const StatsPartial& stats, StatsResult* result) {
+    *result = StatsResult{};
+    if (stats.count == 0.0) return;
+
+    result->count = static_cast<long long>(stats.count);
+    result->sum = stats.sum;
+    result->mean = stats.mean;
+    result->variance = stats.m2 / stats.count;
+    result->standard_deviation = std::sqrt(result->variance);
+    result->min = stats.min;
+    result->max = stats.max;
+}
+
+static void summarize_statistics(const double* values, std::size_t count, StatsResult* result) {
+    fill_stats_result(count > 0 ? stats_pairwise(values, count) : StatsPartial(), result);
+}
+
+// C API implementations
+
+// Vector operations
+extern "C" {
+
+VectorHandle vector_create() {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return new_handle(new VectorWrapper());
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+void vector_destroy(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<VectorWrapper>(handle);
+}
+
+void vector_add(VectorHandle handle, int value) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (VectorWrapper* vector = handle_cast<VectorWrapper>(handle)) {
+        vector->add(value);
+    }
+}
+
+int vector_get(VectorHandle handle, int index) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (VectorWrapper* vector = handle_cast<VectorWrapper>(handle)) {
+        try {
+            return vector->get(index);
+        } catch (const std::exception& e) {
+            set_last_error(e);
+        }
+    }
+    return 0;
+}
+
+int vector_size(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? vector->size() : 0;
+}
+
+void vector_clear(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (VectorWrapper* vector = handle_cast<VectorWrapper>(handle)) {
+        vector->clear();
+    }
+}
+
+int vector_sum(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? vector->sum() : 0;
+}
+
+long long vector_sum_i64(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? vector->sum_i64() : 0;
+}
+
+void vector_sort(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (VectorWrapper* vector = handle_cast<VectorWrapper>(handle)) {
+        vector->sort();
+    }
+}
+
+CppResultCode vector_reserve(VectorHandle handle, int capacity) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    if (!vector) return CPP_NULL_POINTER;
+    if (capacity < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Capacity must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    try {
+        vector->reserve(static_cast<std::size_t>(capacity));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return CPP_MEMORY_ERROR;
+    }
+}
+
+CppResultCode vector_add_range(VectorHandle handle, const int* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    if (!vector) return CPP_NULL_POINTER;
+    if (count < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Count must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (count == 0) return CPP_SUCCESS;
+    if (!values) return CPP_NULL_POINTER;
+    try {
+        vector->add_range(values, static_cast<std::size_t>(count));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return CPP_MEMORY_ERROR;
+    }
+}
+
+CppResultCode vector_copy_to(VectorHandle handle, int* buffer, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    const VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    if (!vector) return CPP_NULL_POINTER;
+    if (vector->size() == 0) return CPP_SUCCESS;
+    if (!buffer) return CPP_NULL_POINTER;
+    if (count < vector->size()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Destination buffer is smaller than the vector");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    vector->copy_to(buffer);
+    return CPP_SUCCESS;
+}
+
+const int* vector_data(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? vector->data_ptr() : nullptr;
+}
+
+CppResultCode vector_build_index(VectorHandle handle, int kinds) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    if (!vector) return CPP_NULL_POINTER;
+    if (kinds & ~(CPP_VECTOR_INDEX_HASH | CPP_VECTOR_INDEX_SORTED)) {
+        set_last_error(CPP_INVALID_OPERATION, "Unknown vector index kind");
+        return CPP_INVALID_OPERATION;
+    }
+    try {
+        vector->build_index((kinds & CPP_VECTOR_INDEX_HASH) != 0, (kinds & CPP_VECTOR_INDEX_SORTED) != 0);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return CPP_MEMORY_ERROR;
+    }
+}
+
+int vector_index_kinds(VectorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? vector->index_kinds() : 0;
+}
+
+int vector_contains(VectorHandle handle, int value) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector && vector->contains(value) ? 1 : 0;
+}
+
+int vector_lower_bound(VectorHandle handle, int value) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? static_cast<int>(vector->count_below(value)) : 0;
+}
+
+int vector_count_range(VectorHandle handle, int low, int high) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    return vector ? static_cast<int>(vector->count_range(low, high)) : 0;
+}
+
+// String operations
+StringHandle string_create(const char* initial_value) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return new_handle(new StringWrapper(initial_value ? initial_value : ""));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+void string_destroy(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<StringWrapper>(handle);
+}
+
+const char* string_get_cstr(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    return wrapper ? wrapper->c_str() : "";
+}
+
+void string_append(StringHandle handle, const char* text) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (wrapper && text) {
+        wrapper->append(text);
+    }
+}
+
+void string_prepend(StringHandle handle, const char* text) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (wrapper && text) {
+        wrapper->prepend(text);
+    }
+}
+
+StringHandle string_create_utf8(const char* text, int length) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (length < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Length must be non-negative");
+        return nullptr;
+    }
+    if (length > 0 && !text) {
+        set_last_error(CPP_NULL_POINTER, "Source buffer is null");
+        return nullptr;
+    }
+    try {
+        return new_handle(new StringWrapper(std::string(text ? text : "", static_cast<std::size_t>(length))));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+static CppResultCode string_add_utf8(StringHandle handle, const char* text, int length, bool at_front) {
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (!wrapper) return CPP_NULL_POINTER;
+    if (length < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Length must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (length == 0) return CPP_SUCCESS;
+    if (!text) return CPP_NULL_POINTER;
+    try {
+        if (wrapper->byte_length() + static_cast<std::size_t>(length) >
+            static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            set_last_error(CPP_OUT_OF_BOUNDS, "String would exceed the maximum length");
+            return CPP_OUT_OF_BOUNDS;
+        }
+        if (at_front) {
+            wrapper->prepend(text, static_cast<std::size_t>(length));
+        } else {
+            wrapper->append(text, static_cast<std::size_t>(length));
+        }
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+CppResultCode string_append_utf8(StringHandle handle, const char* text, int length) {
+    CPP_INSTRUMENT_FUNCTION();
+    return string_add_utf8(handle, text, length, false);
+}
+
+CppResultCode string_prepend_utf8(StringHandle handle, const char* text, int length) {
+    CPP_INSTRUMENT_FUNCTION();
+    return string_add_utf8(handle, text, length, true);
+}
+
+CppResultCode string_view(StringHandle handle, const char** data, int* length) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (!wrapper || !data || !length) return CPP_NULL_POINTER;
+    *data = wrapper->c_str();
+    *length = static_cast<int>(wrapper->byte_length());
+    return CPP_SUCCESS;
+}
+
+StringHandle string_create_rope(const char* text, int length) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (length < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Length must be non-negative");
+        return nullptr;
+    }
+    if (length > 0 && !text) {
+        set_last_error(CPP_NULL_POINTER, "Source buffer is null");
+        return nullptr;
+    }
+    try {
+        return new_handle(StringWrapper::rope(text, static_cast<std::size_t>(length)));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+CppResultCode string_insert_utf8(StringHandle handle, int offset, const char* text, int length) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (!wrapper) return CPP_NULL_POINTER;
+    if (length < 0 || offset < 0 || static_cast<std::size_t>(offset) > wrapper->byte_length()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Insert offset or length out of range");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (length == 0) return CPP_SUCCESS;
+    if (!text) return CPP_NULL_POINTER;
+    if (wrapper->byte_length() + static_cast<std::size_t>(length) >
+        static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "String would exceed the maximum length");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    try {
+        wrapper->insert(static_cast<std::size_t>(offset), text, static_cast<std::size_t>(length));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+int string_chunk_count(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    return wrapper ? wrapper->chunk_count() : 0;
+}
+
+CppResultCode string_chunk_at(StringHandle handle, int index, const char** data, int* length) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    if (!wrapper || !data || !length) return CPP_NULL_POINTER;
+    try {
+        std::pair<const char*, std::size_t> chunk = wrapper->chunk_at(index);
+        *data = chunk.first;
+        *length = static_cast<int>(chunk.second);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+static void transform_text(char* text, std::size_t count, CppStringTransform transform) {
+    switch (transform) {
+        case CPP_STRING_TO_UPPER: fold_case(text, count, true); break;
+        case CPP_STRING_TO_LOWER: fold_case(text, count, false); break;
+        case CPP_STRING_REVERSE: reverse_utf8(text, count); break;
+    }
+}
+
+// Batches this large are split across the thread pool by string
+static const int kParallelStringBatch = 1 << 14;
+
+CppResultCode string_transform_batch(char* bytes, int byte_count, const int* offsets, int count,
+                                     CppStringTransform transform) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (count < 0 || byte_count < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Counts must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (transform != CPP_STRING_TO_UPPER && transform != CPP_STRING_TO_LOWER && transform != CPP_STRING_REVERSE) {
+        set_last_error(CPP_INVALID_OPERATION, "Unknown string transform");
+        return CPP_INVALID_OPERATION;
+    }
+    if (count == 0) return CPP_SUCCESS;
+    if (!offsets || (byte_count > 0 && !bytes)) return CPP_NULL_POINTER;
+    if (offsets[0] < 0 || offsets[count] > byte_count) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "String offsets fall outside the buffer");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    for (int i = 0; i < count; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            set_last_error(CPP_OUT_OF_BOUNDS, "String offsets must be non-decreasing");
+            return CPP_OUT_OF_BOUNDS;
+        }
+    }
+    try {
+        auto run = [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                transform_text(bytes + offsets[i], static_cast<std::size_t>(offsets[i + 1] - offsets[i]), transform);
+            }
+        };
+        if (count < kParallelStringBatch) {
+            run(0, count);
+        } else {
+            int chunks = std::min(count / (kParallelStringBatch / 4), thread_pool()->size() * 4);
+            parallel_for(chunks, [&](int chunk) {
+                run(static_cast<int>(static_cast<long long>(count) * chunk / chunks),
+                    static_cast<int>(static_cast<long long>(count) * (chunk + 1) / chunks));
+            });
+        }
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+int string_length_cpp(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    StringWrapper* wrapper = handle_cast<StringWrapper>(handle);
+    return wrapper ? wrapper->length() : 0;
+}
+
+void string_reverse(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (StringWrapper* wrapper = handle_cast<StringWrapper>(handle)) {
+        wrapper->reverse();
+    }
+}
+
+void string_to_upper(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (StringWrapper* wrapper = handle_cast<StringWrapper>(handle)) {
+        wrapper->to_upper();
+    }
+}
+
+void string_to_lower(StringHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (StringWrapper* wrapper = handle_cast<StringWrapper>(handle)) {
+        wrapper->to_lower();
+    }
+}
+
+// Mathematical operations
+double calculate_mean_double(const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return calculate_mean_template(values, count);
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return 0.0;
+    }
+}
+
+float calculate_mean_float(const float* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return calculate_mean_template(values, count);
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return 0.0f;
+    }
+}
+
+double calculate_variance(const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return calculate_variance_template(values, count);
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return 0.0;
+    }
+}
+
+double calculate_standard_deviation(const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        double variance = calculate_variance_template(values, count);
+        return std::sqrt(variance);
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return 0.0;
+    }
+}
+
+CppResultCode calculate_statistics(const double* values, int count, StatsResult* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!result) return CPP_NULL_POINTER;
+    if (count < 0) return CPP_INVALID_OPERATION;
+    if (count > 0 && !values) return CPP_NULL_POINTER;
+
+    summarize_statistics(values, static_cast<std::size_t>(count), result);
+    return CPP_SUCCESS;
+}
+
+CppResultCode array_save(const double* values, int count, const char* path) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!path) return CPP_NULL_POINTER;
+    if (count < 0) return CPP_INVALID_OPERATION;
+    if (count > 0 && !values) return CPP_NULL_POINTER;
+    try {
+        write_matrix_file(path, kMatrixFileFloat64, count, 1, values, static_cast<std::size_t>(count) * sizeof(double));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+CppResultCode calculate_statistics_mmap(const char* path, StatsResult* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!path || !result) return CPP_NULL_POINTER;
+    try {
+        MappedFile file(path, false);
+        const double* values = static_cast<const double*>(file.elements(kMatrixFileFloat64, sizeof(double)));
+        const MatrixFileHeader& header = file.header();
+        summarize_statistics(values, static_cast<std::size_t>(header.rows) * static_cast<std::size_t>(header.cols), result);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+// Streaming statistics operations
+StatsAccumulatorHandle stats_create() {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return new StatsAccumulator();
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+void stats_destroy(StatsAccumulatorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete static_cast<StatsAccumulator*>(handle);
+}
+
+CppResultCode stats_push_batch(StatsAccumulatorHandle handle, const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!handle) return CPP_NULL_POINTER;
+    if (count < 0) return CPP_INVALID_OPERATION;
+    if (count > 0 && !values) return CPP_NULL_POINTER;
+    static_cast<StatsAccumulator*>(handle)->push(values, static_cast<std::size_t>(count));
+    return CPP_SUCCESS;
+}
+
+CppResultCode stats_merge(StatsAccumulatorHandle target, StatsAccumulatorHandle source) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!target || !source) return CPP_NULL_POINTER;
+    static_cast<StatsAccumulator*>(target)->merge(*static_cast<StatsAccumulator*>(source));
+    return CPP_SUCCESS;
+}
+
+CppResultCode stats_snapshot(StatsAccumulatorHandle handle, StatsResult* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!handle || !result) return CPP_NULL_POINTER;
+    fill_stats_result(static_cast<StatsAccumulator*>(handle)->partial(), result);
+    return CPP_SUCCESS;
+}
+
+void stats_reset(StatsAccumulatorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (handle) {
+        static_cast<StatsAccumulator*>(handle)->reset();
+    }
+}
+
+// Matrix operations
+MatrixHandle matrix_create(int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create<double>(rows, cols);
+}
+
+MatrixHandle matrix_create_from_buffer(const double* data, int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create_from_buffer<double>(data, rows, cols);
+}
+
+void matrix_destroy(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<BasicMatrix<double>>(handle);
+}
+
+void matrix_set(MatrixHandle handle, int row, int col, double value) {
+    CPP_INSTRUMENT_FUNCTION();
+    typed_matrix_set<double>(handle, row, col, value);
+}
+
+double matrix_get(MatrixHandle handle, int row, int col) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_get<double>(handle, row, col);
+}
+
+CppResultCode matrix_copy_from_buffer(MatrixHandle handle, const double* data, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_from_buffer<double>(handle, data, count);
+}
+
+CppResultCode matrix_copy_to_buffer(MatrixHandle handle, double* buffer, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_to_buffer<double>(handle, buffer, count);
+}
+
+double* matrix_data_ptr(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<double>* matrix = handle_cast<BasicMatrix<double>>(handle);
+    return matrix ? matrix->expose_data() : nullptr;
+}
+
+int matrix_rows(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<double>* matrix = handle_cast<BasicMatrix<double>>(handle);
+    return matrix ? matrix->rows() : 0;
+}
+
+int matrix_cols(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<double>* matrix = handle_cast<BasicMatrix<double>>(handle);
+    return matrix ? matrix->cols() : 0;
+}
+
+MatrixHandle matrix_multiply(MatrixHandle a, MatrixHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_multiply<double>(a, b);
+}
+
+MatrixHandle matrix_transpose(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose<double>(handle);
+}
+
+CppResultCode matrix_cache_set_budget(long long bytes) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (bytes < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Cache budget must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    matrix_result_cache().set_budget(static_cast<std::size_t>(bytes));
+    return CPP_SUCCESS;
+}
+
+void matrix_cache_clear() {
+    CPP_INSTRUMENT_FUNCTION();
+    matrix_result_cache().clear();
+}
+
+CppResultCode matrix_cache_stats(CppMatrixCacheStats* stats) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!stats) return CPP_NULL_POINTER;
+    matrix_result_cache().stats(*stats);
+    return CPP_SUCCESS;
+}
+
+// Sparse matrix operations
+SparseMatrixHandle sparse_matrix_from_coo(int rows, int cols, const int* row_indices, const int* col_indices,
+                                          const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (count > 0 && (!row_indices || !col_indices || !values)) {
+        set_last_error(CPP_NULL_POINTER, "Entry buffer is null");
+        return nullptr;
+    }
+    try {
+        return new_handle(SparseMatrix::from_coo(rows, cols, row_indices, col_indices, values, count));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+SparseMatrixHandle sparse_matrix_from_dense(MatrixHandle dense) {
+    CPP_INSTRUMENT_FUNCTION();
+    const Matrix* matrix = handle_cast<Matrix>(dense);
+    if (!matrix) return nullptr;
+    try {
+        return new_handle(SparseMatrix::from_dense(*matrix));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+MatrixHandle sparse_matrix_to_dense(SparseMatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    if (!matrix) return nullptr;
+    try {
+        return new_handle(matrix->to_dense());
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+void sparse_matrix_destroy(SparseMatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<SparseMatrix>(handle);
+}
+
+int sparse_matrix_rows(SparseMatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    return matrix ? matrix->rows() : 0;
+}
+
+int sparse_matrix_cols(SparseMatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    return matrix ? matrix->cols() : 0;
+}
+
+int sparse_matrix_nnz(SparseMatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    return matrix ? matrix->nnz() : 0;
+}
+
+double sparse_matrix_get(SparseMatrixHandle handle, int row, int col) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle)) {
+        try {
+            return matrix->get(row, col);
+        } catch (const std::exception& e) {
+            set_last_error(e);
+        }
+    }
+    return 0.0;
+}
+
+int sparse_matrix_to_coo(SparseMatrixHandle handle, int* row_indices, int* col_indices, double* values, int capacity) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    if (!matrix) return 0;
+    if (capacity > 0 && (!row_indices || !col_indices || !values)) {
+        set_last_error(CPP_NULL_POINTER, "Entry buffer is null");
+        return 0;
+    }
+    if (capacity > 0) matrix->copy_coo(row_indices, col_indices, values, capacity);
+    return matrix->nnz();
+}
+
+CppResultCode sparse_matrix_spmv(SparseMatrixHandle handle, const double* x, int x_count, double* y, int y_count) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* matrix = handle_cast<SparseMatrix>(handle);
+    if (!matrix) return CPP_NULL_POINTER;
+    if ((matrix->cols() > 0 && !x) || (matrix->rows() > 0 && !y)) return CPP_NULL_POINTER;
+    if (x_count < matrix->cols() || y_count < matrix->rows()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Vector is shorter than the matrix dimension");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    try {
+        matrix->spmv(x, y);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+MatrixHandle sparse_matrix_multiply_dense(SparseMatrixHandle a, MatrixHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* left = handle_cast<SparseMatrix>(a);
+    const Matrix* right = handle_cast<Matrix>(b);
+    if (!left || !right) return nullptr;
+    try {
+        return new_handle(left->multiply(*right));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+SparseMatrixHandle sparse_matrix_multiply(SparseMatrixHandle a, SparseMatrixHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    const SparseMatrix* left = handle_cast<SparseMatrix>(a);
+    const SparseMatrix* right = handle_cast<SparseMatrix>(b);
+    if (!left || !right) return nullptr;
+    try {
+        return new_handle(left->multiply(*right));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+// Lazy expression operations
+MatrixExprHandle matrix_expr_leaf(MatrixHandle matrix) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* leaf = handle_cast<Matrix>(matrix);
+    if (!leaf) return nullptr;
+    try {
+        return new MatrixExpr(MatrixExpr::leaf(matrix, *leaf));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+MatrixExprHandle matrix_expr_transpose(MatrixExprHandle expr) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!expr) return nullptr;
+    try {
+        return new MatrixExpr(static_cast<MatrixExpr*>(expr)->transpose());
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+MatrixExprHandle matrix_expr_mul(MatrixExprHandle a, MatrixExprHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!a || !b) return nullptr;
+    try {
+        return new MatrixExpr(static_cast<MatrixExpr*>(a)->multiply(*static_cast<MatrixExpr*>(b)));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+MatrixExprHandle matrix_expr_add(MatrixExprHandle a, MatrixExprHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!a || !b) return nullptr;
+    try {
+        return new MatrixExpr(static_cast<MatrixExpr*>(a)->add(*static_cast<MatrixExpr*>(b)));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+int matrix_expr_rows(MatrixExprHandle expr) {
+    CPP_INSTRUMENT_FUNCTION();
+    return expr ? static_cast<MatrixExpr*>(expr)->rows() : 0;
+}
+
+int matrix_expr_cols(MatrixExprHandle expr) {
+    CPP_INSTRUMENT_FUNCTION();
+    return expr ? static_cast<MatrixExpr*>(expr)->cols() : 0;
+}
+
+MatrixHandle matrix_expr_eval(MatrixExprHandle expr) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!expr) return nullptr;
+    try {
+        return new_handle(static_cast<MatrixExpr*>(expr)->evaluate());
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
+}
+
+CppResultCode matrix_expr_eval_into(MatrixExprHandle expr, MatrixHandle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* target = handle_cast<Matrix>(out);
+    if (!expr || !target) return CPP_NULL_POINTER;
+    try {
+        static_cast<MatrixExpr*>(expr)->evaluate_into(*target);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
+}
+
+void matrix_expr_destroy(MatrixExprHandle expr) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete static_cast<MatrixExpr*>(expr);
+}
+
+CppResultCode matrix_multiply_into(MatrixHandle a, MatrixHandle b, MatrixHandle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<double>(1.0, a, b, 0.0, out);
+}
+
+CppResultCode matrix_gemm(double alpha, MatrixHandle a, MatrixHandle b, double beta, MatrixHandle c) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<double>(alpha, a, b, beta, c);
+}
+
+CppResultCode matrix_transpose_into(MatrixHandle handle, MatrixHandle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_into<double>(handle, out);
+}
+
+CppResultCode matrix_transpose_in_place(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_in_place<double>(handle);
+}
+
+MatrixHandle matrix_open_mmap(const char* path, int readonly) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_open_mmap<double>(path, readonly);
+}
+
+CppResultCode matrix_save(MatrixHandle handle, const char* path) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_save<double>(handle, path);
+}
+
+void matrix_print(MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (Matrix* matrix = handle_cast<Matrix>(handle)) {
+        matrix->print();
+    }
+}
+
+// Single-precision and int32 matrix operations
+MatrixF32Handle matrix_f32_create(int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create<float>(rows, cols);
+}
+
+MatrixF32Handle matrix_f32_create_from_buffer(const float* data, int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create_from_buffer<float>(data, rows, cols);
+}
+
+void matrix_f32_destroy(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<BasicMatrix<float>>(handle);
+}
+
+void matrix_f32_set(MatrixF32Handle handle, int row, int col, float value) {
+    CPP_INSTRUMENT_FUNCTION();
+    typed_matrix_set<float>(handle, row, col, value);
+}
+
+float matrix_f32_get(MatrixF32Handle handle, int row, int col) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_get<float>(handle, row, col);
+}
+
+CppResultCode matrix_f32_copy_from_buffer(MatrixF32Handle handle, const float* data, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_from_buffer<float>(handle, data, count);
+}
+
+CppResultCode matrix_f32_copy_to_buffer(MatrixF32Handle handle, float* buffer, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_to_buffer<float>(handle, buffer, count);
+}
+
+float* matrix_f32_data_ptr(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<float>* matrix = handle_cast<BasicMatrix<float>>(handle);
+    return matrix ? matrix->expose_data() : nullptr;
+}
+
+int matrix_f32_rows(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<float>* matrix = handle_cast<BasicMatrix<float>>(handle);
+    return matrix ? matrix->rows() : 0;
+}
+
+int matrix_f32_cols(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<float>* matrix = handle_cast<BasicMatrix<float>>(handle);
+    return matrix ? matrix->cols() : 0;
+}
+
+MatrixF32Handle matrix_f32_multiply(MatrixF32Handle a, MatrixF32Handle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_multiply<float>(a, b);
+}
+
+MatrixF32Handle matrix_f32_transpose(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose<float>(handle);
+}
+
+CppResultCode matrix_f32_multiply_into(MatrixF32Handle a, MatrixF32Handle b, MatrixF32Handle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<float>(1.0f, a, b, 0.0f, out);
+}
+
+CppResultCode matrix_f32_gemm(float alpha, MatrixF32Handle a, MatrixF32Handle b, float beta, MatrixF32Handle c) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<float>(alpha, a, b, beta, c);
+}
+
+CppResultCode matrix_f32_transpose_into(MatrixF32Handle handle, MatrixF32Handle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_into<float>(handle, out);
+}
+
+CppResultCode matrix_f32_transpose_in_place(MatrixF32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_in_place<float>(handle);
+}
+
+MatrixF32Handle matrix_f32_open_mmap(const char* path, int readonly) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_open_mmap<float>(path, readonly);
+}
+
+CppResultCode matrix_f32_save(MatrixF32Handle handle, const char* path) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_save<float>(handle, path);
+}
+
+MatrixI32Handle matrix_i32_create(int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create<int>(rows, cols);
+}
+
+MatrixI32Handle matrix_i32_create_from_buffer(const int* data, int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_create_from_buffer<int>(data, rows, cols);
+}
+
+void matrix_i32_destroy(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<BasicMatrix<int>>(handle);
+}
+
+void matrix_i32_set(MatrixI32Handle handle, int row, int col, int value) {
+    CPP_INSTRUMENT_FUNCTION();
+    typed_matrix_set<int>(handle, row, col, value);
+}
+
+int matrix_i32_get(MatrixI32Handle handle, int row, int col) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_get<int>(handle, row, col);
+}
+
+CppResultCode matrix_i32_copy_from_buffer(MatrixI32Handle handle, const int* data, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_from_buffer<int>(handle, data, count);
+}
+
+CppResultCode matrix_i32_copy_to_buffer(MatrixI32Handle handle, int* buffer, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_copy_to_buffer<int>(handle, buffer, count);
+}
+
+int* matrix_i32_data_ptr(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<int>* matrix = handle_cast<BasicMatrix<int>>(handle);
+    return matrix ? matrix->expose_data() : nullptr;
+}
+
+int matrix_i32_rows(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<int>* matrix = handle_cast<BasicMatrix<int>>(handle);
+    return matrix ? matrix->rows() : 0;
+}
+
+int matrix_i32_cols(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    BasicMatrix<int>* matrix = handle_cast<BasicMatrix<int>>(handle);
+    return matrix ? matrix->cols() : 0;
+}
+
+MatrixI32Handle matrix_i32_multiply(MatrixI32Handle a, MatrixI32Handle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_multiply<int>(a, b);
+}
+
+MatrixI32Handle matrix_i32_transpose(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose<int>(handle);
+}
+
+CppResultCode matrix_i32_multiply_into(MatrixI32Handle a, MatrixI32Handle b, MatrixI32Handle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<int>(1, a, b, 0, out);
 }
 
-template<typename T>
-T calculate_variance_template(const T* values, int count) {
-    if (count <= 0) return T(0);
-    T mean = calculate_mean_template(values, count);
-    T sum_squared_diff = 0;
-    for (int i = 0; i < count; i++) {
-        T diff = values[i] - mean;
-        sum_squared_diff += diff * diff;
-    }
-    return sum_squared_diff / count;
+CppResultCode matrix_i32_gemm(int alpha, MatrixI32Handle a, MatrixI32Handle b, int beta, MatrixI32Handle c) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_gemm<int>(alpha, a, b, beta, c);
 }
 
-// C API implementations
+CppResultCode matrix_i32_transpose_into(MatrixI32Handle handle, MatrixI32Handle out) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_into<int>(handle, out);
+}
 
-// Vector operations
-extern "C" {
+CppResultCode matrix_i32_transpose_in_place(MatrixI32Handle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_transpose_in_place<int>(handle);
+}
 
-VectorHandle vector_create() {
-    try {
-        return new VectorWrapper();
-    } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return nullptr;
-    }
+MatrixI32Handle matrix_i32_open_mmap(const char* path, int readonly) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_open_mmap<int>(path, readonly);
 }
 
-void vector_destroy(VectorHandle handle) {
-    delete static_cast<VectorWrapper*>(handle);
+CppResultCode matrix_i32_save(MatrixI32Handle handle, const char* path) {
+    CPP_INSTRUMENT_FUNCTION();
+    return typed_matrix_save<int>(handle, path);
 }
 
-void vector_add(VectorHandle handle, int value) {
-    if (handle) {
-        static_cast<VectorWrapper*>(handle)->add(value);
+// Smart resource operations
+SmartResourceHandle smart_resource_create(int size) {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return new_handle(new SmartResource(size));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-int vector_get(VectorHandle handle, int index) {
-    if (handle) {
-        try {
-            return static_cast<VectorWrapper*>(handle)->get(index);
-        } catch (const std::exception& e) {
-            last_error_message = e.what();
-        }
+void smart_resource_use(SmartResourceHandle handle, int index, double value) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (SmartResource* resource = handle_cast<SmartResource>(handle)) {
+        resource->set(index, value);
     }
-    return 0;
 }
 
-int vector_size(VectorHandle handle) {
-    return handle ? static_cast<VectorWrapper*>(handle)->size() : 0;
+double smart_resource_get(SmartResourceHandle handle, int index) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    return resource ? resource->get(index) : 0.0;
 }
 
-void vector_clear(VectorHandle handle) {
-    if (handle) {
-        static_cast<VectorWrapper*>(handle)->clear();
-    }
+int smart_resource_size(SmartResourceHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    return resource ? resource->size() : 0;
 }
 
-int vector_sum(VectorHandle handle) {
-    return handle ? static_cast<VectorWrapper*>(handle)->sum() : 0;
+void smart_resource_destroy(SmartResourceHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<SmartResource>(handle);
 }
 
-void vector_sort(VectorHandle handle) {
-    if (handle) {
-        static_cast<VectorWrapper*>(handle)->sort();
+SmartResourceHandle smart_resource_create_ex(int size, int flags) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (flags & ~CPP_RESOURCE_HUGE_PAGES) {
+        set_last_error(CPP_INVALID_OPERATION, "Unknown resource flags");
+        return nullptr;
     }
-}
-
-// String operations
-StringHandle string_create(const char* initial_value) {
     try {
-        return new StringWrapper(initial_value ? initial_value : "");
+        return new_handle(new SmartResource(size, (flags & CPP_RESOURCE_HUGE_PAGES) != 0));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void string_destroy(StringHandle handle) {
-    delete static_cast<StringWrapper*>(handle);
+double* smart_resource_data_ptr(SmartResourceHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    return resource ? resource->data() : nullptr;
 }
 
-const char* string_get_cstr(StringHandle handle) {
-    return handle ? static_cast<StringWrapper*>(handle)->c_str() : "";
+int smart_resource_huge_pages(SmartResourceHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    return resource && resource->huge_pages() ? 1 : 0;
 }
 
-void string_append(StringHandle handle, const char* text) {
-    if (handle && text) {
-        static_cast<StringWrapper*>(handle)->append(text);
+CppResultCode smart_resource_fill(SmartResourceHandle handle, int offset, int count, double value) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    if (!resource) return CPP_NULL_POINTER;
+    try {
+        resource->fill(offset, count, value);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
     }
 }
 
-void string_prepend(StringHandle handle, const char* text) {
-    if (handle && text) {
-        static_cast<StringWrapper*>(handle)->prepend(text);
+CppResultCode smart_resource_copy_in(SmartResourceHandle handle, int offset, const double* values, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    if (!resource || (count > 0 && !values)) return CPP_NULL_POINTER;
+    try {
+        resource->copy_in(offset, values, count);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
     }
 }
 
-int string_length_cpp(StringHandle handle) {
-    return handle ? static_cast<StringWrapper*>(handle)->length() : 0;
+CppResultCode smart_resource_copy_out(SmartResourceHandle handle, int offset, double* buffer, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    if (!resource || (count > 0 && !buffer)) return CPP_NULL_POINTER;
+    try {
+        resource->copy_out(offset, buffer, count);
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
 }
 
-void string_reverse(StringHandle handle) {
-    if (handle) {
-        static_cast<StringWrapper*>(handle)->reverse();
+CppResultCode smart_resource_statistics(SmartResourceHandle handle, int offset, int count, StatsResult* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    if (!resource || !result) return CPP_NULL_POINTER;
+    if (offset < 0 || count < 0 || offset > resource->size() - count) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Resource range out of bounds");
+        return CPP_OUT_OF_BOUNDS;
     }
+    summarize_statistics(resource->data() + offset, static_cast<std::size_t>(count), result);
+    return CPP_SUCCESS;
 }
 
-void string_to_upper(StringHandle handle) {
-    if (handle) {
-        static_cast<StringWrapper*>(handle)->to_upper();
+MatrixHandle matrix_create_over_resource(SmartResourceHandle handle, int offset, int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    SmartResource* resource = handle_cast<SmartResource>(handle);
+    if (!resource) return nullptr;
+    long long elements = static_cast<long long>(rows) * cols;
+    if (rows < 0 || cols < 0 || offset < 0 || offset + elements > resource->size()) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Matrix does not fit in the resource");
+        return nullptr;
+    }
+    try {
+        return new_handle(Matrix::over_storage(resource->storage(), resource->data() + offset, rows, cols));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-void string_to_lower(StringHandle handle) {
-    if (handle) {
-        static_cast<StringWrapper*>(handle)->to_lower();
+// Function operations
+FunctionHandle function_create_add() {
+    CPP_INSTRUMENT_FUNCTION();
+    try {
+        return new_handle(new FunctionWrapper(BinaryOp::Add));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-// Mathematical operations
-double calculate_mean_double(const double* values, int count) {
+FunctionHandle function_create_multiply() {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        return calculate_mean_template(values, count);
+        return new_handle(new FunctionWrapper(BinaryOp::Multiply));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return 0.0;
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-float calculate_mean_float(const float* values, int count) {
+FunctionHandle function_create_power() {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        return calculate_mean_template(values, count);
+        return new_handle(new FunctionWrapper(BinaryOp::Power));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return 0.0f;
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-double calculate_variance(const double* values, int count) {
+void function_destroy(FunctionHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<FunctionWrapper>(handle);
+}
+
+FunctionHandle function_input(int index) {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        return calculate_variance_template(values, count);
+        return new_handle(new FunctionWrapper(FunctionNode::make_input(index)));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return 0.0;
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-double calculate_standard_deviation(const double* values, int count) {
+FunctionHandle function_constant(double value) {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        double variance = calculate_variance_template(values, count);
-        return std::sqrt(variance);
+        return new_handle(new FunctionWrapper(FunctionNode::make_constant(value)));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return 0.0;
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-// Matrix operations
-MatrixHandle matrix_create(int rows, int cols) {
+FunctionHandle function_compose(FunctionHandle outer, FunctionHandle left, FunctionHandle right) {
+    CPP_INSTRUMENT_FUNCTION();
+    FunctionWrapper* outer_function = handle_cast<FunctionWrapper>(outer);
+    FunctionWrapper* left_function = handle_cast<FunctionWrapper>(left);
+    FunctionWrapper* right_function = handle_cast<FunctionWrapper>(right);
+    if (!outer_function || !left_function || !right_function) return nullptr;
     try {
-        return new Matrix(rows, cols);
+        return new_handle(new FunctionWrapper(FunctionNode::substitute(
+            outer_function->root(), left_function->root(), right_function->root())));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void matrix_destroy(MatrixHandle handle) {
-    delete static_cast<Matrix*>(handle);
+int function_arity(FunctionHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    FunctionWrapper* function = handle_cast<FunctionWrapper>(handle);
+    return function ? function->arity() : 0;
 }
 
-void matrix_set(MatrixHandle handle, int row, int col, double value) {
-    if (handle) {
+double function_call(FunctionHandle handle, double a, double b) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (FunctionWrapper* function = handle_cast<FunctionWrapper>(handle)) {
         try {
-            static_cast<Matrix*>(handle)->set(row, col, value);
+            return function->call(a, b);
         } catch (const std::exception& e) {
-            last_error_message = e.what();
+            set_last_error(e);
         }
     }
+    return 0.0;
 }
 
-double matrix_get(MatrixHandle handle, int row, int col) {
-    if (handle) {
-        try {
-            return static_cast<Matrix*>(handle)->get(row, col);
-        } catch (const std::exception& e) {
-            last_error_message = e.what();
-        }
+CppResultCode function_call_batch(FunctionHandle handle, const double* a, const double* b, double* out, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    FunctionWrapper* function = handle_cast<FunctionWrapper>(handle);
+    if (!function) return CPP_NULL_POINTER;
+    if (count < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Count must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (count == 0) return CPP_SUCCESS;
+    if (!a || !b || !out) return CPP_NULL_POINTER;
+    try {
+        function->call_batch(a, b, out, static_cast<std::size_t>(count));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
     }
-    return 0.0;
 }
 
-int matrix_rows(MatrixHandle handle) {
-    return handle ? static_cast<Matrix*>(handle)->rows() : 0;
+CppResultCode function_evaluate(FunctionHandle handle, const double* const* inputs, int input_count,
+                                double* out, int count) {
+    CPP_INSTRUMENT_FUNCTION();
+    FunctionWrapper* function = handle_cast<FunctionWrapper>(handle);
+    if (!function) return CPP_NULL_POINTER;
+    if (count < 0 || input_count < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Counts must be non-negative");
+        return CPP_OUT_OF_BOUNDS;
+    }
+    if (input_count < function->arity()) {
+        set_last_error(CPP_INVALID_OPERATION, "Function reads more inputs than were given");
+        return CPP_INVALID_OPERATION;
+    }
+    if (count == 0) return CPP_SUCCESS;
+    if (!out || (function->arity() > 0 && !inputs)) return CPP_NULL_POINTER;
+    for (int i = 0; i < function->arity(); i++) {
+        if (!inputs[i]) return CPP_NULL_POINTER;
+    }
+    try {
+        function->evaluate(inputs, input_count, out, static_cast<std::size_t>(count));
+        return CPP_SUCCESS;
+    } catch (const std::exception& e) {
+        return set_last_error(e);
+    }
 }
 
-int matrix_cols(MatrixHandle handle) {
-    return handle ? static_cast<Matrix*>(handle)->cols() : 0;
+void function_cache_stats(long long* hits, long long* misses, int* entries) {
+    CPP_INSTRUMENT_FUNCTION();
+    fused_kernel_cache().stats(hits, misses, entries);
 }
 
-MatrixHandle matrix_multiply(MatrixHandle a, MatrixHandle b) {
-    if (!a || !b) return nullptr;
+// Iterator operations
+IteratorHandle iterator_create(const int* array, int size) {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        auto result = static_cast<Matrix*>(a)->multiply(*static_cast<Matrix*>(b));
-        return result.release();
+        return new_handle(new IteratorWrapper(array, size));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-MatrixHandle matrix_transpose(MatrixHandle handle) {
-    if (!handle) return nullptr;
+void iterator_destroy(IteratorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete_handle<IteratorWrapper>(handle);
+}
+
+int iterator_has_next(IteratorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle);
+    return iterator && iterator->has_next() ? 1 : 0;
+}
+
+int iterator_next(IteratorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle);
+    return iterator ? iterator->next() : 0;
+}
+
+void iterator_reset(IteratorHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle)) {
+        iterator->reset();
+    }
+}
+
+int iterator_find(IteratorHandle handle, int value) {
+    CPP_INSTRUMENT_FUNCTION();
+    IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle);
+    return iterator && iterator->find(value) ? 1 : 0;
+}
+
+IteratorHandle iterator_create_borrowed(const int* array, int size) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (size < 0) {
+        set_last_error(CPP_OUT_OF_BOUNDS, "Size must be non-negative");
+        return nullptr;
+    }
+    if (size > 0 && !array) {
+        set_last_error(CPP_NULL_POINTER, "Source buffer is null");
+        return nullptr;
+    }
     try {
-        auto result = static_cast<Matrix*>(handle)->transpose();
-        return result.release();
+        return new_handle(new IteratorWrapper(array, size, IteratorWrapper::Borrowed()));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void matrix_print(MatrixHandle handle) {
-    if (handle) {
-        static_cast<Matrix*>(handle)->print();
+int iterator_next_batch(IteratorHandle handle, int* out, int max) {
+    CPP_INSTRUMENT_FUNCTION();
+    IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle);
+    if (!iterator || max <= 0) return 0;
+    if (!out) {
+        set_last_error(CPP_NULL_POINTER, "Output buffer is null");
+        return 0;
     }
+    return static_cast<int>(iterator->next_batch(out, static_cast<std::size_t>(max)));
 }
 
-// Smart resource operations
-SmartResourceHandle smart_resource_create(int size) {
+int iterator_find_all(IteratorHandle handle, int value, int* positions, int capacity) {
+    CPP_INSTRUMENT_FUNCTION();
+    IteratorWrapper* iterator = handle_cast<IteratorWrapper>(handle);
+    if (!iterator) return 0;
+    if (capacity < 0 || (capacity > 0 && !positions)) {
+        set_last_error(CPP_NULL_POINTER, "Positions buffer is null");
+        return 0;
+    }
+    return static_cast<int>(iterator->find_all(value, positions, static_cast<std::size_t>(capacity)));
+}
+
+// Exception handling
+CppResultCode safe_vector_get(VectorHandle handle, int index, int* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    VectorWrapper* vector = handle_cast<VectorWrapper>(handle);
+    if (!vector) return CPP_NULL_POINTER;
+    if (!result) return CPP_NULL_POINTER;
+    
+    try {
+        *result = vector->get(index);
+        return CPP_SUCCESS;
+    } catch (const std::out_of_range& e) {
+        set_last_error(e);
+        return CPP_OUT_OF_BOUNDS;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return CPP_UNKNOWN_ERROR;
+    }
+}
+
+CppResultCode safe_matrix_multiply(MatrixHandle a, MatrixHandle b, MatrixHandle* result) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* left = handle_cast<Matrix>(a);
+    Matrix* right = handle_cast<Matrix>(b);
+    if (!left || !right) return CPP_NULL_POINTER;
+    if (!result) return CPP_NULL_POINTER;
+    
+    try {
+        // Same cached path as matrix_multiply, so both entry points share hits and misses
+        *result = new_handle(cached_matrix_result<double>(kCachedMultiply, *left, right,
+                                                          [&] { return left->multiply(*right); }));
+        return CPP_SUCCESS;
+    } catch (const std::invalid_argument& e) {
+        set_last_error(e);
+        return CPP_INVALID_OPERATION;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return CPP_UNKNOWN_ERROR;
+    }
+}
+
+// Arena operations
+ArenaHandle cpp_arena_create(int block_size) {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        return new SmartResource(size);
+        return new Arena(block_size > 0 ? static_cast<std::size_t>(block_size) : kDefaultArenaBlockSize);
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void smart_resource_use(SmartResourceHandle handle, int index, double value) {
-    if (handle) {
-        static_cast<SmartResource*>(handle)->set(index, value);
+void cpp_arena_reset(ArenaHandle arena) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (arena) {
+        static_cast<Arena*>(arena)->reset();
     }
 }
 
-double smart_resource_get(SmartResourceHandle handle, int index) {
-    return handle ? static_cast<SmartResource*>(handle)->get(index) : 0.0;
+void cpp_arena_destroy(ArenaHandle arena) {
+    CPP_INSTRUMENT_FUNCTION();
+    delete static_cast<Arena*>(arena);
 }
 
-int smart_resource_size(SmartResourceHandle handle) {
-    return handle ? static_cast<SmartResource*>(handle)->size() : 0;
+long long cpp_arena_bytes_used(ArenaHandle arena) {
+    CPP_INSTRUMENT_FUNCTION();
+    return arena ? static_cast<long long>(static_cast<Arena*>(arena)->bytes_used()) : 0;
 }
 
-// Function operations
-FunctionHandle function_create_add() {
+MatrixHandle matrix_create_in(ArenaHandle arena, int rows, int cols) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!arena) return nullptr;
     try {
-        auto func = new std::function<double(double, double)>([](double a, double b) { return a + b; });
-        return func;
+        Arena& target = *static_cast<Arena*>(arena);
+        return target.adopt_handle(target.create<Matrix>(rows, cols, target));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-FunctionHandle function_create_multiply() {
+MatrixHandle matrix_multiply_in(ArenaHandle arena, MatrixHandle a, MatrixHandle b) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* left = handle_cast<Matrix>(a);
+    Matrix* right = handle_cast<Matrix>(b);
+    if (!arena || !left || !right) return nullptr;
     try {
-        auto func = new std::function<double(double, double)>([](double a, double b) { return a * b; });
-        return func;
+        Arena& target = *static_cast<Arena*>(arena);
+        return target.adopt_handle(left->multiply(*right, target));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-FunctionHandle function_create_power() {
+MatrixHandle matrix_transpose_in(ArenaHandle arena, MatrixHandle handle) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* matrix = handle_cast<Matrix>(handle);
+    if (!arena || !matrix) return nullptr;
     try {
-        auto func = new std::function<double(double, double)>([](double a, double b) { return std::pow(a, b); });
-        return func;
+        Arena& target = *static_cast<Arena*>(arena);
+        return target.adopt_handle(matrix->transpose(target));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void function_destroy(FunctionHandle handle) {
-    delete static_cast<std::function<double(double, double)>*>(handle);
+VectorHandle vector_create_in(ArenaHandle arena) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!arena) return nullptr;
+    try {
+        Arena& target = *static_cast<Arena*>(arena);
+        return target.adopt_handle(target.create<VectorWrapper>());
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
+    }
 }
 
-double function_call(FunctionHandle handle, double a, double b) {
-    if (handle) {
-        try {
-            return (*static_cast<std::function<double(double, double)>*>(handle))(a, b);
-        } catch (const std::exception& e) {
-            last_error_message = e.what();
-        }
+StringHandle string_create_in(ArenaHandle arena, const char* initial_value) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!arena) return nullptr;
+    try {
+        Arena& target = *static_cast<Arena*>(arena);
+        return target.adopt_handle(target.create<StringWrapper>(initial_value ? initial_value : ""));
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
     }
-    return 0.0;
 }
 
-// Iterator operations
-IteratorHandle iterator_create(const int* array, int size) {
+// Asynchronous operations
+JobHandle matrix_multiply_async(MatrixHandle a, MatrixHandle b, JobCallback callback, void* user_state) {
+    CPP_INSTRUMENT_FUNCTION();
+    Matrix* left = handle_cast<Matrix>(a);
+    Matrix* right = handle_cast<Matrix>(b);
+    if (!left || !right) {
+        if (!a || !b) set_last_error(CPP_NULL_POINTER, "Matrix handle is null");
+        return nullptr;
+    }
+    if (left->cols() != right->rows()) {
+        set_last_error(CPP_INVALID_OPERATION, "Matrix dimensions don't match for multiplication");
+        return nullptr;
+    }
     try {
-        return new IteratorWrapper(array, size);
+        // The job owns aliases of the operands, so destroying them cannot free what it reads
+        std::shared_ptr<const Matrix> left_alias(left->shared_alias());
+        std::shared_ptr<const Matrix> right_alias(right->shared_alias());
+        Job* job = new Job([left_alias, right_alias] { return left_alias->multiply(*right_alias).release(); },
+                           callback, user_state);
+        try {
+            job_runner().submit(job);
+        } catch (...) {
+            job->release();
+            throw;
+        }
+        return job;
     } catch (const std::exception& e) {
-        last_error_message = e.what();
+        set_last_error(e);
         return nullptr;
     }
 }
 
-void iterator_destroy(IteratorHandle handle) {
-    delete static_cast<IteratorWrapper*>(handle);
+CppResultCode job_poll(JobHandle job) {
+    CPP_INSTRUMENT_FUNCTION();
+    return job ? static_cast<Job*>(job)->status() : CPP_NULL_POINTER;
 }
 
-int iterator_has_next(IteratorHandle handle) {
-    return handle && static_cast<IteratorWrapper*>(handle)->has_next() ? 1 : 0;
+CppResultCode job_wait(JobHandle job, int timeout_ms) {
+    CPP_INSTRUMENT_FUNCTION();
+    return job ? static_cast<Job*>(job)->wait(timeout_ms) : CPP_NULL_POINTER;
 }
 
-int iterator_next(IteratorHandle handle) {
-    return handle ? static_cast<IteratorWrapper*>(handle)->next() : 0;
+CppResultCode job_cancel(JobHandle job) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!job) return CPP_NULL_POINTER;
+    return static_cast<Job*>(job)->cancel() ? CPP_SUCCESS : CPP_INVALID_OPERATION;
 }
 
-void iterator_reset(IteratorHandle handle) {
-    if (handle) {
-        static_cast<IteratorWrapper*>(handle)->reset();
+MatrixHandle job_result(JobHandle job) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (!job) return nullptr;
+    try {
+        Matrix* result = static_cast<Job*>(job)->take_result();
+        return result ? new_handle(result) : nullptr;
+    } catch (const std::exception& e) {
+        set_last_error(e);
+        return nullptr;
     }
 }
 
-int iterator_find(IteratorHandle handle, int value) {
-    return handle && static_cast<IteratorWrapper*>(handle)->find(value) ? 1 : 0;
+void job_destroy(JobHandle job) {
+    CPP_INSTRUMENT_FUNCTION();
+    if (job) {
+        static_cast<Job*>(job)->release();
+    }
 }
 
-// Exception handling
-CppResultCode safe_vector_get(VectorHandle handle, int index, int* result) {
-    if (!handle) return CPP_NULL_POINTER;
-    if (!result) return CPP_NULL_POINTER;
-    
+// Thread pool configuration
+void cpp_set_num_threads(int num_threads) {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        *result = static_cast<VectorWrapper*>(handle)->get(index);
-        return CPP_SUCCESS;
-    } catch (const std::out_of_range& e) {
-        last_error_message = e.what();
-        return CPP_OUT_OF_BOUNDS;
+        int count = num_threads > 0 ? num_threads : default_thread_count();
+        std::shared_ptr<ThreadPool> current = std::atomic_load(&thread_pool_slot());
+        if (current && current->size() == count) return;
+        std::atomic_store(&thread_pool_slot(), std::make_shared<ThreadPool>(count));
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return CPP_UNKNOWN_ERROR;
+        set_last_error(e);
     }
 }
 
-CppResultCode safe_matrix_multiply(MatrixHandle a, MatrixHandle b, MatrixHandle* result) {
-    if (!a || !b) return CPP_NULL_POINTER;
-    if (!result) return CPP_NULL_POINTER;
-    
+int cpp_get_num_threads() {
+    CPP_INSTRUMENT_FUNCTION();
     try {
-        auto product = static_cast<Matrix*>(a)->multiply(*static_cast<Matrix*>(b));
-        *result = product.release();
-        return CPP_SUCCESS;
-    } catch (const std::invalid_argument& e) {
-        last_error_message = e.what();
-        return CPP_INVALID_OPERATION;
+        return thread_pool()->size();
     } catch (const std::exception& e) {
-        last_error_message = e.what();
-        return CPP_UNKNOWN_ERROR;
+        set_last_error(e);
+        return 1;
     }
 }
 
 const char* get_last_error_message() {
-    return last_error_message.c_str();
+    CPP_INSTRUMENT_FUNCTION();
+    return error_state().message;
+}
+
+CppResultCode get_last_error_code() {
+    CPP_INSTRUMENT_FUNCTION();
+    return error_state().code;
+}
+
+void clear_last_error() {
+    CPP_INSTRUMENT_FUNCTION();
+    ErrorState& state = error_state();
+    state.code = CPP_SUCCESS;
+    state.message[0] = '\0';
+}
+
+// Instrumentation (compiled in with make INSTRUMENT=1)
+int cpp_stats_enabled() {
+#ifdef CPP_INSTRUMENT
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int cpp_stats_snapshot(CppFunctionStats* entries, int capacity) {
+#ifdef CPP_INSTRUMENT
+    return instrument_registry().snapshot(entries, capacity);
+#else
+    (void)entries;
+    (void)capacity;
+    return 0;
+#endif
+}
+
+void cpp_stats_reset() {
+#ifdef CPP_INSTRUMENT
+    instrument_registry().reset();
+#endif
 }
 
 } // extern "C"
\ No newline at end of file
@@ -10,7 +10,26 @@
 extern "C" {
 #endif
 
+// Result codes returned by the status-reporting entry points
+typedef enum {
+    CPP_SUCCESS = 0,
+    CPP_NULL_POINTER = -1,
+    CPP_OUT_OF_BOUNDS = -2,
+    CPP_INVALID_OPERATION = -3,
+    CPP_MEMORY_ERROR = -4,
+    CPP_UNKNOWN_ERROR = -5,
+    CPP_IO_ERROR = -6,
+    CPP_CANCELLED = -7,
+    CPP_PENDING = 1
+} CppResultCode;
+
 // C++ class-based operations (exposed as C functions for P/Invoke)
+//
+// Vector, String, Matrix (all element types), SparseMatrix, SmartResource,
+// Function and Iterator handles are slot/generation pairs in a handle table, not pointers.
+// Passing a destroyed or wrongly typed handle is detected: the call acts as if
+// the handle were null and records "Stale or invalid handle" as the last error,
+// and destroying a handle twice is a no-op.
 
 // Vector operations using C++ std::vector
 typedef void* VectorHandle;
@@ -24,6 +43,33 @@ void vector_clear(VectorHandle handle);
 int vector_sum(VectorHandle handle);
 void vector_sort(VectorHandle handle);
 
+// Exact 64-bit sum; vector_sum wraps on int overflow. Both run in parallel on
+// large vectors and return the same result for any thread count.
+long long vector_sum_i64(VectorHandle handle);
+
+// Bulk vector transfer. vector_data exposes the storage directly; the pointer
+// is invalidated by any call that adds, clears, reserves or destroys.
+CppResultCode vector_reserve(VectorHandle handle, int capacity);
+CppResultCode vector_add_range(VectorHandle handle, const int* values, int count);
+CppResultCode vector_copy_to(VectorHandle handle, int* buffer, int count);
+const int* vector_data(VectorHandle handle);
+
+// Optional lookup indexes. The hash index answers vector_contains in O(1); the
+// sorted (Eytzinger-order) index answers all three lookups in O(log n). Any call
+// that changes the contents drops both; vector_sort keeps them. Without an
+// index the lookups fall back to a linear scan. vector_lower_bound is the
+// number of elements less than value; vector_count_range counts low..high inclusive.
+typedef enum {
+    CPP_VECTOR_INDEX_HASH = 1,
+    CPP_VECTOR_INDEX_SORTED = 2
+} CppVectorIndex;
+
+CppResultCode vector_build_index(VectorHandle handle, int kinds);
+int vector_index_kinds(VectorHandle handle);
+int vector_contains(VectorHandle handle, int value);
+int vector_lower_bound(VectorHandle handle, int value);
+int vector_count_range(VectorHandle handle, int low, int high);
+
 // String operations using C++ std::string
 typedef void* StringHandle;
 
@@ -37,12 +83,74 @@ void string_reverse(StringHandle handle);
 void string_to_upper(StringHandle handle);
 void string_to_lower(StringHandle handle);
 
+// Length-delimited UTF-8 (or any byte) transfer with no NUL scanning; the text
+// may contain embedded NULs. string_view exposes the storage directly; the pointer
+// is invalidated by any call that modifies or destroys the string.
+StringHandle string_create_utf8(const char* text, int length);
+CppResultCode string_append_utf8(StringHandle handle, const char* text, int length);
+CppResultCode string_prepend_utf8(StringHandle handle, const char* text, int length);
+CppResultCode string_view(StringHandle handle, const char** data, int* length);
+
+// Rope-backed strings for large documents built by many edits. Append, prepend
+// and insert take expected O(log n) and never copy existing text. string_get_cstr,
+// string_view and the whole-string transforms flatten the rope into one chunk first.
+// The chunk API reads the text in order without flattening; chunk pointers are
+// invalidated by any call that modifies, flattens or destroys the string.
+// Flat strings accept the same calls and report a single chunk.
+StringHandle string_create_rope(const char* text, int length);
+CppResultCode string_insert_utf8(StringHandle handle, int offset, const char* text, int length);
+int string_chunk_count(StringHandle handle);
+CppResultCode string_chunk_at(StringHandle handle, int index, const char** data, int* length);
+
+// Batch transforms over strings packed into one UTF-8 buffer: string i is
+// bytes[offsets[i] .. offsets[i + 1]), so offsets holds count + 1 entries.
+// Transforms run in place (none changes a string's byte length). Case folding
+// covers ASCII and Latin-1 letters; reverse works on code points.
+typedef enum {
+    CPP_STRING_TO_UPPER = 0,
+    CPP_STRING_TO_LOWER = 1,
+    CPP_STRING_REVERSE = 2
+} CppStringTransform;
+
+CppResultCode string_transform_batch(char* bytes, int byte_count, const int* offsets, int count,
+                                     CppStringTransform transform);
+
 // Advanced mathematical operations using templates (instantiated for specific types)
 double calculate_mean_double(const double* values, int count);
 float calculate_mean_float(const float* values, int count);
 double calculate_variance(const double* values, int count);
 double calculate_standard_deviation(const double* values, int count);
 
+// Single-pass summary of an array (population variance, as calculate_variance)
+typedef struct {
+    long long count;
+    double sum;
+    double mean;
+    double variance;
+    double standard_deviation;
+    double min;
+    double max;
+} StatsResult;
+
+CppResultCode calculate_statistics(const double* values, int count, StatsResult* result);
+
+// Arrays saved in the matrix file format (a count x 1 float64 matrix) can be
+// summarized straight from a read-only mapping, without loading them first
+CppResultCode array_save(const double* values, int count, const char* path);
+CppResultCode calculate_statistics_mmap(const char* path, StatsResult* result);
+
+// Streaming statistics over data that arrives in chunks. Memory stays O(1);
+// stats_merge folds source into target, so per-thread accumulators can be
+// combined. An accumulator must not be used from two threads at once.
+typedef void* StatsAccumulatorHandle;
+
+StatsAccumulatorHandle stats_create();
+void stats_destroy(StatsAccumulatorHandle handle);
+CppResultCode stats_push_batch(StatsAccumulatorHandle handle, const double* values, int count);
+CppResultCode stats_merge(StatsAccumulatorHandle target, StatsAccumulatorHandle source);
+CppResultCode stats_snapshot(StatsAccumulatorHandle handle, StatsResult* result);
+void stats_reset(StatsAccumulatorHandle handle);
+
 // Matrix operations using C++ classes
 typedef void* MatrixHandle;
 
@@ -56,6 +164,143 @@ MatrixHandle matrix_multiply(MatrixHandle a, MatrixHandle b);
 MatrixHandle matrix_transpose(MatrixHandle handle);
 void matrix_print(MatrixHandle handle);
 
+// Allocation-free variants writing into an existing matrix of the right shape.
+// matrix_gemm computes c = alpha * a * b + beta * c (beta == 0 ignores c's contents);
+// matrix_multiply_into is matrix_gemm with alpha = 1, beta = 0. The in-place
+// transpose only accepts square matrices.
+CppResultCode matrix_multiply_into(MatrixHandle a, MatrixHandle b, MatrixHandle out);
+CppResultCode matrix_gemm(double alpha, MatrixHandle a, MatrixHandle b, double beta, MatrixHandle c);
+CppResultCode matrix_transpose_into(MatrixHandle handle, MatrixHandle out);
+CppResultCode matrix_transpose_in_place(MatrixHandle handle);
+
+// Binary matrix files: a 64-byte header (rows, cols, element type) followed by
+// cache-line aligned row-major data. matrix_open_mmap maps the file instead of
+// reading it, so opening is O(1) and pages load on first touch. With readonly
+// set, writes to the matrix stay private to the process; otherwise they are
+// written back to the file. matrix_save replaces the file atomically.
+MatrixHandle matrix_open_mmap(const char* path, int readonly);
+CppResultCode matrix_save(MatrixHandle handle, const char* path);
+
+// Opt-in result cache for matrix_multiply, safe_matrix_multiply and
+// matrix_transpose (every element type). Results are keyed on the operands'
+// contents: each write through the API (set, bulk copies, gemm, transposes into
+// or in place) gives a matrix new content, so a stale result is never returned.
+// A hit returns a new handle that shares the cached storage and copies it on
+// its first write. Matrices whose storage escapes the library (matrix_data_ptr,
+// mapped files, resource-backed matrices) are computed as usual and never
+// cached. The budget is the bytes of results kept, evicted least recently used
+// first; it starts at 0, which disables the cache, and setting 0 again empties
+// it. Instrumented builds also count matrix_cache_hit and matrix_cache_miss
+// entries in cpp_stats_snapshot.
+typedef struct {
+    long long hits;
+    long long misses;
+    long long evictions;
+    long long entries;
+    long long bytes;
+    long long budget;
+} CppMatrixCacheStats;
+
+CppResultCode matrix_cache_set_budget(long long bytes);
+void matrix_cache_clear();
+CppResultCode matrix_cache_stats(CppMatrixCacheStats* stats);
+
+// Single-precision and int32 matrices with the same semantics as the double API above.
+// Each element type runs its own compiled kernels; int32 arithmetic wraps modulo 2^32.
+typedef void* MatrixF32Handle;
+
+MatrixF32Handle matrix_f32_create(int rows, int cols);
+MatrixF32Handle matrix_f32_create_from_buffer(const float* data, int rows, int cols);
+void matrix_f32_destroy(MatrixF32Handle handle);
+void matrix_f32_set(MatrixF32Handle handle, int row, int col, float value);
+float matrix_f32_get(MatrixF32Handle handle, int row, int col);
+int matrix_f32_rows(MatrixF32Handle handle);
+int matrix_f32_cols(MatrixF32Handle handle);
+CppResultCode matrix_f32_copy_from_buffer(MatrixF32Handle handle, const float* data, int count);
+CppResultCode matrix_f32_copy_to_buffer(MatrixF32Handle handle, float* buffer, int count);
+float* matrix_f32_data_ptr(MatrixF32Handle handle);
+MatrixF32Handle matrix_f32_multiply(MatrixF32Handle a, MatrixF32Handle b);
+MatrixF32Handle matrix_f32_transpose(MatrixF32Handle handle);
+CppResultCode matrix_f32_multiply_into(MatrixF32Handle a, MatrixF32Handle b, MatrixF32Handle out);
+CppResultCode matrix_f32_gemm(float alpha, MatrixF32Handle a, MatrixF32Handle b, float beta, MatrixF32Handle c);
+CppResultCode matrix_f32_transpose_into(MatrixF32Handle handle, MatrixF32Handle out);
+CppResultCode matrix_f32_transpose_in_place(MatrixF32Handle handle);
+MatrixF32Handle matrix_f32_open_mmap(const char* path, int readonly);
+CppResultCode matrix_f32_save(MatrixF32Handle handle, const char* path);
+
+typedef void* MatrixI32Handle;
+
+MatrixI32Handle matrix_i32_create(int rows, int cols);
+MatrixI32Handle matrix_i32_create_from_buffer(const int* data, int rows, int cols);
+void matrix_i32_destroy(MatrixI32Handle handle);
+void matrix_i32_set(MatrixI32Handle handle, int row, int col, int value);
+int matrix_i32_get(MatrixI32Handle handle, int row, int col);
+int matrix_i32_rows(MatrixI32Handle handle);
+int matrix_i32_cols(MatrixI32Handle handle);
+CppResultCode matrix_i32_copy_from_buffer(MatrixI32Handle handle, const int* data, int count);
+CppResultCode matrix_i32_copy_to_buffer(MatrixI32Handle handle, int* buffer, int count);
+int* matrix_i32_data_ptr(MatrixI32Handle handle);
+MatrixI32Handle matrix_i32_multiply(MatrixI32Handle a, MatrixI32Handle b);
+MatrixI32Handle matrix_i32_transpose(MatrixI32Handle handle);
+CppResultCode matrix_i32_multiply_into(MatrixI32Handle a, MatrixI32Handle b, MatrixI32Handle out);
+CppResultCode matrix_i32_gemm(int alpha, MatrixI32Handle a, MatrixI32Handle b, int beta, MatrixI32Handle c);
+CppResultCode matrix_i32_transpose_into(MatrixI32Handle handle, MatrixI32Handle out);
+CppResultCode matrix_i32_transpose_in_place(MatrixI32Handle handle);
+MatrixI32Handle matrix_i32_open_mmap(const char* path, int readonly);
+CppResultCode matrix_i32_save(MatrixI32Handle handle, const char* path);
+
+// Lazy matrix expressions. Build a tree from leaves, transposes, products and
+// sums, then evaluate it once; transposes are fused into the multiply and
+// product chains are reordered to minimize work. A leaf holds its matrix handle
+// and reads the current contents at each evaluation; once a leaf matrix is
+// destroyed, evaluating fails with CPP_INVALID_OPERATION ("Stale or invalid
+// handle") and leaves the output untouched. Each expression handle is destroyed
+// separately; sub-expressions stay valid while any expression uses them.
+typedef void* MatrixExprHandle;
+
+MatrixExprHandle matrix_expr_leaf(MatrixHandle matrix);
+MatrixExprHandle matrix_expr_transpose(MatrixExprHandle expr);
+MatrixExprHandle matrix_expr_mul(MatrixExprHandle a, MatrixExprHandle b);
+MatrixExprHandle matrix_expr_add(MatrixExprHandle a, MatrixExprHandle b);
+int matrix_expr_rows(MatrixExprHandle expr);
+int matrix_expr_cols(MatrixExprHandle expr);
+MatrixHandle matrix_expr_eval(MatrixExprHandle expr);
+CppResultCode matrix_expr_eval_into(MatrixExprHandle expr, MatrixHandle out);
+void matrix_expr_destroy(MatrixExprHandle expr);
+
+// Bulk matrix transfer: elements are row-major, rows * cols doubles.
+// matrix_data_ptr exposes the storage directly and stays valid until the matrix is
+// destroyed; the matrix then no longer takes part in the result cache.
+MatrixHandle matrix_create_from_buffer(const double* data, int rows, int cols);
+CppResultCode matrix_copy_from_buffer(MatrixHandle handle, const double* data, int count);
+CppResultCode matrix_copy_to_buffer(MatrixHandle handle, double* buffer, int count);
+double* matrix_data_ptr(MatrixHandle handle);
+
+// Sparse matrices in compressed sparse row (CSR) form, for matrices that are
+// mostly zeros: storage and multiply work scale with the nonzero count. The
+// bulk builder takes count (row, col, value) triplets in any order and sums
+// duplicates; sparse_matrix_from_dense keeps the nonzero elements. Multiplies
+// return new matrices: sparse x dense is dense, sparse x sparse stays sparse.
+// sparse_matrix_spmv computes y = A x (x holds cols, y rows elements; they may
+// overlap). Large SpMV and products run on the thread pool, split by nonzeros.
+// sparse_matrix_to_coo writes the first capacity entries in row-major order and
+// returns the nonzero count; pass capacity 0 to size the buffers.
+typedef void* SparseMatrixHandle;
+
+SparseMatrixHandle sparse_matrix_from_coo(int rows, int cols, const int* row_indices, const int* col_indices,
+                                          const double* values, int count);
+SparseMatrixHandle sparse_matrix_from_dense(MatrixHandle dense);
+MatrixHandle sparse_matrix_to_dense(SparseMatrixHandle handle);
+void sparse_matrix_destroy(SparseMatrixHandle handle);
+int sparse_matrix_rows(SparseMatrixHandle handle);
+int sparse_matrix_cols(SparseMatrixHandle handle);
+int sparse_matrix_nnz(SparseMatrixHandle handle);
+double sparse_matrix_get(SparseMatrixHandle handle, int row, int col);
+int sparse_matrix_to_coo(SparseMatrixHandle handle, int* row_indices, int* col_indices, double* values, int capacity);
+CppResultCode sparse_matrix_spmv(SparseMatrixHandle handle, const double* x, int x_count, double* y, int y_count);
+MatrixHandle sparse_matrix_multiply_dense(SparseMatrixHandle a, MatrixHandle b);
+SparseMatrixHandle sparse_matrix_multiply(SparseMatrixHandle a, SparseMatrixHandle b);
+
 // Smart pointer operations (demonstrating RAII)
 typedef void* SmartResourceHandle;
 
@@ -63,6 +308,30 @@ SmartResourceHandle smart_resource_create(int size);
 void smart_resource_use(SmartResourceHandle handle, int index, double value);
 double smart_resource_get(SmartResourceHandle handle, int index);
 int smart_resource_size(SmartResourceHandle handle);
+void smart_resource_destroy(SmartResourceHandle handle);
+
+// Bulk access to a resource used as a large native buffer. Storage is 64-byte
+// aligned; buffers of 1 MiB or more are mapped lazily, so pages are zeroed by
+// the kernel on first touch. CPP_RESOURCE_HUGE_PAGES uses MAP_HUGETLB pages when
+// reserved ones exist (smart_resource_huge_pages reports 1) and otherwise asks for
+// transparent huge pages. Ranges are [offset, offset + count) and large ones run on the thread pool.
+// smart_resource_data_ptr stays valid until the resource is destroyed.
+typedef enum {
+    CPP_RESOURCE_DEFAULT = 0,
+    CPP_RESOURCE_HUGE_PAGES = 1
+} CppResourceFlags;
+
+SmartResourceHandle smart_resource_create_ex(int size, int flags);
+double* smart_resource_data_ptr(SmartResourceHandle handle);
+int smart_resource_huge_pages(SmartResourceHandle handle);
+CppResultCode smart_resource_fill(SmartResourceHandle handle, int offset, int count, double value);
+CppResultCode smart_resource_copy_in(SmartResourceHandle handle, int offset, const double* values, int count);
+CppResultCode smart_resource_copy_out(SmartResourceHandle handle, int offset, double* buffer, int count);
+// Zero-copy kernel inputs: statistics over a resource range, and a row-major
+// matrix over rows * cols elements starting at offset. The matrix shares the
+// storage and keeps it alive after smart_resource_destroy.
+CppResultCode smart_resource_statistics(SmartResourceHandle handle, int offset, int count, StatsResult* result);
+MatrixHandle matrix_create_over_resource(SmartResourceHandle handle, int offset, int rows, int cols);
 
 // Function pointer operations with C++ lambdas and std::function
 typedef double (*MathOperation)(double, double);
@@ -73,6 +342,30 @@ FunctionHandle function_create_multiply();
 FunctionHandle function_create_power();
 void function_destroy(FunctionHandle handle);
 double function_call(FunctionHandle handle, double a, double b);
+// out[i] = f(a[i], b[i]) for i < count in one call; out may be a or b
+CppResultCode function_call_batch(FunctionHandle handle, const double* a, const double* b, double* out, int count);
+
+// Pipelines. A function reads numbered inputs; the built-ins above read inputs 0
+// and 1, function_input(i) returns input i and function_constant(v) returns v.
+// function_compose(outer, left, right) feeds left into outer's input 0 and right
+// into its input 1 (higher inputs pass through), so pow(x0 * x1 + x2, 2) is
+//   compose(power, compose(add, multiply, input(2)), constant(2)).
+// The result does not depend on the handles it was built from, and each
+// pipeline is compiled once into a fused block kernel, cached by shape.
+FunctionHandle function_input(int index);
+FunctionHandle function_constant(double value);
+FunctionHandle function_compose(FunctionHandle outer, FunctionHandle left, FunctionHandle right);
+// Number of inputs the function reads: one past its highest input index
+int function_arity(FunctionHandle handle);
+// out[i] = f(inputs[0][i], ..., inputs[input_count - 1][i]) for i < count in one
+// pass with no intermediate arrays; input_count must cover the arity and out may
+// be one of the inputs. function_call and function_call_batch also accept
+// pipelines that read at most two inputs.
+CppResultCode function_evaluate(FunctionHandle handle, const double* const* inputs, int input_count,
+                                double* out, int count);
+// Compiled-kernel cache counters since load: lookups that reused a kernel,
+// lookups that compiled one, and kernels currently cached
+void function_cache_stats(long long* hits, long long* misses, int* entries);
 
 // Iterator-style operations
 typedef void* IteratorHandle;
@@ -84,19 +377,88 @@ int iterator_next(IteratorHandle handle);
 void iterator_reset(IteratorHandle handle);
 int iterator_find(IteratorHandle handle, int value);
 
-// Exception handling demonstrations
-typedef enum {
-    CPP_SUCCESS = 0,
-    CPP_NULL_POINTER = -1,
-    CPP_OUT_OF_BOUNDS = -2,
-    CPP_INVALID_OPERATION = -3,
-    CPP_MEMORY_ERROR = -4,
-    CPP_UNKNOWN_ERROR = -5
-} CppResultCode;
+// iterator_create copies the array; a borrowed iterator reads it in place, so the
+// buffer must stay alive and unchanged until iterator_destroy.
+IteratorHandle iterator_create_borrowed(const int* array, int size);
+// Copies up to max elements from the current position into out and returns how
+// many were copied (0 once the iterator is exhausted)
+int iterator_next_batch(IteratorHandle handle, int* out, int max);
+// Writes the index of every element equal to value (up to capacity positions)
+// and returns the total number of matches; pass capacity 0 to count them
+int iterator_find_all(IteratorHandle handle, int value, int* positions, int capacity);
+
+// Arena allocation for short-lived objects. The *_in variants bump-allocate the
+// object (and matrix storage) from the arena. Those objects are destroyed together by
+// cpp_arena_reset or cpp_arena_destroy and must not be passed to the *_destroy functions.
+// An arena must not be used from several threads at once. block_size <= 0 selects 64 KiB.
+typedef void* ArenaHandle;
+
+ArenaHandle cpp_arena_create(int block_size);
+void cpp_arena_reset(ArenaHandle arena);
+void cpp_arena_destroy(ArenaHandle arena);
+long long cpp_arena_bytes_used(ArenaHandle arena);
+MatrixHandle matrix_create_in(ArenaHandle arena, int rows, int cols);
+MatrixHandle matrix_multiply_in(ArenaHandle arena, MatrixHandle a, MatrixHandle b);
+MatrixHandle matrix_transpose_in(ArenaHandle arena, MatrixHandle handle);
+VectorHandle vector_create_in(ArenaHandle arena);
+StringHandle string_create_in(ArenaHandle arena, const char* initial_value);
+
+// Asynchronous matrix operations. Jobs run one at a time on a native runner
+// thread (each using the whole thread pool) and never block the caller.
+// The callback runs exactly once on the runner thread when the job completes,
+// fails or is cancelled; it may call job_result, but must not block on other jobs.
+// The job shares ownership of the operands' storage (arena matrices are copied),
+// so they may be destroyed as soon as matrix_multiply_async returns; writing an
+// operand before the job finishes races with it. job_poll and job_wait return
+// CPP_PENDING while the job is running, then its final status. job_result
+// transfers ownership of the product to the caller (once). job_cancel stops a
+// queued job from starting; a running multiply completes but its result is
+// discarded.
+typedef void* JobHandle;
+typedef void (*JobCallback)(JobHandle job, CppResultCode status, void* user_state);
 
+JobHandle matrix_multiply_async(MatrixHandle a, MatrixHandle b, JobCallback callback, void* user_state);
+CppResultCode job_poll(JobHandle job);
+CppResultCode job_wait(JobHandle job, int timeout_ms);
+CppResultCode job_cancel(JobHandle job);
+MatrixHandle job_result(JobHandle job);
+void job_destroy(JobHandle job);
+
+// Thread pool used by the parallel kernels (matrix_multiply, ...).
+// The count includes the calling thread; values <= 0 restore the hardware default.
+void cpp_set_num_threads(int num_threads);
+int cpp_get_num_threads();
+
+// Opt-in instrumentation. A library built with `make INSTRUMENT=1` records, for
+// every exported function, call count, cumulative time, bytes of aligned storage
+// (matrices, arenas, scratch buffers) allocated while it was innermost, and a log2 latency
+// histogram. Otherwise recording compiles away, cpp_stats_enabled returns 0 and
+// snapshots are empty. cpp_stats_snapshot writes up to capacity entries for the
+// functions called since the last reset and returns how many there are; names
+// are static strings. Counting is per thread and lock-free.
+#define CPP_STATS_HISTOGRAM_BUCKETS 32
+
+typedef struct {
+    const char* name;
+    long long calls;
+    long long total_ns;
+    long long bytes_allocated;
+    long long histogram[CPP_STATS_HISTOGRAM_BUCKETS];  // bucket i: calls taking [2^i, 2^(i+1)) ns
+} CppFunctionStats;
+
+int cpp_stats_enabled();
+int cpp_stats_snapshot(CppFunctionStats* entries, int capacity);
+void cpp_stats_reset();
+
+// Exception handling demonstrations
 CppResultCode safe_vector_get(VectorHandle handle, int index, int* result);
 CppResultCode safe_matrix_multiply(MatrixHandle a, MatrixHandle b, MatrixHandle* result);
+
+// Error state is per thread: these report the last error raised on the calling thread.
+// Successful calls leave it untouched; clear_last_error resets it.
 const char* get_last_error_message();
+CppResultCode get_last_error_code();
+void clear_last_error();
 
 #ifdef __cplusplus
 }
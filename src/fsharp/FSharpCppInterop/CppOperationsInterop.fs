@@ -4,7 +4,13 @@ open System
 open System.Runtime.InteropServices
 open System.Text
 open System.Buffers
+open System.Threading
+open System.Threading.Tasks
 open Microsoft.Win32.SafeHandles
+open Microsoft.FSharp.NativeInterop
+
+// Span and Memory views over native buffers require pointer conversions
+#nowarn "9"
 
 // Library wrapper class for better naming practices
 type LibCppOperations = class end
@@ -16,6 +22,18 @@ let CppLibraryName = "libcpp_operations.so"
 // Note: Using DllImport instead of LibraryImport due to F# runtime limitations
 // with source generation and requirement for CallingConvention.Cdecl support.
 
+// Result codes returned by status-reporting native functions
+type CppResultCode =
+    | Success = 0
+    | NullPointer = -1
+    | OutOfBounds = -2
+    | InvalidOperation = -3
+    | MemoryError = -4
+    | UnknownError = -5
+    | IoError = -6
+    | Cancelled = -7
+    | Pending = 1
+
 // Vector operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr vector_create()
@@ -38,9 +56,47 @@ extern void vector_clear(IntPtr handle)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern int vector_sum(IntPtr handle)
 
+// Exact 64-bit sum; vector_sum wraps on int overflow
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int64 vector_sum_i64(IntPtr handle)
+
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern void vector_sort(IntPtr handle)
 
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode vector_reserve(IntPtr handle, int capacity)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode vector_add_range(IntPtr handle, int* values, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode vector_copy_to(IntPtr handle, int* buffer, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr vector_data(IntPtr handle)
+
+// Mirrors CppVectorIndex; indexes are dropped whenever the vector's contents change
+[<Flags>]
+type CppVectorIndex =
+    | None = 0
+    | Hash = 1
+    | Sorted = 2
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode vector_build_index(IntPtr handle, CppVectorIndex kinds)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppVectorIndex vector_index_kinds(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int vector_contains(IntPtr handle, int value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int vector_lower_bound(IntPtr handle, int value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int vector_count_range(IntPtr handle, int low, int high)
+
 // String operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
 extern IntPtr string_create(string initial_value)
@@ -69,6 +125,41 @@ extern void string_to_upper(IntPtr handle)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern void string_to_lower(IntPtr handle)
 
+// Length-delimited UTF-8 transfer: pinned bytes in, pointer/length view out
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr string_create_utf8(byte* text, int length)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_append_utf8(IntPtr handle, byte* text, int length)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_prepend_utf8(IntPtr handle, byte* text, int length)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_view(IntPtr handle, IntPtr& data, int& length)
+
+// Rope-backed strings and chunk-wise reads
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr string_create_rope(byte* text, int length)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_insert_utf8(IntPtr handle, int offset, byte* text, int length)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int string_chunk_count(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_chunk_at(IntPtr handle, int index, IntPtr& data, int& length)
+
+// Mirrors CppStringTransform
+type CppStringTransform =
+    | ToUpper = 0
+    | ToLower = 1
+    | Reverse = 2
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode string_transform_batch(byte* bytes, int byte_count, int* offsets, int count, CppStringTransform transform)
+
 // Mathematical operations with proper array marshaling
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern double calculate_mean_double([<In>] double[] values, int count)
@@ -82,6 +173,48 @@ extern double calculate_variance([<In>] double[] values, int count)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern double calculate_standard_deviation([<In>] double[] values, int count)
 
+// Single-pass summary returned by calculate_statistics (population variance)
+[<Struct>]
+[<StructLayout(LayoutKind.Sequential)>]
+type StatsResult = {
+    count: int64
+    sum: double
+    mean: double
+    variance: double
+    standard_deviation: double
+    min: double
+    max: double
+}
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode calculate_statistics([<In>] double[] values, int count, StatsResult& result)
+
+// Arrays in the matrix file format, summarized from a read-only mapping
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern CppResultCode array_save([<In>] double[] values, int count, string path)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern CppResultCode calculate_statistics_mmap(string path, StatsResult& result)
+
+// Streaming statistics accumulator (one per thread; combine with stats_merge)
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr stats_create()
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void stats_destroy(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode stats_push_batch(IntPtr handle, double* values, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode stats_merge(IntPtr target, IntPtr source)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode stats_snapshot(IntPtr handle, StatsResult& result)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void stats_reset(IntPtr handle)
+
 // Matrix operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr matrix_create(int rows, int cols)
@@ -107,9 +240,237 @@ extern IntPtr matrix_multiply(IntPtr a, IntPtr b)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr matrix_transpose(IntPtr handle)
 
+// Opt-in result cache for matrix_multiply / matrix_transpose, keyed on operand contents
+[<Struct>]
+[<StructLayout(LayoutKind.Sequential)>]
+type CppMatrixCacheStats = {
+    hits: int64
+    misses: int64
+    evictions: int64
+    entries: int64
+    bytes: int64
+    budget: int64
+}
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_cache_set_budget(int64 bytes)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_cache_clear()
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_cache_stats(CppMatrixCacheStats& stats)
+
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern void matrix_print(IntPtr handle)
 
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_multiply_into(IntPtr a, IntPtr b, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_gemm(double alpha, IntPtr a, IntPtr b, double beta, IntPtr c)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_transpose_into(IntPtr handle, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_transpose_in_place(IntPtr handle)
+
+// Binary matrix files; open_mmap maps the file instead of reading it
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern IntPtr matrix_open_mmap(string path, int readonly)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern CppResultCode matrix_save(IntPtr handle, string path)
+
+// Lazy matrix expressions
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_expr_leaf(IntPtr matrix)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_expr_transpose(IntPtr expr)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_expr_mul(IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_expr_add(IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_expr_rows(IntPtr expr)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_expr_cols(IntPtr expr)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_expr_eval(IntPtr expr)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_expr_eval_into(IntPtr expr, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_expr_destroy(IntPtr expr)
+
+// Bulk matrix transfer (row-major): one memcpy instead of one P/Invoke per element
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_create_from_buffer(double* data, int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_copy_from_buffer(IntPtr handle, double* data, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_copy_to_buffer(IntPtr handle, double* buffer, int count)
+
+// Zero-copy access to the matrix storage; valid until the matrix is destroyed
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_data_ptr(IntPtr handle)
+
+// Sparse (CSR) matrices; storage and multiply work scale with the nonzero count
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr sparse_matrix_from_coo(int rows, int cols, int* rowIndices, int* colIndices, double* values, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr sparse_matrix_from_dense(IntPtr dense)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr sparse_matrix_to_dense(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void sparse_matrix_destroy(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int sparse_matrix_rows(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int sparse_matrix_cols(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int sparse_matrix_nnz(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern double sparse_matrix_get(IntPtr handle, int row, int col)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int sparse_matrix_to_coo(IntPtr handle, int* rowIndices, int* colIndices, double* values, int capacity)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode sparse_matrix_spmv(IntPtr handle, double* x, int xCount, double* y, int yCount)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr sparse_matrix_multiply_dense(IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr sparse_matrix_multiply(IntPtr a, IntPtr b)
+
+// Single-precision and int32 matrices; int32 products wrap on overflow
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_f32_create(int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_f32_create_from_buffer(float32* data, int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_f32_destroy(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_f32_set(IntPtr handle, int row, int col, float32 value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern float32 matrix_f32_get(IntPtr handle, int row, int col)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_f32_rows(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_f32_cols(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_copy_from_buffer(IntPtr handle, float32* data, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_copy_to_buffer(IntPtr handle, float32* buffer, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_f32_data_ptr(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_f32_multiply(IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_f32_transpose(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_multiply_into(IntPtr a, IntPtr b, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_gemm(float32 alpha, IntPtr a, IntPtr b, float32 beta, IntPtr c)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_transpose_into(IntPtr handle, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_f32_transpose_in_place(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern IntPtr matrix_f32_open_mmap(string path, int readonly)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern CppResultCode matrix_f32_save(IntPtr handle, string path)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_i32_create(int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_i32_create_from_buffer(int* data, int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_i32_destroy(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void matrix_i32_set(IntPtr handle, int row, int col, int value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_i32_get(IntPtr handle, int row, int col)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_i32_rows(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int matrix_i32_cols(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_copy_from_buffer(IntPtr handle, int* data, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_copy_to_buffer(IntPtr handle, int* buffer, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_i32_data_ptr(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_i32_multiply(IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_i32_transpose(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_multiply_into(IntPtr a, IntPtr b, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_gemm(int alpha, IntPtr a, IntPtr b, int beta, IntPtr c)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_transpose_into(IntPtr handle, IntPtr out)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode matrix_i32_transpose_in_place(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern IntPtr matrix_i32_open_mmap(string path, int readonly)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern CppResultCode matrix_i32_save(IntPtr handle, string path)
+
 // Smart resource operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr smart_resource_create(int size)
@@ -123,6 +484,39 @@ extern double smart_resource_get(IntPtr handle, int index)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern int smart_resource_size(IntPtr handle)
 
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void smart_resource_destroy(IntPtr handle)
+
+// Mirrors CppResourceFlags
+[<Flags>]
+type CppResourceFlags =
+    | Default = 0
+    | HugePages = 1
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr smart_resource_create_ex(int size, CppResourceFlags flags)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern nativeint smart_resource_data_ptr(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int smart_resource_huge_pages(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode smart_resource_fill(IntPtr handle, int offset, int count, double value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode smart_resource_copy_in(IntPtr handle, int offset, double* values, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode smart_resource_copy_out(IntPtr handle, int offset, double* buffer, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode smart_resource_statistics(IntPtr handle, int offset, int count, StatsResult& result)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_create_over_resource(IntPtr handle, int offset, int rows, int cols)
+
 // Function operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr function_create_add()
@@ -139,6 +533,27 @@ extern void function_destroy(IntPtr handle)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern double function_call(IntPtr handle, double a, double b)
 
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode function_call_batch(IntPtr handle, double* a, double* b, double* out, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr function_input(int index)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr function_constant(double value)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr function_compose(IntPtr outer, IntPtr left, IntPtr right)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int function_arity(IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode function_evaluate(IntPtr handle, nativeint* inputs, int inputCount, double* out, int count)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void function_cache_stats(int64& hits, int64& misses, int& entries)
+
 // Iterator operations
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr iterator_create([<In>] int[] array, int size)
@@ -158,26 +573,125 @@ extern void iterator_reset(IntPtr handle)
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern int iterator_find(IntPtr handle, int value)
 
-// Error handling
-type CppResultCode =
-    | Success = 0
-    | NullPointer = -1
-    | OutOfBounds = -2
-    | InvalidOperation = -3
-    | MemoryError = -4
-    | UnknownError = -5
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr iterator_create_borrowed(int* array, int size)
 
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
-extern CppResultCode safe_vector_get(IntPtr handle, int index, int& result)
+extern int iterator_next_batch(IntPtr handle, int* out, int max)
 
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
-extern CppResultCode safe_matrix_multiply(IntPtr a, IntPtr b, IntPtr& result)
+extern int iterator_find_all(IntPtr handle, int value, int* positions, int capacity)
 
+// Arena operations; objects created with the *_in functions are released by reset/destroy
 [<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
-extern IntPtr get_last_error_message()
+extern IntPtr cpp_arena_create(int block_size)
 
-// SafeHandle implementations for better resource management
-type SafeVectorHandle() =
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void cpp_arena_reset(IntPtr arena)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void cpp_arena_destroy(IntPtr arena)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int64 cpp_arena_bytes_used(IntPtr arena)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_create_in(IntPtr arena, int rows, int cols)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_multiply_in(IntPtr arena, IntPtr a, IntPtr b)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_transpose_in(IntPtr arena, IntPtr handle)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr vector_create_in(IntPtr arena)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)>]
+extern IntPtr string_create_in(IntPtr arena, string initial_value)
+
+// Asynchronous matrix jobs; the callback runs once on the native runner thread
+[<UnmanagedFunctionPointer(CallingConvention.Cdecl)>]
+type JobCallbackDelegate = delegate of IntPtr * CppResultCode * IntPtr -> unit
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr matrix_multiply_async(IntPtr a, IntPtr b, JobCallbackDelegate callback, IntPtr userState)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode job_poll(IntPtr job)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode job_wait(IntPtr job, int timeoutMs)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode job_cancel(IntPtr job)
+
+// Transfers ownership of the product to the caller
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr job_result(IntPtr job)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void job_destroy(IntPtr job)
+
+// Thread pool shared by the parallel kernels; the count includes the calling thread
+// and values <= 0 restore the hardware default
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void cpp_set_num_threads(int num_threads)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int cpp_get_num_threads()
+
+// Per-function counters from a library built with make INSTRUMENT=1
+[<Literal>]
+let CppStatsHistogramBuckets = 32
+
+[<Struct>]
+[<StructLayout(LayoutKind.Sequential)>]
+type CppFunctionStats = {
+    name: IntPtr
+    calls: int64
+    total_ns: int64
+    bytes_allocated: int64
+    // histogram.[i] counts calls that took [2^i, 2^(i+1)) ns
+    [<field: MarshalAs(UnmanagedType.ByValArray, SizeConst = CppStatsHistogramBuckets)>]
+    histogram: int64[]
+}
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int cpp_stats_enabled()
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int cpp_stats_snapshot([<Out>] CppFunctionStats[] entries, int capacity)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void cpp_stats_reset()
+
+// Error handling
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode safe_vector_get(IntPtr handle, int index, int& result)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode safe_matrix_multiply(IntPtr a, IntPtr b, IntPtr& result)
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr get_last_error_message()
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern CppResultCode get_last_error_code()
+
+[<DllImport(CppLibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void clear_last_error()
+
+// SafeHandle implementations for better resource management
+// Message of the last error on the calling thread
+let getLastErrorMessage() =
+    let ptr = get_last_error_message()
+    if ptr <> IntPtr.Zero then Marshal.PtrToStringAnsi(ptr) else ""
+
+let internal nativeIoError (what: string) =
+    IO.IOException($"{what}: {getLastErrorMessage()}")
+
+type SafeVectorHandle() =
     inherit SafeHandleZeroOrMinusOneIsInvalid(true)
     
     do 
@@ -201,6 +715,31 @@ type SafeStringCppHandle(initial: string) =
             string_destroy(this.handle)
         true
 
+// SafeHandle for adopting existing string pointers
+type SafeStringCppHandleFromPtr(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            string_destroy(this.handle)
+        true
+
+// Iterator handle; a borrowed iterator also owns the pin on the buffer it reads,
+// released only after the native iterator is gone
+type SafeIteratorHandle(existingPtr: IntPtr, pin: MemoryHandle) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    let mutable pin = pin
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            iterator_destroy(this.handle)
+        pin.Dispose()
+        true
+
 type SafeMatrixHandle(rows: int, cols: int) =
     inherit SafeHandleZeroOrMinusOneIsInvalid(true)
     
@@ -224,6 +763,86 @@ type SafeMatrixHandleFromPtr(existingPtr: IntPtr) =
             matrix_destroy(this.handle)
         true
 
+type SafeMatrixF32Handle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            matrix_f32_destroy(this.handle)
+        true
+
+type SafeMatrixI32Handle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            matrix_i32_destroy(this.handle)
+        true
+
+type SafeSparseMatrixHandle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            sparse_matrix_destroy(this.handle)
+        true
+
+type SafeSmartResourceHandle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            smart_resource_destroy(this.handle)
+        true
+
+type SafeStatsAccumulatorHandle() =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(stats_create())
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            stats_destroy(this.handle)
+        true
+
+type SafeMatrixExprHandle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do base.SetHandle(existingPtr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            matrix_expr_destroy(this.handle)
+        true
+
+type SafeArenaHandle(blockSize: int) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+    
+    do 
+        let ptr = cpp_arena_create(blockSize)
+        base.SetHandle(ptr)
+            
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            cpp_arena_destroy(this.handle)
+        true
+
+// Non-owning handle for objects that live in an arena; the arena frees them
+type SafeArenaObjectHandle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(false)
+    
+    do base.SetHandle(existingPtr)
+    
+    override this.ReleaseHandle() = true
+
 type SafeFunctionHandle private (ptr: IntPtr) =
     inherit SafeHandleZeroOrMinusOneIsInvalid(true)
     
@@ -232,17 +851,37 @@ type SafeFunctionHandle private (ptr: IntPtr) =
     static member CreateAdd() = new SafeFunctionHandle(function_create_add())
     static member CreateMultiply() = new SafeFunctionHandle(function_create_multiply())
     static member CreatePower() = new SafeFunctionHandle(function_create_power())
+    static member Input(index: int) = new SafeFunctionHandle(function_input(index))
+    static member Constant(value: double) = new SafeFunctionHandle(function_constant(value))
+    static member Compose(outer: IntPtr, left: IntPtr, right: IntPtr) = new SafeFunctionHandle(function_compose(outer, left, right))
             
     override this.ReleaseHandle() =
         if not this.IsInvalid then
             function_destroy(this.handle)
         true
 
+// Exposes native memory as Memory<'T> without copying.
+// The owner of the native buffer must outlive any Memory handed out by this manager.
+type NativeMemoryManager<'T when 'T : unmanaged>(pointer: IntPtr, length: int) =
+    inherit MemoryManager<'T>()
+    
+    override _.GetSpan() = Span<'T>(pointer.ToPointer(), length)
+    override _.Pin(elementIndex: int) =
+        let elementPtr = NativePtr.add (NativePtr.ofNativeInt<'T> pointer) elementIndex
+        new MemoryHandle(NativePtr.toVoidPtr elementPtr)
+    override _.Unpin() = ()
+    override _.Dispose(_disposing: bool) = ()
+
 // Safe wrapper types and functions using SafeHandles
-type CppVector() =
-    let safeHandle = new SafeVectorHandle()
+type CppVector private (safeHandle: SafeHandleZeroOrMinusOneIsInvalid) =
+    new() =
+        let handle = new SafeVectorHandle()
+        if handle.IsInvalid then failwith "Failed to create vector"
+        new CppVector(handle :> SafeHandleZeroOrMinusOneIsInvalid)
     
-    do if safeHandle.IsInvalid then failwith "Failed to create vector"
+    // Constructor for vectors owned by a CppArena
+    internal new(arenaHandle: SafeArenaObjectHandle) =
+        new CppVector(arenaHandle :> SafeHandleZeroOrMinusOneIsInvalid)
     
     member _.Handle = 
         if safeHandle.IsInvalid then failwith "Vector has been disposed"
@@ -253,8 +892,52 @@ type CppVector() =
     member this.Size = vector_size(this.Handle)
     member this.Clear() = vector_clear(this.Handle)
     member this.Sum() = vector_sum(this.Handle)
+    member this.SumInt64() = vector_sum_i64(this.Handle)
     member this.Sort() = vector_sort(this.Handle)
     
+    member this.Reserve(capacity: int) =
+        match vector_reserve(this.Handle, capacity) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof capacity) $"Vector reserve failed: {status}"
+    
+    // Append all values in a single native call
+    member this.AddRange(values: ReadOnlySpan<int>) =
+        use ptr = fixed values
+        match vector_add_range(this.Handle, ptr, values.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof values) $"Vector append failed: {status}"
+    
+    member this.AddRange(values: int[]) =
+        this.AddRange(ReadOnlySpan<int>(values))
+    
+    member this.CopyTo(destination: Span<int>) =
+        use ptr = fixed destination
+        match vector_copy_to(this.Handle, ptr, destination.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof destination) $"Vector copy failed: {status}"
+    
+    member this.ToArray() =
+        let values = Array.zeroCreate<int> this.Size
+        this.CopyTo(Span<int>(values))
+        values
+    
+    // Zero-copy view over the native storage; invalidated by Add, AddRange, Reserve, Clear and Dispose
+    member this.AsSpan() =
+        ReadOnlySpan<int>(vector_data(this.Handle).ToPointer(), this.Size)
+    
+    // Builds lookup indexes; without one, Contains, LowerBound and CountRange scan linearly
+    member this.BuildIndex(kinds: CppVectorIndex) =
+        match vector_build_index(this.Handle, kinds) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof kinds) $"Vector index build failed: {status}: {getLastErrorMessage()}"
+    
+    member this.IndexKinds = vector_index_kinds(this.Handle)
+    member this.Contains(value: int) = vector_contains(this.Handle, value) <> 0
+    // Number of elements less than value
+    member this.LowerBound(value: int) = vector_lower_bound(this.Handle, value)
+    // Number of elements in low..high inclusive
+    member this.CountRange(low: int, high: int) = vector_count_range(this.Handle, low, high)
+    
     member this.SafeGet(index: int) =
         let mutable result = 0
         let status = safe_vector_get(this.Handle, index, &result)
@@ -265,21 +948,141 @@ type CppVector() =
     interface IDisposable with
         member _.Dispose() = safeHandle.Dispose()
 
-type CppString(initial: string) =
-    let safeHandle = new SafeStringCppHandle(initial)
+// Forward iterator over an int array, with batched reads and vectorized search
+type CppIterator private (safeHandle: SafeIteratorHandle) =
+    static member private Adopt(handle: IntPtr, pin: MemoryHandle) =
+        let safeHandle = new SafeIteratorHandle(handle, pin)
+        if safeHandle.IsInvalid then
+            safeHandle.Dispose()
+            failwith $"Failed to create iterator: {getLastErrorMessage()}"
+        new CppIterator(safeHandle)
+    
+    // Copies the values into native memory
+    new(values: int[]) =
+        let handle = new SafeIteratorHandle(iterator_create(values, values.Length), Unchecked.defaultof<MemoryHandle>)
+        if handle.IsInvalid then failwith "Failed to create iterator"
+        new CppIterator(handle)
+    
+    // Reads the values in place: the memory stays pinned until Dispose, and must not change meanwhile
+    static member Borrow(values: ReadOnlyMemory<int>) =
+        let pin = values.Pin()
+        CppIterator.Adopt(iterator_create_borrowed(NativePtr.ofVoidPtr<int> pin.Pointer, values.Length), pin)
+    
+    member _.Handle =
+        if safeHandle.IsInvalid || safeHandle.IsClosed then failwith "Iterator has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.HasNext = iterator_has_next(this.Handle) = 1
+    member this.Next() = iterator_next(this.Handle)
+    member this.Reset() = iterator_reset(this.Handle)
+    
+    // Searches from the start and moves the iterator to the first match
+    member this.Find(value: int) = iterator_find(this.Handle, value) = 1
+    
+    // Fills destination from the current position; returns the number of elements read (0 at the end)
+    member this.NextBatch(destination: Span<int>) =
+        use ptr = fixed destination
+        iterator_next_batch(this.Handle, ptr, destination.Length)
+    
+    // Index of every element equal to value: one call to count, one to fill
+    member this.FindAll(value: int) =
+        let count = iterator_find_all(this.Handle, value, NativePtr.nullPtr, 0)
+        let positions = Array.zeroCreate<int> count
+        if count > 0 then
+            use ptr = fixed positions
+            iterator_find_all(this.Handle, value, ptr, count) |> ignore
+        positions
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+type CppString private (safeHandle: SafeHandleZeroOrMinusOneIsInvalid) =
+    new(initial: string) =
+        let handle = new SafeStringCppHandle(initial)
+        if handle.IsInvalid then failwith "Failed to create string"
+        new CppString(handle :> SafeHandleZeroOrMinusOneIsInvalid)
     
-    do if safeHandle.IsInvalid then failwith "Failed to create string"
+    // Constructor for strings owned by a CppArena
+    internal new(arenaHandle: SafeArenaObjectHandle) =
+        new CppString(arenaHandle :> SafeHandleZeroOrMinusOneIsInvalid)
     
     member _.Handle = 
         if safeHandle.IsInvalid then failwith "String has been disposed"
         safeHandle.DangerousGetHandle()
     
-    member this.Value =
-        let ptr = string_get_cstr(this.Handle)
-        if ptr <> IntPtr.Zero then Marshal.PtrToStringAnsi(ptr) else ""
+    // Builds a string from UTF-8 bytes in one call, with no transcoding or NUL scanning
+    static member FromUtf8(text: ReadOnlySpan<byte>) =
+        use ptr = fixed text
+        let handle = new SafeStringCppHandleFromPtr(string_create_utf8(ptr, text.Length))
+        if handle.IsInvalid then failwith $"Failed to create string: {getLastErrorMessage()}"
+        new CppString(handle :> SafeHandleZeroOrMinusOneIsInvalid)
+    
+    static member FromUtf8(text: byte[]) = CppString.FromUtf8(ReadOnlySpan<byte>(text))
+    
+    // Rope-backed string for large documents built from many appends, prepends and inserts.
+    // Value and AsUtf8Span flatten it; ChunkAt and WriteTo read it without flattening.
+    static member Rope(text: ReadOnlySpan<byte>) =
+        use ptr = fixed text
+        let handle = new SafeStringCppHandleFromPtr(string_create_rope(ptr, text.Length))
+        if handle.IsInvalid then failwith $"Failed to create string: {getLastErrorMessage()}"
+        new CppString(handle :> SafeHandleZeroOrMinusOneIsInvalid)
+    
+    static member Rope() = CppString.Rope(ReadOnlySpan<byte>.Empty)
+    
+    // Zero-copy view over the native bytes; invalidated by any call that modifies the string, and by Dispose
+    member this.AsUtf8Span() : ReadOnlySpan<byte> =
+        let mutable data = IntPtr.Zero
+        let mutable length = 0
+        let status = string_view(this.Handle, &data, &length)
+        if status <> CppResultCode.Success then invalidOp $"String view failed: {status}"
+        ReadOnlySpan<byte>(data.ToPointer(), length)
+    
+    member this.Value : string = Text.Encoding.UTF8.GetString(this.AsUtf8Span())
     
     member this.Append(text: string) = string_append(this.Handle, text)
     member this.Prepend(text: string) = string_prepend(this.Handle, text)
+    
+    member this.AppendUtf8(text: ReadOnlySpan<byte>) =
+        use ptr = fixed text
+        match string_append_utf8(this.Handle, ptr, text.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof text) $"String append failed: {status}"
+    
+    member this.AppendUtf8(text: byte[]) = this.AppendUtf8(ReadOnlySpan<byte>(text))
+    
+    member this.PrependUtf8(text: ReadOnlySpan<byte>) =
+        use ptr = fixed text
+        match string_prepend_utf8(this.Handle, ptr, text.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof text) $"String prepend failed: {status}"
+    
+    member this.PrependUtf8(text: byte[]) = this.PrependUtf8(ReadOnlySpan<byte>(text))
+    
+    // offset is in bytes and must not split a UTF-8 sequence
+    member this.InsertUtf8(offset: int, text: ReadOnlySpan<byte>) =
+        use ptr = fixed text
+        match string_insert_utf8(this.Handle, offset, ptr, text.Length) with
+        | CppResultCode.Success -> ()
+        | CppResultCode.OutOfBounds -> raise (ArgumentOutOfRangeException(nameof offset, getLastErrorMessage()))
+        | status -> invalidArg (nameof text) $"String insert failed: {status}"
+    
+    member this.InsertUtf8(offset: int, text: byte[]) = this.InsertUtf8(offset, ReadOnlySpan<byte>(text))
+    
+    // One chunk for flat strings (none when empty), one per rope piece otherwise
+    member this.ChunkCount = string_chunk_count(this.Handle)
+    
+    // Zero-copy view of one chunk; invalidated like AsUtf8Span, and also by reading Value
+    member this.ChunkAt(index: int) : ReadOnlySpan<byte> =
+        let mutable data = IntPtr.Zero
+        let mutable length = 0
+        let status = string_chunk_at(this.Handle, index, &data, &length)
+        if status <> CppResultCode.Success then raise (ArgumentOutOfRangeException(nameof index, $"{status}"))
+        ReadOnlySpan<byte>(data.ToPointer(), length)
+    
+    // Streams the UTF-8 bytes chunk by chunk without flattening
+    member this.WriteTo(destination: IO.Stream) =
+        for i in 0 .. this.ChunkCount - 1 do
+            destination.Write(this.ChunkAt(i))
     member this.Length = string_length_cpp(this.Handle)
     member this.Reverse() = string_reverse(this.Handle)
     member this.ToUpper() = string_to_upper(this.Handle)
@@ -299,16 +1102,88 @@ type CppMatrix private (safeHandle: SafeHandleZeroOrMinusOneIsInvalid) =
     internal new(existingHandle: SafeMatrixHandleFromPtr) = 
         new CppMatrix(existingHandle :> SafeHandleZeroOrMinusOneIsInvalid)
     
+    // Constructor for matrices owned by a CppArena
+    internal new(arenaHandle: SafeArenaObjectHandle) =
+        new CppMatrix(arenaHandle :> SafeHandleZeroOrMinusOneIsInvalid)
+    
     member _.Handle = 
         if safeHandle.IsInvalid then failwith "Matrix has been disposed"
         safeHandle.DangerousGetHandle()
     
+    member internal _.SafeHandle = safeHandle
+    
     member this.Rows = matrix_rows(this.Handle)
     member this.Cols = matrix_cols(this.Handle)
     member this.Set(row: int, col: int, value: double) = matrix_set(this.Handle, row, col, value)
     member this.Get(row: int, col: int) = matrix_get(this.Handle, row, col)
     member this.Print() = matrix_print(this.Handle)
     
+    // Create a matrix from row-major values in a single native copy
+    static member FromSpan(rows: int, cols: int, values: ReadOnlySpan<double>) =
+        if rows < 0 || cols < 0 || values.Length < rows * cols then
+            invalidArg (nameof values) $"Expected at least {rows * cols} values for a {rows}x{cols} matrix"
+        use ptr = fixed values
+        let handle = matrix_create_from_buffer(ptr, rows, cols)
+        if handle = IntPtr.Zero then failwith "Failed to create matrix"
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    static member FromArray(rows: int, cols: int, values: double[]) =
+        CppMatrix.FromSpan(rows, cols, ReadOnlySpan<double>(values))
+    
+    // Overwrite all elements from row-major values
+    member this.CopyFrom(values: ReadOnlySpan<double>) =
+        use ptr = fixed values
+        match matrix_copy_from_buffer(this.Handle, ptr, values.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof values) $"Matrix copy failed: {status}"
+    
+    // Copy all elements out in row-major order
+    member this.CopyTo(destination: Span<double>) =
+        use ptr = fixed destination
+        match matrix_copy_to_buffer(this.Handle, ptr, destination.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof destination) $"Matrix copy failed: {status}"
+    
+    // Map a file written by Save; pages load on first access. With readonly = false,
+    // element updates are written back to the file.
+    static member OpenMapped(path: string, readonly: bool) =
+        let handle = matrix_open_mmap(path, (if readonly then 1 else 0))
+        if handle = IntPtr.Zero then raise (nativeIoError $"Cannot open matrix file '{path}'")
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    member this.Save(path: string) =
+        match matrix_save(this.Handle, path) with
+        | CppResultCode.Success -> ()
+        | _ -> raise (nativeIoError $"Cannot save matrix file '{path}'")
+    
+    // Multiply and Transpose reuse earlier results for unchanged operands while
+    // the cache holds at most budgetBytes of results; 0 (the default) disables it
+    static member SetResultCacheBudget(budgetBytes: int64) =
+        match matrix_cache_set_budget(budgetBytes) with
+        | CppResultCode.Success -> ()
+        | status -> raise (ArgumentOutOfRangeException(nameof budgetBytes, $"Invalid cache budget: {status}"))
+    
+    static member ClearResultCache() = matrix_cache_clear()
+    
+    static member ResultCacheStatistics =
+        let mutable stats = Unchecked.defaultof<CppMatrixCacheStats>
+        matrix_cache_stats(&stats) |> ignore
+        stats
+    
+    member this.ToArray() =
+        let values = Array.zeroCreate<double> (this.Rows * this.Cols)
+        this.CopyTo(Span<double>(values))
+        values
+    
+    // Zero-copy views over the native storage; do not use them after the matrix is disposed.
+    // Writes through them are invisible to the result cache, so the matrix leaves it for good.
+    member this.AsSpan() =
+        Span<double>(matrix_data_ptr(this.Handle).ToPointer(), this.Rows * this.Cols)
+    
+    member this.AsMemory() =
+        let manager = new NativeMemoryManager<double>(matrix_data_ptr(this.Handle), this.Rows * this.Cols)
+        manager.Memory
+    
     member this.Multiply(other: CppMatrix) =
         let resultHandle = matrix_multiply(this.Handle, other.Handle)
         if resultHandle <> IntPtr.Zero then
@@ -327,6 +1202,510 @@ type CppMatrix private (safeHandle: SafeHandleZeroOrMinusOneIsInvalid) =
         else
             None
     
+    // Allocation-free variants that write into an existing matrix of the right shape
+    member this.MultiplyInto(other: CppMatrix, result: CppMatrix) =
+        match matrix_multiply_into(this.Handle, other.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix multiply failed: {status}"
+    
+    // this <- alpha * a * b + beta * this
+    member this.Gemm(alpha: double, a: CppMatrix, b: CppMatrix, beta: double) =
+        match matrix_gemm(alpha, a.Handle, b.Handle, beta, this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof a) $"Matrix GEMM failed: {status}"
+    
+    member this.TransposeInto(result: CppMatrix) =
+        match matrix_transpose_into(this.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix transpose failed: {status}"
+    
+    // Square matrices only
+    member this.TransposeInPlace() =
+        match matrix_transpose_in_place(this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidOp $"Matrix transpose failed: {status}"
+    
+    // Multiply on the native job runner without blocking the calling thread.
+    // Both operands are kept alive until the product is ready, even if disposed.
+    member this.MultiplyAsync(other: CppMatrix, cancellationToken: CancellationToken) =
+        // A started job can finish before the cancellation registration runs
+        if cancellationToken.IsCancellationRequested then Task.FromCanceled<CppMatrix>(cancellationToken)
+        else MatrixJob.Start(this, other, cancellationToken)
+    
+    member this.MultiplyAsync(other: CppMatrix) =
+        this.MultiplyAsync(other, CancellationToken.None)
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Bridges one native job to a Task. The native callback releases the job handle,
+// so every other use of it happens under the lock and only while unfinished.
+// Cancelling completes the task at once; the native job is cleaned up when it ends.
+and internal MatrixJob private (operands: SafeHandle list) =
+    let completion = TaskCompletionSource<CppMatrix>(TaskCreationOptions.RunContinuationsAsynchronously)
+    let mutable job = IntPtr.Zero
+    let mutable finished = false
+    let mutable registration = Unchecked.defaultof<CancellationTokenRegistration>
+    
+    // Kept in a static so the function pointer handed to native code stays valid
+    static let callback =
+        JobCallbackDelegate(fun handle status userState ->
+            let gcHandle = GCHandle.FromIntPtr(userState)
+            let state = gcHandle.Target :?> MatrixJob
+            gcHandle.Free()
+            state.Complete(handle, status))
+    
+    static member Start(a: CppMatrix, b: CppMatrix, cancellationToken: CancellationToken) =
+        let aPtr, bPtr = a.Handle, b.Handle
+        let operands = [ a.SafeHandle :> SafeHandle; b.SafeHandle :> SafeHandle ]
+        for operand in operands do
+            let mutable added = false
+            operand.DangerousAddRef(&added)
+        let state = new MatrixJob(operands)
+        let gcHandle = GCHandle.Alloc(state)
+        let handle = matrix_multiply_async(aPtr, bPtr, callback, GCHandle.ToIntPtr(gcHandle))
+        if handle = IntPtr.Zero then
+            gcHandle.Free()
+            state.ReleaseOperands()
+            invalidArg (nameof b) $"Matrix multiply failed: {getLastErrorMessage()}"
+        state.Attach(handle, cancellationToken)
+        state.Task
+    
+    member private _.ReleaseOperands() =
+        for operand in operands do operand.DangerousRelease()
+    
+    member private this.Attach(handle: IntPtr, cancellationToken: CancellationToken) =
+        lock this (fun () -> if not finished then job <- handle)
+        if cancellationToken.CanBeCanceled then
+            let r = cancellationToken.Register(fun () -> this.Cancel(cancellationToken))
+            let alreadyFinished = lock this (fun () -> registration <- r; finished)
+            if alreadyFinished then r.Dispose()
+    
+    member private this.Cancel(cancellationToken: CancellationToken) =
+        lock this (fun () -> if not finished && job <> IntPtr.Zero then job_cancel(job) |> ignore)
+        completion.TrySetCanceled(cancellationToken) |> ignore
+    
+    // Runs on the native runner thread, so nothing may escape it
+    member private this.Complete(handle: IntPtr, status: CppResultCode) =
+        try
+            try
+                let pending = lock this (fun () -> finished <- true; job <- IntPtr.Zero; registration)
+                pending.Dispose()
+                match status with
+                | CppResultCode.Success ->
+                    let result = new CppMatrix(new SafeMatrixHandleFromPtr(job_result(handle)))
+                    if not (completion.TrySetResult(result)) then (result :> IDisposable).Dispose()
+                | CppResultCode.Cancelled ->
+                    completion.TrySetCanceled() |> ignore
+                | _ ->
+                    // Polling republishes the job's error message on this thread
+                    job_poll(handle) |> ignore
+                    let error = InvalidOperationException($"Matrix multiply failed: {status}: {getLastErrorMessage()}")
+                    completion.TrySetException(error) |> ignore
+            with ex ->
+                completion.TrySetException(ex) |> ignore
+        finally
+            job_destroy(handle)
+            this.ReleaseOperands()
+    
+    member internal _.Task = completion.Task
+
+// Large native buffer of doubles: 64-byte aligned, lazily zeroed, optionally on huge pages.
+// Statistics and matrices read it in place.
+type CppSmartResource(size: int, flags: CppResourceFlags) =
+    let safeHandle =
+        let handle = new SafeSmartResourceHandle(smart_resource_create_ex(size, flags))
+        if handle.IsInvalid then failwith $"Failed to create resource: {getLastErrorMessage()}"
+        handle
+    
+    let check (status: CppResultCode) (what: string) =
+        if status <> CppResultCode.Success then
+            raise (ArgumentOutOfRangeException(what, $"Resource operation failed: {status}: {getLastErrorMessage()}"))
+    
+    new(size: int) = new CppSmartResource(size, CppResourceFlags.Default)
+    
+    member _.Handle =
+        if safeHandle.IsClosed then failwith "Resource has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.Size = smart_resource_size(this.Handle)
+    member this.Get(index: int) = smart_resource_get(this.Handle, index)
+    member this.Set(index: int, value: double) = smart_resource_use(this.Handle, index, value)
+    // True when the buffer sits on explicitly reserved (MAP_HUGETLB) huge pages
+    member this.UsesHugePages = smart_resource_huge_pages(this.Handle) <> 0
+    
+    member this.Fill(value: double) = this.Fill(0, this.Size, value)
+    member this.Fill(offset: int, count: int, value: double) =
+        check (smart_resource_fill(this.Handle, offset, count, value)) (nameof count)
+    
+    member this.CopyFrom(offset: int, values: ReadOnlySpan<double>) =
+        use ptr = fixed values
+        check (smart_resource_copy_in(this.Handle, offset, ptr, values.Length)) (nameof offset)
+    
+    member this.CopyTo(offset: int, destination: Span<double>) =
+        use ptr = fixed destination
+        check (smart_resource_copy_out(this.Handle, offset, ptr, destination.Length)) (nameof offset)
+    
+    // Zero-copy view; do not use it after the resource is disposed
+    member this.AsSpan() =
+        Span<double>(smart_resource_data_ptr(this.Handle).ToPointer(), this.Size)
+    
+    member this.Statistics() = this.Statistics(0, this.Size)
+    member this.Statistics(offset: int, count: int) =
+        let mutable result = Unchecked.defaultof<StatsResult>
+        check (smart_resource_statistics(this.Handle, offset, count, &result)) (nameof count)
+        result
+    
+    // Row-major matrix over rows * cols elements from offset, sharing the storage.
+    // The matrix keeps the storage alive even after this resource is disposed.
+    member this.AsMatrix(offset: int, rows: int, cols: int) =
+        let handle = matrix_create_over_resource(this.Handle, offset, rows, cols)
+        if handle = IntPtr.Zero then
+            raise (ArgumentOutOfRangeException(nameof rows, $"Cannot create matrix view: {getLastErrorMessage()}"))
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Single-precision matrix with the same operations as CppMatrix
+type CppMatrixF32 private (safeHandle: SafeMatrixF32Handle) =
+    new(rows: int, cols: int) =
+        let handle = new SafeMatrixF32Handle(matrix_f32_create(rows, cols))
+        if handle.IsInvalid then failwith "Failed to create matrix"
+        new CppMatrixF32(handle)
+    
+    static member private Adopt(handle: IntPtr) =
+        if handle <> IntPtr.Zero then Some (new CppMatrixF32(new SafeMatrixF32Handle(handle))) else None
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Matrix has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.Rows = matrix_f32_rows(this.Handle)
+    member this.Cols = matrix_f32_cols(this.Handle)
+    member this.Set(row: int, col: int, value: float32) = matrix_f32_set(this.Handle, row, col, value)
+    member this.Get(row: int, col: int) = matrix_f32_get(this.Handle, row, col)
+    
+    static member FromSpan(rows: int, cols: int, values: ReadOnlySpan<float32>) =
+        if rows < 0 || cols < 0 || values.Length < rows * cols then
+            invalidArg (nameof values) $"Expected at least {rows * cols} values for a {rows}x{cols} matrix"
+        use ptr = fixed values
+        match CppMatrixF32.Adopt(matrix_f32_create_from_buffer(ptr, rows, cols)) with
+        | Some matrix -> matrix
+        | None -> failwith "Failed to create matrix"
+    
+    static member FromArray(rows: int, cols: int, values: float32[]) =
+        CppMatrixF32.FromSpan(rows, cols, ReadOnlySpan<float32>(values))
+    
+    member this.CopyFrom(values: ReadOnlySpan<float32>) =
+        use ptr = fixed values
+        match matrix_f32_copy_from_buffer(this.Handle, ptr, values.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof values) $"Matrix copy failed: {status}"
+    
+    member this.CopyTo(destination: Span<float32>) =
+        use ptr = fixed destination
+        match matrix_f32_copy_to_buffer(this.Handle, ptr, destination.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof destination) $"Matrix copy failed: {status}"
+    
+    static member OpenMapped(path: string, readonly: bool) =
+        match CppMatrixF32.Adopt(matrix_f32_open_mmap(path, (if readonly then 1 else 0))) with
+        | Some matrix -> matrix
+        | None -> raise (nativeIoError $"Cannot open matrix file '{path}'")
+    
+    member this.Save(path: string) =
+        match matrix_f32_save(this.Handle, path) with
+        | CppResultCode.Success -> ()
+        | _ -> raise (nativeIoError $"Cannot save matrix file '{path}'")
+    
+    member this.ToArray() =
+        let values = Array.zeroCreate<float32> (this.Rows * this.Cols)
+        this.CopyTo(Span<float32>(values))
+        values
+    
+    member this.AsSpan() =
+        Span<float32>(matrix_f32_data_ptr(this.Handle).ToPointer(), this.Rows * this.Cols)
+    
+    member this.Multiply(other: CppMatrixF32) = CppMatrixF32.Adopt(matrix_f32_multiply(this.Handle, other.Handle))
+    member this.Transpose() = CppMatrixF32.Adopt(matrix_f32_transpose(this.Handle))
+    
+    member this.MultiplyInto(other: CppMatrixF32, result: CppMatrixF32) =
+        match matrix_f32_multiply_into(this.Handle, other.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix multiply failed: {status}"
+    
+    // this <- alpha * a * b + beta * this
+    member this.Gemm(alpha: float32, a: CppMatrixF32, b: CppMatrixF32, beta: float32) =
+        match matrix_f32_gemm(alpha, a.Handle, b.Handle, beta, this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof a) $"Matrix GEMM failed: {status}"
+    
+    member this.TransposeInto(result: CppMatrixF32) =
+        match matrix_f32_transpose_into(this.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix transpose failed: {status}"
+    
+    member this.TransposeInPlace() =
+        match matrix_f32_transpose_in_place(this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidOp $"Matrix transpose failed: {status}"
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Int32 matrix with the same operations as CppMatrix; products wrap on overflow
+type CppMatrixI32 private (safeHandle: SafeMatrixI32Handle) =
+    new(rows: int, cols: int) =
+        let handle = new SafeMatrixI32Handle(matrix_i32_create(rows, cols))
+        if handle.IsInvalid then failwith "Failed to create matrix"
+        new CppMatrixI32(handle)
+    
+    static member private Adopt(handle: IntPtr) =
+        if handle <> IntPtr.Zero then Some (new CppMatrixI32(new SafeMatrixI32Handle(handle))) else None
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Matrix has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.Rows = matrix_i32_rows(this.Handle)
+    member this.Cols = matrix_i32_cols(this.Handle)
+    member this.Set(row: int, col: int, value: int) = matrix_i32_set(this.Handle, row, col, value)
+    member this.Get(row: int, col: int) = matrix_i32_get(this.Handle, row, col)
+    
+    static member FromSpan(rows: int, cols: int, values: ReadOnlySpan<int>) =
+        if rows < 0 || cols < 0 || values.Length < rows * cols then
+            invalidArg (nameof values) $"Expected at least {rows * cols} values for a {rows}x{cols} matrix"
+        use ptr = fixed values
+        match CppMatrixI32.Adopt(matrix_i32_create_from_buffer(ptr, rows, cols)) with
+        | Some matrix -> matrix
+        | None -> failwith "Failed to create matrix"
+    
+    static member FromArray(rows: int, cols: int, values: int[]) =
+        CppMatrixI32.FromSpan(rows, cols, ReadOnlySpan<int>(values))
+    
+    member this.CopyFrom(values: ReadOnlySpan<int>) =
+        use ptr = fixed values
+        match matrix_i32_copy_from_buffer(this.Handle, ptr, values.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof values) $"Matrix copy failed: {status}"
+    
+    member this.CopyTo(destination: Span<int>) =
+        use ptr = fixed destination
+        match matrix_i32_copy_to_buffer(this.Handle, ptr, destination.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof destination) $"Matrix copy failed: {status}"
+    
+    static member OpenMapped(path: string, readonly: bool) =
+        match CppMatrixI32.Adopt(matrix_i32_open_mmap(path, (if readonly then 1 else 0))) with
+        | Some matrix -> matrix
+        | None -> raise (nativeIoError $"Cannot open matrix file '{path}'")
+    
+    member this.Save(path: string) =
+        match matrix_i32_save(this.Handle, path) with
+        | CppResultCode.Success -> ()
+        | _ -> raise (nativeIoError $"Cannot save matrix file '{path}'")
+    
+    member this.ToArray() =
+        let values = Array.zeroCreate<int> (this.Rows * this.Cols)
+        this.CopyTo(Span<int>(values))
+        values
+    
+    member this.AsSpan() =
+        Span<int>(matrix_i32_data_ptr(this.Handle).ToPointer(), this.Rows * this.Cols)
+    
+    member this.Multiply(other: CppMatrixI32) = CppMatrixI32.Adopt(matrix_i32_multiply(this.Handle, other.Handle))
+    member this.Transpose() = CppMatrixI32.Adopt(matrix_i32_transpose(this.Handle))
+    
+    member this.MultiplyInto(other: CppMatrixI32, result: CppMatrixI32) =
+        match matrix_i32_multiply_into(this.Handle, other.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix multiply failed: {status}"
+    
+    // this <- alpha * a * b + beta * this
+    member this.Gemm(alpha: int, a: CppMatrixI32, b: CppMatrixI32, beta: int) =
+        match matrix_i32_gemm(alpha, a.Handle, b.Handle, beta, this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof a) $"Matrix GEMM failed: {status}"
+    
+    member this.TransposeInto(result: CppMatrixI32) =
+        match matrix_i32_transpose_into(this.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Matrix transpose failed: {status}"
+    
+    member this.TransposeInPlace() =
+        match matrix_i32_transpose_in_place(this.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidOp $"Matrix transpose failed: {status}"
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Compressed sparse row matrix for data that is mostly zeros. FromCoo sums
+// duplicate entries; products with a CppMatrix are dense, sparse products stay sparse.
+type CppSparseMatrix private (safeHandle: SafeSparseMatrixHandle) =
+    static let adopt (handle: IntPtr) (paramName: string) =
+        if handle = IntPtr.Zero then
+            invalidArg paramName $"Sparse matrix operation failed: {getLastErrorMessage()}"
+        new CppSparseMatrix(new SafeSparseMatrixHandle(handle))
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Matrix has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.Rows = sparse_matrix_rows(this.Handle)
+    member this.Cols = sparse_matrix_cols(this.Handle)
+    member this.NonZeroCount = sparse_matrix_nnz(this.Handle)
+    member this.Get(row: int, col: int) = sparse_matrix_get(this.Handle, row, col)
+    
+    // Builds the matrix from (row, col, value) triplets in any order in one native call
+    static member FromCoo(rows: int, cols: int, rowIndices: ReadOnlySpan<int>, colIndices: ReadOnlySpan<int>,
+                          values: ReadOnlySpan<double>) =
+        if rowIndices.Length <> values.Length || colIndices.Length <> values.Length then
+            invalidArg (nameof values) "Row indices, column indices and values must have the same length"
+        use rowPtr = fixed rowIndices
+        use colPtr = fixed colIndices
+        use valuePtr = fixed values
+        adopt (sparse_matrix_from_coo(rows, cols, rowPtr, colPtr, valuePtr, values.Length)) (nameof rowIndices)
+    
+    static member FromCoo(rows: int, cols: int, rowIndices: int[], colIndices: int[], values: double[]) =
+        CppSparseMatrix.FromCoo(rows, cols, ReadOnlySpan<int>(rowIndices), ReadOnlySpan<int>(colIndices),
+                                ReadOnlySpan<double>(values))
+    
+    static member FromDense(matrix: CppMatrix) =
+        adopt (sparse_matrix_from_dense(matrix.Handle)) (nameof matrix)
+    
+    member this.ToDense() =
+        let handle = sparse_matrix_to_dense(this.Handle)
+        if handle = IntPtr.Zero then failwith $"Failed to convert sparse matrix: {getLastErrorMessage()}"
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    // Nonzero entries in row-major order
+    member this.ToCoo() =
+        let count = this.NonZeroCount
+        let rowIndices = Array.zeroCreate<int> count
+        let colIndices = Array.zeroCreate<int> count
+        let values = Array.zeroCreate<double> count
+        use rowPtr = fixed rowIndices
+        use colPtr = fixed colIndices
+        use valuePtr = fixed values
+        sparse_matrix_to_coo(this.Handle, rowPtr, colPtr, valuePtr, count) |> ignore
+        rowIndices, colIndices, values
+    
+    // y <- A x without allocating; y may be x for a square matrix
+    member this.MultiplyVector(x: ReadOnlySpan<double>, y: Span<double>) =
+        use xPtr = fixed x
+        use yPtr = fixed y
+        match sparse_matrix_spmv(this.Handle, xPtr, x.Length, yPtr, y.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof y) $"Sparse matrix-vector multiply failed: {status}: {getLastErrorMessage()}"
+    
+    member this.MultiplyVector(x: double[]) =
+        let y = Array.zeroCreate<double> this.Rows
+        this.MultiplyVector(ReadOnlySpan<double>(x), Span<double>(y))
+        y
+    
+    member this.Multiply(other: CppMatrix) =
+        let handle = sparse_matrix_multiply_dense(this.Handle, other.Handle)
+        if handle = IntPtr.Zero then
+            invalidArg (nameof other) $"Sparse matrix multiply failed: {getLastErrorMessage()}"
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    member this.Multiply(other: CppSparseMatrix) =
+        adopt (sparse_matrix_multiply(this.Handle, other.Handle)) (nameof other)
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Lazy matrix expression: nothing is computed until Eval, which fuses transposes
+// into the multiplies and picks the cheapest order for product chains.
+// Leaf matrices are referenced, not copied; Eval fails once one has been disposed.
+type CppMatrixExpr private (safeHandle: SafeMatrixExprHandle, leaves: CppMatrix list) =
+    static let adopt (handle: IntPtr) (leaves: CppMatrix list) (paramName: string) =
+        if handle = IntPtr.Zero then
+            invalidArg paramName (Marshal.PtrToStringAnsi(get_last_error_message()))
+        new CppMatrixExpr(new SafeMatrixExprHandle(handle), leaves)
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Expression has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    // Keeps the leaf wrappers reachable for as long as the expression is
+    member internal _.Leaves = leaves
+    
+    static member Of(matrix: CppMatrix) =
+        adopt (matrix_expr_leaf(matrix.Handle)) [ matrix ] (nameof matrix)
+    
+    member this.Rows = matrix_expr_rows(this.Handle)
+    member this.Cols = matrix_expr_cols(this.Handle)
+    
+    member this.Transpose() =
+        adopt (matrix_expr_transpose(this.Handle)) leaves "this"
+    
+    member this.Multiply(other: CppMatrixExpr) =
+        adopt (matrix_expr_mul(this.Handle, other.Handle)) (leaves @ other.Leaves) (nameof other)
+    
+    member this.Add(other: CppMatrixExpr) =
+        adopt (matrix_expr_add(this.Handle, other.Handle)) (leaves @ other.Leaves) (nameof other)
+    
+    static member (*) (a: CppMatrixExpr, b: CppMatrixExpr) = a.Multiply(b)
+    static member (+) (a: CppMatrixExpr, b: CppMatrixExpr) = a.Add(b)
+    
+    member this.Eval() =
+        let handle = matrix_expr_eval(this.Handle)
+        if handle = IntPtr.Zero then failwith "Failed to evaluate matrix expression"
+        new CppMatrix(new SafeMatrixHandleFromPtr(handle))
+    
+    // The result may also be one of the expression's leaves
+    member this.EvalInto(result: CppMatrix) =
+        match matrix_expr_eval_into(this.Handle, result.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof result) $"Expression evaluation failed: {status}"
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Scope for short-lived native objects. Matrices, vectors and strings created
+// here are bump-allocated and released together by Reset or Dispose; their
+// wrappers do not free anything themselves and must not be used afterwards.
+type CppArena(blockSize: int) =
+    let safeHandle = new SafeArenaHandle(blockSize)
+    
+    do if safeHandle.IsInvalid then failwith "Failed to create arena"
+    
+    // Default 64 KiB blocks
+    new() = new CppArena(0)
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Arena has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.BytesUsed = cpp_arena_bytes_used(this.Handle)
+    member this.Reset() = cpp_arena_reset(this.Handle)
+    
+    member this.CreateMatrix(rows: int, cols: int) =
+        let handle = matrix_create_in(this.Handle, rows, cols)
+        if handle = IntPtr.Zero then failwith "Failed to create matrix"
+        new CppMatrix(new SafeArenaObjectHandle(handle))
+    
+    member this.Multiply(a: CppMatrix, b: CppMatrix) =
+        let handle = matrix_multiply_in(this.Handle, a.Handle, b.Handle)
+        if handle <> IntPtr.Zero then Some (new CppMatrix(new SafeArenaObjectHandle(handle))) else None
+    
+    member this.Transpose(matrix: CppMatrix) =
+        let handle = matrix_transpose_in(this.Handle, matrix.Handle)
+        if handle <> IntPtr.Zero then Some (new CppMatrix(new SafeArenaObjectHandle(handle))) else None
+    
+    member this.CreateVector() =
+        let handle = vector_create_in(this.Handle)
+        if handle = IntPtr.Zero then failwith "Failed to create vector"
+        new CppVector(new SafeArenaObjectHandle(handle))
+    
+    member this.CreateString(initial: string) =
+        let handle = string_create_in(this.Handle, initial)
+        if handle = IntPtr.Zero then failwith "Failed to create string"
+        new CppString(new SafeArenaObjectHandle(handle))
+    
     interface IDisposable with
         member _.Dispose() = safeHandle.Dispose()
 
@@ -338,23 +1717,208 @@ type CppFunction private(safeHandle: SafeFunctionHandle, name: string) =
     member _.Name = name
     member this.Call(a: double, b: double) = function_call(this.Handle, a, b)
     
+    // Apply the function to every (a[i], b[i]) pair in one native call
+    member this.CallBatch(a: ReadOnlySpan<double>, b: ReadOnlySpan<double>, result: Span<double>) =
+        if a.Length <> b.Length || result.Length < a.Length then
+            invalidArg (nameof result) $"Expected inputs of equal length and room for {a.Length} results"
+        use aPtr = fixed a
+        use bPtr = fixed b
+        use resultPtr = fixed result
+        match function_call_batch(this.Handle, aPtr, bPtr, resultPtr, a.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidOp $"{name} batch call failed: {status}"
+    
+    member this.CallBatch(a: double[], b: double[]) =
+        let result = Array.zeroCreate<double> a.Length
+        this.CallBatch(ReadOnlySpan<double>(a), ReadOnlySpan<double>(b), Span<double>(result))
+        result
+    
+    // Number of inputs read: one past the highest Input index
+    member this.Arity = function_arity(this.Handle)
+    
+    // result[i] = f(inputs.[0].[i], inputs.[1].[i], ...) in one fused native pass
+    member this.Evaluate(inputs: ReadOnlyMemory<double>[], result: Span<double>) =
+        let count = result.Length
+        if inputs.Length < this.Arity then
+            invalidArg (nameof inputs) $"{name} reads {this.Arity} inputs but {inputs.Length} were given"
+        if inputs |> Array.exists (fun input -> input.Length < count) then
+            invalidArg (nameof inputs) $"Every input needs at least {count} elements"
+        let pins = inputs |> Array.map (fun input -> input.Pin())
+        try
+            let pointers = pins |> Array.map (fun pin -> IntPtr(pin.Pointer))
+            use pointersPtr = fixed pointers
+            use resultPtr = fixed result
+            match function_evaluate(this.Handle, pointersPtr, pointers.Length, resultPtr, count) with
+            | CppResultCode.Success -> ()
+            | status -> invalidOp $"{name} evaluation failed: {status}: {getLastErrorMessage()}"
+        finally
+            pins |> Array.iter (fun pin -> pin.Dispose())
+    
+    member this.Evaluate([<ParamArray>] inputs: double[][]) =
+        let count = if inputs.Length = 0 then 0 else inputs.[0].Length
+        let result = Array.zeroCreate<double> count
+        this.Evaluate(inputs |> Array.map (fun input -> ReadOnlyMemory<double>(input)), Span<double>(result))
+        result
+    
     static member CreateAdd() = new CppFunction(SafeFunctionHandle.CreateAdd(), "Add")
     static member CreateMultiply() = new CppFunction(SafeFunctionHandle.CreateMultiply(), "Multiply") 
     static member CreatePower() = new CppFunction(SafeFunctionHandle.CreatePower(), "Power")
     
+    // Pipeline building blocks: input i, a constant, and outer with left and right
+    // fed into its inputs 0 and 1. Composed functions are independent of their parts.
+    static member Input(index: int) =
+        let handle = SafeFunctionHandle.Input(index)
+        if handle.IsInvalid then raise (ArgumentOutOfRangeException(nameof index, getLastErrorMessage()))
+        new CppFunction(handle, $"Input{index}")
+    
+    static member Constant(value: double) = new CppFunction(SafeFunctionHandle.Constant(value), $"Constant({value})")
+    
+    static member Compose(outer: CppFunction, left: CppFunction, right: CppFunction) =
+        let handle = SafeFunctionHandle.Compose(outer.Handle, left.Handle, right.Handle)
+        if handle.IsInvalid then invalidOp $"Failed to compose functions: {getLastErrorMessage()}"
+        new CppFunction(handle, $"{outer.Name}({left.Name}, {right.Name})")
+    
+    // Fused-kernel cache counters: (hits, misses, cached kernels)
+    static member CacheStatistics =
+        let mutable hits = 0L
+        let mutable misses = 0L
+        let mutable entries = 0
+        function_cache_stats(&hits, &misses, &entries)
+        hits, misses, entries
+    
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
+
+// Running statistics over chunks of data; each Push is one native call and
+// nothing is retained but the summary. Not thread-safe: use one accumulator
+// per thread and Merge them.
+type StatsAccumulator() =
+    let safeHandle =
+        let handle = new SafeStatsAccumulatorHandle()
+        if handle.IsInvalid then failwith "Failed to create statistics accumulator"
+        handle
+    
+    member _.Handle = 
+        if safeHandle.IsInvalid then failwith "Statistics accumulator has been disposed"
+        safeHandle.DangerousGetHandle()
+    
+    member this.Push(values: ReadOnlySpan<double>) =
+        use ptr = fixed values
+        match stats_push_batch(this.Handle, ptr, values.Length) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof values) $"Statistics push failed: {status}"
+    
+    member this.Push(values: double[]) = this.Push(ReadOnlySpan<double>(values))
+    
+    // Fold another accumulator's data into this one; other is left unchanged
+    member this.Merge(other: StatsAccumulator) =
+        match stats_merge(this.Handle, other.Handle) with
+        | CppResultCode.Success -> ()
+        | status -> invalidOp $"Statistics merge failed: {status}"
+    
+    member this.Snapshot() =
+        let mutable result = Unchecked.defaultof<StatsResult>
+        match stats_snapshot(this.Handle, &result) with
+        | CppResultCode.Success -> result
+        | status -> invalidOp $"Statistics snapshot failed: {status}"
+    
+    member this.Reset() = stats_reset(this.Handle)
+    
     interface IDisposable with
         member _.Dispose() = safeHandle.Dispose()
 
 // Helper functions
-let getLastErrorMessage() =
-    let ptr = get_last_error_message()
-    if ptr <> IntPtr.Zero then Marshal.PtrToStringAnsi(ptr) else ""
+// Code and message of the last error on the calling thread
+let getLastError() =
+    (get_last_error_code(), getLastErrorMessage())
+
+// Mean, variance, standard deviation, min, max and sum in one native pass
+let calculateSummary(values: double[]) =
+    let mutable result = Unchecked.defaultof<StatsResult>
+    match calculate_statistics(values, values.Length, &result) with
+    | CppResultCode.Success -> result
+    | status -> failwith $"calculate_statistics failed: {status}"
 
 let calculateStatistics(values: double[]) =
-    let mean = calculate_mean_double(values, values.Length)
-    let variance = calculate_variance(values, values.Length)
-    let stdDev = calculate_standard_deviation(values, values.Length)
-    (mean, variance, stdDev)
+    let summary = calculateSummary values
+    (summary.mean, summary.variance, summary.standard_deviation)
+
+// Save values as a count x 1 matrix file that calculateSummaryFromFile can map
+let saveArray (values: double[]) (path: string) =
+    match array_save(values, values.Length, path) with
+    | CppResultCode.Success -> ()
+    | _ -> raise (nativeIoError $"Cannot save array file '{path}'")
+
+let calculateSummaryFromFile(path: string) =
+    let mutable result = Unchecked.defaultof<StatsResult>
+    match calculate_statistics_mmap(path, &result) with
+    | CppResultCode.Success -> result
+    | _ -> raise (nativeIoError $"Cannot summarize array file '{path}'")
+
+// Transforms packed UTF-8 strings in place with one native call. String i is
+// bytes[offsets.[i] .. offsets.[i + 1]), so offsets has one more entry than there are strings.
+let transformUtf8Batch (transform: CppStringTransform, bytes: Span<byte>, offsets: ReadOnlySpan<int>) =
+    if offsets.Length > 0 then
+        use bytesPtr = fixed bytes
+        use offsetsPtr = fixed offsets
+        match string_transform_batch(bytesPtr, bytes.Length, offsetsPtr, offsets.Length - 1, transform) with
+        | CppResultCode.Success -> ()
+        | status -> invalidArg (nameof offsets) $"String batch transform failed: {status}: {getLastErrorMessage()}"
+
+// Packs the strings into one buffer, transforms them in a single call and unpacks the results
+let transformStrings (transform: CppStringTransform) (values: string[]) =
+    let offsets = Array.zeroCreate<int> (values.Length + 1)
+    for i in 0 .. values.Length - 1 do
+        offsets.[i + 1] <- offsets.[i] + Text.Encoding.UTF8.GetByteCount(values.[i])
+    let bytes = Array.zeroCreate<byte> offsets.[values.Length]
+    for i in 0 .. values.Length - 1 do
+        Text.Encoding.UTF8.GetBytes(values.[i], 0, values.[i].Length, bytes, offsets.[i]) |> ignore
+    transformUtf8Batch(transform, Span<byte>(bytes), ReadOnlySpan<int>(offsets))
+    Array.init values.Length (fun i -> Text.Encoding.UTF8.GetString(bytes, offsets.[i], offsets.[i + 1] - offsets.[i]))
+
+// Native instrumentation summary, one entry per exported function called since
+// the last cpp_stats_reset. Empty unless the library was built with INSTRUMENT=1.
+type NativeFunctionProfile = {
+    Name: string
+    Calls: int64
+    TotalNanoseconds: int64
+    BytesAllocated: int64
+    Histogram: int64[]
+} with
+    member this.MeanNanoseconds = if this.Calls = 0L then 0.0 else float this.TotalNanoseconds / float this.Calls
+    
+    // Upper bound of the histogram bucket holding the given quantile
+    member this.QuantileNanoseconds(quantile: float) =
+        let target = int64 (ceil (quantile * float this.Calls))
+        let mutable seen = 0L
+        let mutable bucket = 0
+        while bucket < this.Histogram.Length - 1 && seen + this.Histogram.[bucket] < target do
+            seen <- seen + this.Histogram.[bucket]
+            bucket <- bucket + 1
+        2.0 ** float (bucket + 1)
+
+let nativeStatsSnapshot() =
+    let count = cpp_stats_snapshot(null, 0)
+    let entries = Array.zeroCreate<CppFunctionStats> count
+    let written = min count (cpp_stats_snapshot(entries, count))
+    entries
+    |> Array.truncate written
+    |> Array.map (fun entry ->
+        { Name = Marshal.PtrToStringAnsi(entry.name)
+          Calls = entry.calls
+          TotalNanoseconds = entry.total_ns
+          BytesAllocated = entry.bytes_allocated
+          Histogram = entry.histogram })
+
+let formatNativeStats (profiles: NativeFunctionProfile[]) =
+    let builder = StringBuilder()
+    builder.AppendLine(sprintf "%-32s %10s %12s %12s %12s %14s" "Function" "Calls" "Total (ms)" "Mean (ns)" "p99 (ns) <=" "Allocated (B)") |> ignore
+    for profile in profiles |> Array.sortByDescending (fun p -> p.TotalNanoseconds) do
+        builder.AppendLine(
+            sprintf "%-32s %10d %12.3f %12.1f %12.0f %14d"
+                profile.Name profile.Calls (float profile.TotalNanoseconds / 1e6) profile.MeanNanoseconds
+                (profile.QuantileNanoseconds 0.99) profile.BytesAllocated) |> ignore
+    builder.ToString()
 
 // ArrayPool-based helpers for better performance with large arrays
 let withPooledDoubleArray minLength (action: double[] -> 'U) : 'U =
@@ -382,8 +1946,7 @@ let calculateStatisticsSafe(values: double[]) =
         // Use pooled array for large arrays to reduce GC pressure
         withPooledDoubleArray values.Length (fun pooledArray ->
             Array.Copy(values, pooledArray, values.Length)
-            let mean = calculate_mean_double(pooledArray, values.Length)
-            let variance = calculate_variance(pooledArray, values.Length)
-            let stdDev = calculate_standard_deviation(pooledArray, values.Length)
-            (mean, variance, stdDev)
+            let mutable summary = Unchecked.defaultof<StatsResult>
+            calculate_statistics(pooledArray, values.Length, &summary) |> ignore
+            (summary.mean, summary.variance, summary.standard_deviation)
         )
\ No newline at end of file
@@ -73,8 +73,12 @@ extern float32 rectangle_area(Rectangle rect)
 extern void fill_array([<In; Out>] int[] array, int size, int value)
 
 [<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+// Wraps on int overflow; sum_array_i64 returns the exact sum
 extern int sum_array([<In>] int[] array, int size)
 
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int64 sum_array_i64([<In>] int[] array, int size)
+
 [<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern void sort_array([<In; Out>] int[] array, int size)
 
@@ -98,6 +102,32 @@ extern ResultCode safe_divide(double a, double b, double& result)
 [<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern ResultCode validate_array([<In>] int[] array, int size)
 
+// Batch geometry over parallel coordinate arrays (structure of arrays)
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern ResultCode calculate_distances_soa([<In>] double[] xs1, [<In>] double[] ys1, [<In>] double[] xs2, [<In>] double[] ys2, [<Out>] double[] result, int n)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern ResultCode pairwise_distance_matrix([<In>] double[] xs1, [<In>] double[] ys1, int n1, [<In>] double[] xs2, [<In>] double[] ys2, int n2, [<Out>] double[] result)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern ResultCode rectangle_areas_batch([<In>] Rectangle[] rects, [<Out>] float32[] result, int n)
+
+// k-nearest-neighbour index over a fixed point set
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern IntPtr point_index_create([<In>] double[] xs, [<In>] double[] ys, int count)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern void point_index_destroy(IntPtr index)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int point_index_size(IntPtr index)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern int point_index_knn(IntPtr index, double x, double y, int k, [<Out>] int[] indices, [<Out>] double[] distances)
+
+[<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
+extern ResultCode point_index_knn_batch(IntPtr index, [<In>] double[] xs, [<In>] double[] ys, int queries, int k, [<Out>] int[] indices, [<Out>] double[] distances)
+
 // Memory management
 [<DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)>]
 extern IntPtr allocate_string(int length)
@@ -158,4 +188,79 @@ let sumArraySafe (values: int[]) =
         withPooledArray values.Length (fun pooledArray ->
             Array.Copy(values, pooledArray, values.Length)
             sum_array(pooledArray, values.Length)
-        )
\ No newline at end of file
+        )
+
+// Batch geometry helpers; coordinate arrays of each set must have equal lengths
+let private checkGeometry (status: ResultCode) =
+    if status <> ResultCode.Success then
+        raise (ArgumentException($"Geometry operation failed: {status}"))
+
+let private checkCoordinates (xs: double[]) (ys: double[]) =
+    if xs.Length <> ys.Length then
+        raise (ArgumentException("x and y coordinate arrays must have the same length"))
+
+let calculateDistances (xs1: double[]) (ys1: double[]) (xs2: double[]) (ys2: double[]) =
+    checkCoordinates xs1 ys1
+    checkCoordinates xs2 ys2
+    checkCoordinates xs1 xs2
+    let result = Array.zeroCreate<double> xs1.Length
+    checkGeometry (calculate_distances_soa(xs1, ys1, xs2, ys2, result, xs1.Length))
+    result
+
+// Row i holds the distances from point i of the first set to every point of the second
+let pairwiseDistances (xs1: double[]) (ys1: double[]) (xs2: double[]) (ys2: double[]) =
+    checkCoordinates xs1 ys1
+    checkCoordinates xs2 ys2
+    let result = Array.zeroCreate<double> (xs1.Length * xs2.Length)
+    checkGeometry (pairwise_distance_matrix(xs1, ys1, xs1.Length, xs2, ys2, xs2.Length, result))
+    Array2D.init xs1.Length xs2.Length (fun i j -> result.[i * xs2.Length + j])
+
+let rectangleAreas (rects: Rectangle[]) =
+    let result = Array.zeroCreate<float32> rects.Length
+    checkGeometry (rectangle_areas_batch(rects, result, rects.Length))
+    result
+
+type SafePointIndexHandle(existingPtr: IntPtr) =
+    inherit SafeHandleZeroOrMinusOneIsInvalid(true)
+
+    do base.SetHandle(existingPtr)
+
+    override this.ReleaseHandle() =
+        if not this.IsInvalid then
+            point_index_destroy(this.handle)
+        true
+
+// k-d tree over a copy of the points; queries return input positions, closest first
+type PointIndex(xs: double[], ys: double[]) =
+    do checkCoordinates xs ys
+    let safeHandle =
+        let handle = new SafePointIndexHandle(point_index_create(xs, ys, xs.Length))
+        if handle.IsInvalid then
+            raise (ArgumentException("A point index needs at least one point"))
+        handle
+
+    member _.Handle =
+        if safeHandle.IsClosed then failwith "Point index has been disposed"
+        safeHandle.DangerousGetHandle()
+
+    member this.Count = point_index_size(this.Handle)
+
+    // The min(k, Count) nearest points to (x, y) as (indices, distances)
+    member this.Nearest(x: double, y: double, k: int) =
+        if k < 0 then raise (ArgumentOutOfRangeException("k"))
+        let indices = Array.zeroCreate<int> k
+        let distances = Array.zeroCreate<double> k
+        let found = point_index_knn(this.Handle, x, y, k, indices, distances)
+        Array.truncate found indices, Array.truncate found distances
+
+    // One row of k per query point; slots past Count hold -1 and infinity
+    member this.NearestBatch(queryXs: double[], queryYs: double[], k: int) =
+        checkCoordinates queryXs queryYs
+        if k < 0 then raise (ArgumentOutOfRangeException("k"))
+        let indices = Array.zeroCreate<int> (queryXs.Length * k)
+        let distances = Array.zeroCreate<double> (queryXs.Length * k)
+        checkGeometry (point_index_knn_batch(this.Handle, queryXs, queryYs, queryXs.Length, k, indices, distances))
+        indices, distances
+
+    interface IDisposable with
+        member _.Dispose() = safeHandle.Dispose()
@@ -240,6 +240,12 @@ let runCppFunctionDemo() =
     printfn "%s: %.1f" multiplyFunc.Name (multiplyFunc.Call(a, b))
     printfn "%s: %.1f" powerFunc.Name (powerFunc.Call(a, b))
 
+// Only populated when libcpp_operations.so was built with make INSTRUMENT=1
+let runNativeStatsSummary() =
+    if cpp_stats_enabled() = 1 then
+        printfn "\n=== Native Instrumentation ==="
+        printf "%s" (formatNativeStats (nativeStatsSnapshot()))
+
 let checkLibraryAvailability() =
     try
         // Try a simple operation to check if the library is loaded
@@ -289,6 +295,7 @@ let main argv =
         runCppMathDemo()
         runCppMatrixDemo()
         runCppFunctionDemo()
+        runNativeStatsSummary()
     
     if cAvailable && cppAvailable then
         printfn "\n=== Demo Complete ==="
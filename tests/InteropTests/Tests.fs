@@ -119,6 +119,19 @@ let ``Array sorting works correctly`` () =
     let expected = [| 1; 2; 5; 8; 9 |]
     Assert.Equal<int[]>(expected, array)
 
+[<Fact>]
+let ``Array sorting handles large inputs with negatives and extremes`` () =
+    skipIfLibraryUnavailable()
+    let random = Random(11)
+    let array = Array.init 100000 (fun _ -> random.Next(Int32.MinValue, Int32.MaxValue))
+    array.[0] <- Int32.MinValue
+    array.[1] <- Int32.MaxValue
+    array.[2] <- 0
+    array.[3] <- -1
+    let expected = Array.sort array
+    sort_array(array, array.Length)
+    Assert.Equal<int[]>(expected, array)
+
 [<Fact>]
 let ``Safe division works correctly`` () =
     skipIfLibraryUnavailable()
@@ -369,6 +382,60 @@ let ``C++ Vector sorting works correctly`` () =
     Assert.Equal(5, vector.Get(2))
     Assert.Equal(8, vector.Get(3))
 
+[<Fact>]
+let ``C++ Vector sorting orders negative values`` () =
+    skipIfCppLibraryUnavailable()
+    use vector = new CppVector()
+    let random = Random(12)
+    // Large enough to take the parallel radix path
+    let values = Array.init 300000 (fun _ -> random.Next(-1000, 1000))
+    for value in values do
+        vector.Add(value)
+    
+    vector.Sort()
+    
+    let expected = Array.sort values
+    Assert.Equal(expected.Length, vector.Size)
+    for i in 0 .. expected.Length - 1 do
+        Assert.Equal(expected.[i], vector.Get(i))
+
+[<Fact>]
+let ``C++ Vector bulk append round-trips values`` () =
+    skipIfCppLibraryUnavailable()
+    use vector = new CppVector()
+    let values = Array.init 10000 (fun i -> i * 3 - 5000)
+    vector.Reserve(values.Length)
+    vector.Add(42)
+    vector.AddRange(values)
+    
+    Assert.Equal(values.Length + 1, vector.Size)
+    Assert.Equal(42, vector.Get(0))
+    Assert.Equal<int[]>(Array.append [| 42 |] values, vector.ToArray())
+
+[<Fact>]
+let ``C++ Vector span views native storage`` () =
+    skipIfCppLibraryUnavailable()
+    use vector = new CppVector()
+    vector.AddRange([| 1; 2; 3; 4 |])
+    
+    let view = vector.AsSpan()
+    Assert.Equal(4, view.Length)
+    Assert.Equal(3, view.[2])
+    
+    // Appending the vector's own storage must not read freed memory
+    vector.AddRange(vector.AsSpan())
+    Assert.Equal<int[]>([| 1; 2; 3; 4; 1; 2; 3; 4 |], vector.ToArray())
+
+[<Fact>]
+let ``C++ Vector bulk transfer rejects bad arguments`` () =
+    skipIfCppLibraryUnavailable()
+    use vector = new CppVector()
+    vector.AddRange([| 1; 2; 3 |])
+    
+    Assert.Throws<ArgumentException>(fun () -> vector.CopyTo(Span<int>(Array.zeroCreate 2))) |> ignore
+    Assert.Throws<ArgumentException>(fun () -> vector.Reserve(-1)) |> ignore
+    Assert.Equal(3, vector.Size)
+
 [<Fact>]
 let ``C++ String manipulation operations work correctly`` () =
     skipIfCppLibraryUnavailable()
@@ -446,3 +513,856 @@ let ``C++ Matrix identity multiplication`` () =
         Assert.Equal(0.0, resultMatrix.Get(1, 1)) // Should remain 0
     | None ->
         Assert.True(false, "Identity multiplication should not fail")
+
+[<Fact>]
+let ``C++ Matrix multiplication matches naive result across block boundaries`` () =
+    skipIfCppLibraryUnavailable()
+    // Dimensions chosen to leave partial micro-kernel tiles and span more than one K block
+    let m, k, n = 37, 300, 45
+    let random = Random(7)
+    let a = Array2D.init m k (fun _ _ -> random.NextDouble() - 0.5)
+    let b = Array2D.init k n (fun _ _ -> random.NextDouble() - 0.5)
+    use matrixA = new CppMatrix(m, k)
+    use matrixB = new CppMatrix(k, n)
+    a |> Array2D.iteri (fun i j value -> matrixA.Set(i, j, value))
+    b |> Array2D.iteri (fun i j value -> matrixB.Set(i, j, value))
+    
+    match matrixA.Multiply(matrixB) with
+    | Some result ->
+        use resultMatrix = result
+        Assert.Equal(m, resultMatrix.Rows)
+        Assert.Equal(n, resultMatrix.Cols)
+        for i in 0 .. m - 1 do
+            for j in 0 .. n - 1 do
+                let expected = Seq.sum (seq { for p in 0 .. k - 1 -> a.[i, p] * b.[p, j] })
+                Assert.Equal(expected, resultMatrix.Get(i, j), 9)
+    | None ->
+        Assert.True(false, "Matrix multiplication should not fail")
+
+[<Fact>]
+let ``C++ Matrix bulk load and store round-trips row-major data`` () =
+    skipIfCppLibraryUnavailable()
+    let values = [| 1.0; 2.0; 3.0; 4.0; 5.0; 6.0 |]
+    use matrix = CppMatrix.FromArray(2, 3, values)
+    Assert.Equal(2, matrix.Rows)
+    Assert.Equal(3, matrix.Cols)
+    Assert.Equal(6.0, matrix.Get(1, 2))
+    Assert.Equal<double[]>(values, matrix.ToArray())
+    
+    matrix.CopyFrom(ReadOnlySpan<double>([| 6.0; 5.0; 4.0; 3.0; 2.0; 1.0 |]))
+    Assert.Equal(6.0, matrix.Get(0, 0))
+    Assert.Equal(1.0, matrix.Get(1, 2))
+
+[<Fact>]
+let ``C++ Matrix span view aliases native storage`` () =
+    skipIfCppLibraryUnavailable()
+    use matrix = new CppMatrix(2, 2)
+    let view = matrix.AsSpan()
+    view.[3] <- 42.0
+    Assert.Equal(42.0, matrix.Get(1, 1))
+    
+    matrix.Set(0, 1, 7.0)
+    Assert.Equal(7.0, matrix.AsMemory().Span.[1])
+
+[<Fact>]
+let ``C++ Matrix bulk copy rejects undersized buffers`` () =
+    skipIfCppLibraryUnavailable()
+    use matrix = new CppMatrix(3, 3)
+    let tooSmall = Array.zeroCreate<double> 4
+    Assert.Throws<ArgumentException>(fun () -> matrix.CopyTo(Span<double>(tooSmall))) |> ignore
+    Assert.Throws<ArgumentException>(fun () -> CppMatrix.FromArray(3, 3, tooSmall) |> ignore) |> ignore
+
+[<Fact>]
+let ``C++ Matrix multiplication is identical for any thread count`` () =
+    skipIfCppLibraryUnavailable()
+    let n = 160
+    let random = Random(11)
+    use a = CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble()))
+    use b = CppMatrix.FromArray(n, n, Array.init (n * n) (fun _ -> random.NextDouble()))
+    let multiplyWith threads =
+        cpp_set_num_threads(threads)
+        match a.Multiply(b) with
+        | Some product ->
+            use result = product
+            result.ToArray()
+        | None -> failwith "Matrix multiplication should not fail"
+    try
+        let serial = multiplyWith 1
+        Assert.Equal(1, cpp_get_num_threads())
+        let pooled = multiplyWith 4
+        Assert.Equal(4, cpp_get_num_threads())
+        Assert.Equal<double[]>(serial, pooled)
+    finally
+        cpp_set_num_threads(0)
+    Assert.True(cpp_get_num_threads() >= 1)
+
+[<Fact>]
+let ``C++ Fused statistics match the individual functions`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(5)
+    // Spans several kernel blocks and leaves a ragged tail
+    let values = Array.init 5003 (fun _ -> random.NextDouble() * 100.0 - 50.0)
+    let summary = calculateSummary values
+    
+    Assert.Equal(5003L, summary.count)
+    Assert.Equal(Array.sum values, summary.sum, 8)
+    Assert.Equal(calculate_mean_double(values, values.Length), summary.mean, 12)
+    Assert.Equal(calculate_variance(values, values.Length), summary.variance, 10)
+    Assert.Equal(sqrt summary.variance, summary.standard_deviation, 12)
+    Assert.Equal(Array.min values, summary.min)
+    Assert.Equal(Array.max values, summary.max)
+
+[<Fact>]
+let ``C++ Statistics stay accurate with a large offset`` () =
+    skipIfCppLibraryUnavailable()
+    // Naive sum-of-squares variance loses every significant digit here
+    let values = Array.init 100000 (fun i -> 1.0e9 + float (i % 2))
+    let summary = calculateSummary values
+    Assert.Equal(1.0e9 + 0.5, summary.mean, 6)
+    Assert.Equal(0.25, summary.variance, 6)
+
+[<Fact>]
+let ``C++ Fused statistics handle empty input`` () =
+    skipIfCppLibraryUnavailable()
+    let summary = calculateSummary [||]
+    Assert.Equal(0L, summary.count)
+    Assert.Equal(0.0, summary.mean)
+    Assert.Equal(0.0, summary.variance)
+
+[<Fact>]
+let ``C++ Error state reports code and message`` () =
+    skipIfCppLibraryUnavailable()
+    use matrix = new CppMatrix(2, 2)
+    clear_last_error()
+    Assert.Equal(CppResultCode.Success, get_last_error_code())
+    
+    matrix.Get(5, 5) |> ignore
+    let (code, message) = getLastError()
+    Assert.Equal(CppResultCode.OutOfBounds, code)
+    Assert.Equal("Matrix index out of range", message)
+    
+    clear_last_error()
+    Assert.Equal("", getLastErrorMessage())
+
+[<Fact>]
+let ``C++ Error state is isolated per thread`` () =
+    skipIfCppLibraryUnavailable()
+    use barrier = new System.Threading.Barrier(2)
+    let run (fail: unit -> unit) =
+        System.Threading.Tasks.Task.Run(fun () ->
+            clear_last_error()
+            fail ()
+            // Both threads have raised their error before either reads it back
+            barrier.SignalAndWait()
+            getLastError())
+    let outOfRange = run (fun () ->
+        use matrix = new CppMatrix(2, 2)
+        matrix.Get(3, 0) |> ignore)
+    let mismatch = run (fun () ->
+        use a = new CppMatrix(2, 3)
+        use b = new CppMatrix(2, 3)
+        let mutable result = IntPtr.Zero
+        safe_matrix_multiply(a.Handle, b.Handle, &result) |> ignore)
+    
+    Assert.Equal((CppResultCode.OutOfBounds, "Matrix index out of range"), outOfRange.Result)
+    Assert.Equal((CppResultCode.InvalidOperation, "Matrix dimensions don't match for multiplication"), mismatch.Result)
+
+[<Fact>]
+let ``C++ Arena objects match heap objects`` () =
+    skipIfCppLibraryUnavailable()
+    use arena = new CppArena()
+    let values = Array.init 12 float
+    let a = arena.CreateMatrix(3, 4)
+    a.CopyFrom(ReadOnlySpan<double>(values))
+    use heapA = CppMatrix.FromArray(3, 4, values)
+    
+    let product = (arena.Multiply(a, (arena.Transpose(a)).Value)).Value
+    use heapProduct = (heapA.Multiply((heapA.Transpose()).Value)).Value
+    Assert.Equal<double[]>(heapProduct.ToArray(), product.ToArray())
+    Assert.True((arena.Multiply(a, a)).IsNone)
+    
+    let vector = arena.CreateVector()
+    vector.AddRange([| 3; 1; 2 |])
+    vector.Sort()
+    Assert.Equal<int[]>([| 1; 2; 3 |], vector.ToArray())
+    
+    let str = arena.CreateString("arena")
+    str.Append(" string")
+    Assert.Equal("arena string", str.Value)
+
+[<Fact>]
+let ``C++ Arena reset reuses its memory`` () =
+    skipIfCppLibraryUnavailable()
+    use arena = new CppArena(4096)
+    Assert.Equal(0L, arena.BytesUsed)
+    
+    let fill () =
+        for _ in 1 .. 100 do
+            // Disposing an arena-owned wrapper must not free the object
+            use matrix = arena.CreateMatrix(4, 4)
+            matrix.Set(3, 3, 1.0)
+    fill ()
+    let used = arena.BytesUsed
+    Assert.True(used >= 100L * 16L * 8L)
+    
+    arena.Reset()
+    Assert.Equal(0L, arena.BytesUsed)
+    fill ()
+    Assert.Equal(used, arena.BytesUsed)
+
+[<Fact>]
+let ``C++ Matrix multiply into reuses the output`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(9)
+    let values = Array.init (40 * 30) (fun _ -> random.NextDouble())
+    use a = CppMatrix.FromArray(40, 30, values)
+    use b = (a.Transpose()).Value
+    use expected = (a.Multiply(b)).Value
+    use result = CppMatrix.FromArray(40, 40, Array.create (40 * 40) nan)
+    
+    a.MultiplyInto(b, result)
+    Assert.Equal<double[]>(expected.ToArray(), result.ToArray())
+    
+    // result <- 2 * a * b - result == a * b
+    result.Gemm(2.0, a, b, -1.0)
+    let actual = result.ToArray()
+    expected.ToArray() |> Array.iteri (fun i value -> Assert.Equal(value, actual.[i], 12))
+    
+    Assert.Throws<ArgumentException>(fun () -> a.MultiplyInto(a, result)) |> ignore
+
+[<Fact>]
+let ``C++ Matrix transposes in place and into a buffer`` () =
+    skipIfCppLibraryUnavailable()
+    let n = 77
+    let values = Array.init (n * n) float
+    use square = CppMatrix.FromArray(n, n, values)
+    square.TransposeInPlace()
+    Assert.Equal(float (5 * n + 3), square.Get(3, 5))
+    Assert.Equal(values.[0], square.Get(0, 0))
+    
+    use wide = CppMatrix.FromArray(2, 3, [| 1.0; 2.0; 3.0; 4.0; 5.0; 6.0 |])
+    use tall = new CppMatrix(3, 2)
+    wide.TransposeInto(tall)
+    Assert.Equal<double[]>([| 1.0; 4.0; 2.0; 5.0; 3.0; 6.0 |], tall.ToArray())
+    Assert.Throws<InvalidOperationException>(fun () -> wide.TransposeInPlace()) |> ignore
+
+[<Fact>]
+let ``C++ Function batch calls match scalar calls`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(10)
+    // Large enough for the parallel power path, with a ragged tail
+    let a = Array.init 50001 (fun _ -> random.NextDouble() * 4.0)
+    let b = Array.init 50001 (fun _ -> random.NextDouble() * 3.0 - 1.0)
+    for create in [ CppFunction.CreateAdd; CppFunction.CreateMultiply; CppFunction.CreatePower ] do
+        use func = create ()
+        let batch = func.CallBatch(a, b)
+        let scalar = Array.init a.Length (fun i -> func.Call(a.[i], b.[i]))
+        Assert.Equal<double[]>(scalar, batch)
+
+[<Fact>]
+let ``C++ Function batch call validates lengths`` () =
+    skipIfCppLibraryUnavailable()
+    use addFunc = CppFunction.CreateAdd()
+    Assert.Throws<ArgumentException>(fun () -> addFunc.CallBatch([| 1.0; 2.0 |], [| 1.0 |]) |> ignore) |> ignore
+    Assert.Empty(addFunc.CallBatch([||], [||]))
+    
+    // Writing the result over an input is allowed
+    let values = [| 1.0; 2.0; 3.0 |]
+    addFunc.CallBatch(ReadOnlySpan<double>(values), ReadOnlySpan<double>(values), Span<double>(values))
+    Assert.Equal<double[]>([| 2.0; 4.0; 6.0 |], values)
+
+[<Fact>]
+let ``C++ Matrix expressions match eager evaluation`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(13)
+    let create rows cols = CppMatrix.FromArray(rows, cols, Array.init (rows * cols) (fun _ -> random.NextDouble()))
+    use a = create 30 20
+    use b = create 30 45
+    use c = create 45 3
+    use d = create 20 3
+    
+    // transpose(A) * B * C + D
+    use expr = (CppMatrixExpr.Of(a).Transpose() * CppMatrixExpr.Of(b) * CppMatrixExpr.Of(c)) + CppMatrixExpr.Of(d)
+    Assert.Equal(20, expr.Rows)
+    Assert.Equal(3, expr.Cols)
+    use lazyResult = expr.Eval()
+    
+    use aT = (a.Transpose()).Value
+    use aTb = (aT.Multiply(b)).Value
+    use aTbc = (aTb.Multiply(c)).Value
+    let expected = Array.map2 (+) (aTbc.ToArray()) (d.ToArray())
+    let actual = lazyResult.ToArray()
+    expected |> Array.iteri (fun i value -> Assert.Equal(value, actual.[i], 10))
+    
+    // Evaluating into a leaf of the same expression is safe
+    expr.EvalInto(d)
+    Assert.Equal<double[]>(actual, d.ToArray())
+
+[<Fact>]
+let ``C++ Matrix expressions reject mismatched shapes`` () =
+    skipIfCppLibraryUnavailable()
+    use a = new CppMatrix(2, 3)
+    use b = new CppMatrix(2, 3)
+    use left = CppMatrixExpr.Of(a)
+    use right = CppMatrixExpr.Of(b)
+    Assert.Throws<ArgumentException>(fun () -> left * right |> ignore) |> ignore
+    use product = left * right.Transpose()
+    Assert.Equal(2, product.Rows)
+    Assert.Equal(2, product.Cols)
+
+[<Fact>]
+let ``C++ Float32 Matrix multiply matches a double reference`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(21)
+    let aValues = Array.init (37 * 41) (fun _ -> float32 (random.NextDouble() - 0.5))
+    let bValues = Array.init (41 * 19) (fun _ -> float32 (random.NextDouble() - 0.5))
+    use a = CppMatrixF32.FromArray(37, 41, aValues)
+    use b = CppMatrixF32.FromArray(41, 19, bValues)
+    use product = (a.Multiply(b)).Value
+    Assert.Equal(37, product.Rows)
+    Assert.Equal(19, product.Cols)
+    let actual = product.ToArray()
+    for i in 0 .. 36 do
+        for j in 0 .. 18 do
+            let expected = Seq.sum (seq { for p in 0 .. 40 -> float aValues.[i * 41 + p] * float bValues.[p * 19 + j] })
+            Assert.InRange(float actual.[i * 19 + j], expected - 1e-4, expected + 1e-4)
+
+[<Fact>]
+let ``C++ Int32 Matrix multiply and transpose are exact`` () =
+    skipIfCppLibraryUnavailable()
+    use a = CppMatrixI32.FromArray(2, 3, [| 1; 2; 3; 4; 5; 6 |])
+    use b = CppMatrixI32.FromArray(3, 2, [| 7; 8; 9; 10; 11; 12 |])
+    use product = (a.Multiply(b)).Value
+    Assert.Equal<int[]>([| 58; 64; 139; 154 |], product.ToArray())
+    
+    use transposed = (a.Transpose()).Value
+    Assert.Equal<int[]>([| 1; 4; 2; 5; 3; 6 |], transposed.ToArray())
+    
+    // Accumulation wraps like native int32 arithmetic
+    use big = CppMatrixI32.FromArray(1, 1, [| Int32.MaxValue |])
+    use one = CppMatrixI32.FromArray(1, 1, [| 1 |])
+    use sum = CppMatrixI32.FromArray(1, 1, [| 1 |])
+    sum.Gemm(1, big, one, 1)
+    Assert.Equal(Int32.MinValue, sum.Get(0, 0))
+
+[<Fact>]
+let ``C++ Matrix files round-trip through a memory mapping`` () =
+    skipIfCppLibraryUnavailable()
+    let path = IO.Path.GetTempFileName()
+    try
+        let values = Array.init 12 (fun i -> float i * 0.5)
+        use source = CppMatrix.FromArray(3, 4, values)
+        source.Save(path)
+        
+        use mapped = CppMatrix.OpenMapped(path, true)
+        Assert.Equal(3, mapped.Rows)
+        Assert.Equal(4, mapped.Cols)
+        Assert.Equal<double[]>(values, mapped.ToArray())
+        
+        // Read-only mappings are copy-on-write; writable ones persist
+        mapped.Set(0, 0, 42.0)
+        use reopened = CppMatrix.OpenMapped(path, false)
+        Assert.Equal(0.0, reopened.Get(0, 0))
+        reopened.Set(0, 0, 7.0)
+        (reopened :> IDisposable).Dispose()
+        use updated = CppMatrix.OpenMapped(path, true)
+        Assert.Equal(7.0, updated.Get(0, 0))
+        
+        Assert.Throws<IO.IOException>(fun () -> CppMatrixF32.OpenMapped(path, true) |> ignore) |> ignore
+    finally
+        IO.File.Delete(path)
+
+[<Fact>]
+let ``C++ Statistics summarize a mapped array file`` () =
+    skipIfCppLibraryUnavailable()
+    let path = IO.Path.GetTempFileName()
+    try
+        let values = Array.init 1000 (fun i -> float (i % 17) - 3.0)
+        saveArray values path
+        let fromFile = calculateSummaryFromFile path
+        let inMemory = calculateSummary values
+        Assert.Equal(inMemory, fromFile)
+        Assert.Throws<IO.IOException>(fun () -> calculateSummaryFromFile (path + ".missing") |> ignore) |> ignore
+    finally
+        IO.File.Delete(path)
+
+[<Fact>]
+let ``C++ Stats accumulator matches a single pass over all chunks`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(5)
+    let values = Array.init 10000 (fun _ -> 1e6 + random.NextDouble())
+    use first = new StatsAccumulator()
+    use second = new StatsAccumulator()
+    // Uneven chunks split across two accumulators, then merged
+    first.Push(ReadOnlySpan<double>(values, 0, 1))
+    first.Push(ReadOnlySpan<double>(values, 1, 4095))
+    second.Push(ReadOnlySpan<double>(values, 4096, 5904))
+    first.Merge(second)
+    
+    let merged = first.Snapshot()
+    let expected = calculateSummary values
+    Assert.Equal(expected.count, merged.count)
+    Assert.Equal(expected.min, merged.min)
+    Assert.Equal(expected.max, merged.max)
+    Assert.Equal(expected.mean, merged.mean, 9)
+    Assert.Equal(expected.variance, merged.variance, 9)
+    Assert.Equal(5904L, second.Snapshot().count)
+
+[<Fact>]
+let ``C++ Stats accumulator starts empty and resets`` () =
+    skipIfCppLibraryUnavailable()
+    use accumulator = new StatsAccumulator()
+    Assert.Equal(0L, accumulator.Snapshot().count)
+    accumulator.Push([| 1.0; 2.0; 3.0 |])
+    Assert.Equal(2.0, accumulator.Snapshot().mean)
+    accumulator.Reset()
+    accumulator.Push(Array.empty<double>)
+    Assert.Equal(0L, accumulator.Snapshot().count)
+
+[<Fact>]
+let ``64-bit sums do not overflow`` () =
+    skipIfLibraryUnavailable()
+    skipIfCppLibraryUnavailable()
+    let values = Array.create 1000 Int32.MaxValue
+    let expected = 1000L * int64 Int32.MaxValue
+    Assert.Equal(expected, sum_array_i64(values, values.Length))
+    use vector = new CppVector()
+    vector.AddRange(values)
+    Assert.Equal(expected, vector.SumInt64())
+    Assert.Equal(int expected, vector.Sum())
+
+[<Fact>]
+let ``C++ Parallel reductions do not depend on the thread count`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(17)
+    let ints = Array.init 1_000_000 (fun _ -> random.Next())
+    let doubles = Array.init 1_000_000 (fun _ -> random.NextDouble() * 1e3)
+    use vector = new CppVector()
+    vector.AddRange(ints)
+    let measure threads =
+        cpp_set_num_threads(threads)
+        (vector.SumInt64(), calculateSummary doubles, calculate_mean_double(doubles, doubles.Length))
+    try
+        let serial = measure 1
+        let parallel = measure 4
+        Assert.Equal(serial, parallel)
+        let (sum, _, _) = serial
+        Assert.Equal(Array.sumBy int64 ints, sum)
+    finally
+        cpp_set_num_threads(0)
+
+[<Fact>]
+let ``C++ Matrix MultiplyAsync matches the synchronous product`` () =
+    task {
+        skipIfCppLibraryUnavailable()
+        let random = Random(8)
+        use a = CppMatrix.FromArray(64, 48, Array.init (64 * 48) (fun _ -> random.NextDouble()))
+        use b = CppMatrix.FromArray(48, 32, Array.init (48 * 32) (fun _ -> random.NextDouble()))
+        use expected = (a.Multiply(b)).Value
+        use! actual = a.MultiplyAsync(b)
+        Assert.Equal(64, actual.Rows)
+        Assert.Equal(32, actual.Cols)
+        Assert.Equal<double[]>(expected.ToArray(), actual.ToArray())
+    }
+
+[<Fact>]
+let ``C++ Matrix MultiplyAsync honours cancellation and validates shapes`` () =
+    task {
+        skipIfCppLibraryUnavailable()
+        use a = new CppMatrix(200, 200)
+        use b = new CppMatrix(200, 200)
+        use cancelled = new System.Threading.CancellationTokenSource()
+        cancelled.Cancel()
+        let! _ = Assert.ThrowsAnyAsync<OperationCanceledException>(fun () -> a.MultiplyAsync(b, cancelled.Token) :> System.Threading.Tasks.Task)
+        use wrongShape = new CppMatrix(3, 3)
+        Assert.Throws<ArgumentException>(fun () -> a.MultiplyAsync(wrongShape) |> ignore) |> ignore
+    }
+
+[<Fact>]
+let ``C++ Native instrumentation reports calls only when compiled in`` () =
+    skipIfCppLibraryUnavailable()
+    cpp_stats_reset()
+    use matrix = new CppMatrix(4, 4)
+    matrix.Rows |> ignore
+    let profiles = nativeStatsSnapshot()
+    if cpp_stats_enabled() = 1 then
+        let rows = profiles |> Array.find (fun p -> p.Name = "matrix_rows")
+        Assert.True(rows.Calls >= 1L)
+        Assert.Equal(rows.Calls, Array.sum rows.Histogram)
+        let create = profiles |> Array.find (fun p -> p.Name = "matrix_create")
+        Assert.True(create.BytesAllocated >= 16L * 8L)
+    else
+        Assert.Empty(profiles)
+
+[<Fact>]
+let ``C++ String UTF-8 spans round-trip without marshalling`` () =
+    skipIfCppLibraryUnavailable()
+    use str = CppString.FromUtf8(Encoding.UTF8.GetBytes("héllo"))
+    str.AppendUtf8(Encoding.UTF8.GetBytes(", 世界"))
+    str.PrependUtf8(Encoding.UTF8.GetBytes("¡"))
+    let expected = Encoding.UTF8.GetBytes("¡héllo, 世界")
+    Assert.Equal(expected.Length, str.Length)
+    Assert.Equal<byte[]>(expected, str.AsUtf8Span().ToArray())
+    Assert.Equal("¡héllo, 世界", str.Value)
+    // Case folding covers ASCII and Latin-1; other multi-byte sequences survive untouched
+    str.ToUpper()
+    Assert.Equal("¡HÉLLO, 世界", str.Value)
+
+[<Fact>]
+let ``C++ String UTF-8 entry points keep embedded NULs and validate arguments`` () =
+    skipIfCppLibraryUnavailable()
+    use str = CppString.FromUtf8(ReadOnlySpan<byte>.Empty)
+    Assert.Equal(0, str.Length)
+    str.AppendUtf8([| 65uy; 0uy; 66uy |])
+    Assert.Equal(3, str.Length)
+    Assert.Equal<byte[]>([| 65uy; 0uy; 66uy |], str.AsUtf8Span().ToArray())
+    Assert.Equal(CppResultCode.OutOfBounds, string_append_utf8(str.Handle, NativeInterop.NativePtr.nullPtr, -1))
+    Assert.Equal(CppResultCode.NullPointer, string_append_utf8(IntPtr.Zero, NativeInterop.NativePtr.nullPtr, 0))
+    let mutable data = IntPtr.Zero
+    let mutable length = 0
+    Assert.Equal(CppResultCode.NullPointer, string_view(IntPtr.Zero, &data, &length))
+
+[<Fact>]
+let ``C++ String transforms fold Latin-1 case and reverse code points`` () =
+    skipIfCppLibraryUnavailable()
+    let text = String.replicate 5 "Ünïcödé straße ÷ × 世界 ABCxyz "
+    use str = new CppString(text)
+    str.ToLower()
+    Assert.Equal(String.replicate 5 "ünïcödé straße ÷ × 世界 abcxyz ", str.Value)
+    str.ToUpper()
+    Assert.Equal(String.replicate 5 "ÜNÏCÖDÉ STRAßE ÷ × 世界 ABCXYZ ", str.Value)
+    str.Reverse()
+    Assert.Equal(String(Array.rev ((String.replicate 5 "ÜNÏCÖDÉ STRAßE ÷ × 世界 ABCXYZ ").ToCharArray())), str.Value)
+    use reversed = new CppString("a世b😀")
+    reversed.Reverse()
+    Assert.Equal("😀b世a", reversed.Value)
+    // Repeated prepends reuse headroom instead of rebuilding the string
+    use built = new CppString("")
+    for i in 0 .. 9999 do
+        built.Prepend(string (i % 10))
+    Assert.Equal(10000, built.Length)
+    Assert.Equal("9876543210", built.Value.Substring(0, 10))
+
+[<Fact>]
+let ``C++ String batch transform rewrites packed strings in one call`` () =
+    skipIfCppLibraryUnavailable()
+    let values = [| "alpha"; ""; "Beta_2"; "déjà vu"; "世界" |]
+    Assert.Equal<string[]>([| "ALPHA"; ""; "BETA_2"; "DÉJÀ VU"; "世界" |], transformStrings CppStringTransform.ToUpper values)
+    Assert.Equal<string[]>([| "ahpla"; ""; "2_ateB"; "uv àjéd"; "界世" |], transformStrings CppStringTransform.Reverse values)
+    let bytes = Encoding.UTF8.GetBytes("abcdef")
+    let badOffsets = [| 0; 4; 2 |]
+    Assert.Throws<ArgumentException>(fun () ->
+        transformUtf8Batch(CppStringTransform.ToUpper, Span<byte>(bytes), ReadOnlySpan<int>(badOffsets))) |> ignore
+    let pastEnd = [| 0; 7 |]
+    Assert.Throws<ArgumentException>(fun () ->
+        transformUtf8Batch(CppStringTransform.ToUpper, Span<byte>(bytes), ReadOnlySpan<int>(pastEnd))) |> ignore
+
+[<Fact>]
+let ``C++ Rope string edits match a managed model and stream by chunk`` () =
+    skipIfCppLibraryUnavailable()
+    use rope = CppString.Rope(Encoding.UTF8.GetBytes("middle"))
+    let model = StringBuilder("middle")
+    let random = Random(12)
+    for i in 0 .. 999 do
+        let piece = String(char (int 'a' + i % 26), 1 + random.Next(5000) % (if i % 10 = 0 then 5000 else 20))
+        let bytes = Encoding.ASCII.GetBytes(piece)
+        match i % 3 with
+        | 0 -> rope.AppendUtf8(bytes); model.Append(piece) |> ignore
+        | 1 -> rope.PrependUtf8(bytes); model.Insert(0, piece) |> ignore
+        | _ ->
+            let offset = random.Next(model.Length + 1)
+            rope.InsertUtf8(offset, bytes)
+            model.Insert(offset, piece) |> ignore
+    Assert.Equal(model.Length, rope.Length)
+    Assert.True(rope.ChunkCount > 1)
+    use streamed = new IO.MemoryStream()
+    rope.WriteTo(streamed)
+    Assert.Equal(model.ToString(), Encoding.UTF8.GetString(streamed.ToArray()))
+    // Reading Value flattens the rope into a single chunk
+    Assert.Equal(model.ToString(), rope.Value)
+    Assert.Equal(1, rope.ChunkCount)
+    Assert.Throws<ArgumentOutOfRangeException>(fun () -> rope.InsertUtf8(rope.Length + 1, [| 65uy |])) |> ignore
+    Assert.Throws<ArgumentOutOfRangeException>(fun () -> rope.ChunkAt(1).Length |> ignore) |> ignore
+    use flat = new CppString("flat")
+    Assert.Equal(1, flat.ChunkCount)
+    flat.InsertUtf8(2, "--"B)
+    Assert.Equal("fl--at", flat.Value)
+
+[<Fact>]
+let ``C++ Iterator batches and finds match element-wise iteration`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(23)
+    let values = Array.init 10007 (fun _ -> random.Next(50))
+    use copied = new CppIterator(values)
+    use borrowed = CppIterator.Borrow(ReadOnlyMemory<int>(values))
+    let expected = values |> Array.indexed |> Array.filter (fun (_, v) -> v = 17) |> Array.map fst
+    Assert.Equal<int[]>(expected, borrowed.FindAll(17))
+    Assert.Equal<int[]>(expected, copied.FindAll(17))
+    Assert.Empty(borrowed.FindAll(-1))
+    Assert.True(copied.Find(17))
+    Assert.Equal(17, copied.Next())
+    Assert.False(copied.Find(-1))
+    // Pull everything in uneven batches
+    let buffer = Array.zeroCreate<int> 1000
+    let collected = ResizeArray<int>()
+    let mutable read = borrowed.NextBatch(Span<int>(buffer))
+    while read > 0 do
+        collected.AddRange(Array.sub buffer 0 read)
+        read <- borrowed.NextBatch(Span<int>(buffer, 0, 333))
+    Assert.Equal<int[]>(values, collected.ToArray())
+    Assert.False(borrowed.HasNext)
+    borrowed.Reset()
+    Assert.Equal(values.[0], borrowed.Next())
+
+[<Fact>]
+let ``C++ Vector indexes answer lookups like a linear scan and drop on mutation`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(24)
+    let values = Array.init 20000 (fun _ -> random.Next(-5000, 5000))
+    values.[0] <- Int32.MinValue
+    values.[1] <- Int32.MaxValue
+    use vector = new CppVector()
+    vector.AddRange(values)
+    for kinds in [ CppVectorIndex.None; CppVectorIndex.Hash; CppVectorIndex.Sorted; CppVectorIndex.Hash ||| CppVectorIndex.Sorted ] do
+        vector.Add(0)
+        vector.BuildIndex(kinds)
+        Assert.Equal(kinds, vector.IndexKinds)
+        let current = vector.ToArray()
+        for probe in [ Int32.MinValue; Int32.MaxValue; -5001; -12; 0; 777; 4999; 5000 ] do
+            Assert.Equal(Array.contains probe current, vector.Contains(probe))
+            Assert.Equal(current |> Array.filter (fun v -> v < probe) |> Array.length, vector.LowerBound(probe))
+            let high = if probe > Int32.MaxValue - 100 then Int32.MaxValue else probe + 100
+            Assert.Equal(current |> Array.filter (fun v -> v >= probe && v <= high) |> Array.length, vector.CountRange(probe, high))
+        Assert.Equal(0, vector.CountRange(10, -10))
+    vector.Sort()
+    Assert.Equal(CppVectorIndex.Hash ||| CppVectorIndex.Sorted, vector.IndexKinds)
+    vector.Clear()
+    Assert.Equal(CppVectorIndex.None, vector.IndexKinds)
+    Assert.False(vector.Contains(0))
+
+[<Fact>]
+let ``C++ stale and mistyped handles are rejected instead of dereferenced`` () =
+    skipIfCppLibraryUnavailable()
+    let vector = vector_create()
+    vector_add(vector, 7)
+    vector_destroy(vector)
+    Assert.Equal(0, vector_size(vector))
+    Assert.Contains("Stale or invalid handle", getLastErrorMessage())
+    vector_destroy(vector) // double destroy is a no-op
+    // A new object may reuse the slot but never answers to the old handle
+    let reused = vector_create()
+    vector_add(reused, 1)
+    vector_add(vector, 2)
+    Assert.Equal(1, vector_size(reused))
+    // Handles carry their type
+    let text = string_create("typed")
+    Assert.Equal(0, vector_size(text))
+    vector_destroy(text)
+    Assert.Equal(5, string_length_cpp(text))
+    let matrix = matrix_create(2, 3)
+    Assert.Equal(0, matrix_f32_rows(matrix))
+    Assert.Equal(2, matrix_rows(matrix))
+    matrix_destroy(matrix)
+    string_destroy(text)
+    vector_destroy(reused)
+
+[<Fact>]
+let ``C++ SmartResource bulk operations and zero-copy kernel inputs`` () =
+    skipIfCppLibraryUnavailable()
+    let size = 300000
+    use resource = new CppSmartResource(size, CppResourceFlags.HugePages)
+    Assert.Equal(size, resource.Size)
+    Assert.Equal(0.0, resource.Get(size - 1))
+    resource.Fill(2.0)
+    let values = Array.init 1000 float
+    resource.CopyFrom(500, ReadOnlySpan<double>(values))
+    let back = Array.zeroCreate<double> 1000
+    resource.CopyTo(500, Span<double>(back))
+    Assert.Equal<double[]>(values, back)
+    Assert.Equal(2.0, resource.AsSpan().[499])
+    let stats = resource.Statistics(500, 1000)
+    Assert.Equal(499.5, stats.mean, 9)
+    Assert.Equal(2.0 * float (size - 1000) + Array.sum values, resource.Statistics().sum, 6)
+    Assert.Throws<ArgumentOutOfRangeException>(fun () -> resource.Fill(size - 1, 2, 0.0)) |> ignore
+    // The matrix reads the buffer in place and outlives the resource
+    let matrix = resource.AsMatrix(500, 10, 100)
+    Assert.Equal(150.0, matrix.Get(1, 50))
+    matrix.Set(0, 0, -1.0)
+    Assert.Equal(-1.0, resource.Get(500))
+    (resource :> IDisposable).Dispose()
+    Assert.Equal(150.0, matrix.Get(1, 50))
+    (matrix :> IDisposable).Dispose()
+
+[<Fact>]
+let ``C batch geometry kernels and k-nearest-neighbour index`` () =
+    skipIfLibraryUnavailable()
+    // 40000 squared overflows int; the distance is now computed in double
+    Assert.Equal(50000.0f, calculate_distance({ x = 0; y = 0 }, { x = 40000; y = 30000 }), 0.5f)
+    let xs = Array.init 101 (fun i -> float (i % 10))
+    let ys = Array.init 101 (fun i -> float (i / 10))
+    let distances = calculateDistances xs ys (Array.map ((+) 3.0) xs) (Array.map ((+) 4.0) ys)
+    Assert.All(distances, fun d -> Assert.Equal(5.0, d, 12))
+    let matrix = pairwiseDistances xs ys [| 0.0; 9.0 |] [| 0.0; 10.0 |]
+    Assert.Equal(0.0, matrix.[0, 0], 12)
+    Assert.Equal(sqrt 181.0, matrix.[0, 1], 12)
+    let rects = Array.init 7 (fun i -> { width = float32 i; height = 2.0f })
+    Assert.Equal<float32[]>(Array.init 7 (fun i -> 2.0f * float32 i), rectangleAreas rects)
+    use index = new PointIndex(xs, ys)
+    Assert.Equal(101, index.Count)
+    // Grid neighbours of (4, 4): itself, then the four at distance 1 in input order
+    let nearest, nearestDistances = index.Nearest(4.0, 4.0, 5)
+    Assert.Equal<int[]>([| 44; 34; 43; 45; 54 |], nearest)
+    Assert.Equal<double[]>([| 0.0; 1.0; 1.0; 1.0; 1.0 |], nearestDistances)
+    let many, _ = index.Nearest(0.0, 0.0, 500)
+    Assert.Equal(101, many.Length)
+    let batch, batchDistances = index.NearestBatch([| 0.2; 100.0 |], [| 0.1; 0.0 |], 2)
+    Assert.Equal<int[]>([| 0; 1; 9; 19 |], batch)
+    Assert.Equal(91.0, batchDistances.[2], 12)
+
+[<Fact>]
+let ``C++ Function pipelines compose into cached fused kernels`` () =
+    skipIfCppLibraryUnavailable()
+    let random = Random(28)
+    let a = Array.init 70001 (fun _ -> random.NextDouble() * 2.0)
+    let b = Array.init 70001 (fun _ -> random.NextDouble() * 2.0)
+    let c = Array.init 70001 (fun _ -> random.NextDouble() - 0.5)
+    // pow(a * b + c, 2), built twice: the second build reuses the compiled kernel
+    let build () =
+        use add = CppFunction.CreateAdd()
+        use multiply = CppFunction.CreateMultiply()
+        use power = CppFunction.CreatePower()
+        use third = CppFunction.Input(2)
+        use two = CppFunction.Constant(2.0)
+        use sum = CppFunction.Compose(add, multiply, third)
+        CppFunction.Compose(power, sum, two)
+    use pipeline = build ()
+    Assert.Equal(3, pipeline.Arity)
+    let _, missesBefore, _ = CppFunction.CacheStatistics
+    use again = build ()
+    let _, missesAfter, _ = CppFunction.CacheStatistics
+    Assert.Equal(missesBefore, missesAfter)
+    let result = pipeline.Evaluate(a, b, c)
+    Assert.All(Array.init a.Length id, fun i ->
+        let expected = (a.[i] * b.[i] + c.[i]) ** 2.0
+        Assert.Equal(expected, result.[i], 1e-12 * max 1.0 expected))
+    Assert.Throws<ArgumentException>(fun () -> pipeline.Evaluate(a, b) |> ignore) |> ignore
+    // Pipelines reading at most two inputs also work through Call and CallBatch
+    use multiply = CppFunction.CreateMultiply()
+    use first = CppFunction.Input(0)
+    use square = CppFunction.Compose(multiply, first, first)
+    Assert.Equal(1, square.Arity)
+    Assert.Equal(9.0, square.Call(3.0, 100.0))
+    Assert.Equal<double[]>(Array.map (fun x -> x * x) a, square.CallBatch(a, b))
+
+[<Fact>]
+let ``C++ Matrix result cache reuses products until an operand changes`` () =
+    skipIfCppLibraryUnavailable()
+    let n = 40
+    use a = CppMatrix.FromArray(n, n, Array.init (n * n) (fun i -> float (i % 7)))
+    use b = CppMatrix.FromArray(n, n, Array.init (n * n) (fun i -> float (i % 5) - 2.0))
+    use expected = new CppMatrix(n, n)
+    a.MultiplyInto(b, expected)
+    CppMatrix.SetResultCacheBudget(1L <<< 20)
+    try
+        let before = CppMatrix.ResultCacheStatistics
+        use first = (a.Multiply(b)).Value
+        use second = (a.Multiply(b)).Value
+        let after = CppMatrix.ResultCacheStatistics
+        Assert.Equal(before.misses + 1L, after.misses)
+        Assert.Equal(before.hits + 1L, after.hits)
+        Assert.Equal<double[]>(expected.ToArray(), second.ToArray())
+        // A hit shares storage copy-on-write: writing it leaves the cached product intact
+        second.Set(0, 0, -1.0)
+        use third = (a.Multiply(b)).Value
+        Assert.Equal(expected.Get(0, 0), third.Get(0, 0))
+        // Writing an operand changes the key, so the product is recomputed
+        a.Set(0, 0, 10.0)
+        use changed = (a.Multiply(b)).Value
+        a.MultiplyInto(b, expected)
+        Assert.Equal<double[]>(expected.ToArray(), changed.ToArray())
+        Assert.Equal(after.misses + 1L, CppMatrix.ResultCacheStatistics.misses)
+    finally
+        CppMatrix.SetResultCacheBudget(0L)
+    Assert.Equal(0L, CppMatrix.ResultCacheStatistics.entries)
+
+[<Fact>]
+let ``C++ SparseMatrix matches dense results for SpMV and products`` () =
+    skipIfCppLibraryUnavailable()
+    // Unsorted triplets with a duplicate (0, 2) that is summed
+    use a = CppSparseMatrix.FromCoo(3, 4, [| 2; 0; 1; 0 |], [| 1; 2; 0; 2 |], [| 5.0; 1.0; 2.0; 3.0 |])
+    Assert.Equal(3, a.NonZeroCount)
+    Assert.Equal(4.0, a.Get(0, 2))
+    Assert.Equal(0.0, a.Get(2, 3))
+    let rows, cols, values = a.ToCoo()
+    Assert.Equal<int[]>([| 0; 1; 2 |], rows)
+    Assert.Equal<int[]>([| 2; 0; 1 |], cols)
+    Assert.Equal<double[]>([| 4.0; 2.0; 5.0 |], values)
+    use dense = a.ToDense()
+    Assert.Equal<double[]>([| 0.0; 0.0; 4.0; 0.0; 2.0; 0.0; 0.0; 0.0; 0.0; 5.0; 0.0; 0.0 |], dense.ToArray())
+    Assert.Equal<double[]>([| 12.0; 2.0; 10.0 |], a.MultiplyVector([| 1.0; 2.0; 3.0; 4.0 |]))
+    use b = CppMatrix.FromArray(4, 2, [| 1.0; 2.0; 3.0; 4.0; 5.0; 6.0; 7.0; 8.0 |])
+    use expected = (dense.Multiply(b)).Value
+    use product = a.Multiply(b)
+    Assert.Equal<double[]>(expected.ToArray(), product.ToArray())
+    use sparseB = CppSparseMatrix.FromDense(b)
+    Assert.Equal(8, sparseB.NonZeroCount)
+    use sparseProduct = a.Multiply(sparseB)
+    use sparseProductDense = sparseProduct.ToDense()
+    Assert.Equal<double[]>(expected.ToArray(), sparseProductDense.ToArray())
+    Assert.Throws<ArgumentException>(fun () -> a.Multiply(a) |> ignore) |> ignore
+    Assert.Throws<ArgumentException>(fun () ->
+        CppSparseMatrix.FromCoo(2, 2, [| 2 |], [| 0 |], [| 1.0 |]) |> ignore) |> ignore
+
+[<Fact>]
+let ``C++ matrix_multiply_async operands may be destroyed once the job is queued`` () =
+    skipIfCppLibraryUnavailable()
+    let a = matrix_create(2, 2)
+    let b = matrix_create(2, 2)
+    for i in 0 .. 3 do
+        matrix_set(a, i / 2, i % 2, float (i + 1))
+        matrix_set(b, i / 2, i % 2, float (i + 5))
+    let job = matrix_multiply_async(a, b, null, IntPtr.Zero)
+    Assert.NotEqual(IntPtr.Zero, job)
+    matrix_destroy(a)
+    matrix_destroy(b)
+    Assert.Equal(CppResultCode.Success, job_wait(job, -1))
+    let product = job_result(job)
+    Assert.Equal(19.0, matrix_get(product, 0, 0))
+    Assert.Equal(50.0, matrix_get(product, 1, 1))
+    matrix_destroy(product)
+    job_destroy(job)
+
+[<Fact>]
+let ``C++ matrix expression fails cleanly after a leaf matrix is destroyed`` () =
+    skipIfCppLibraryUnavailable()
+    let a = matrix_create(2, 2)
+    matrix_set(a, 1, 1, 3.0)
+    let leaf = matrix_expr_leaf(a)
+    let square = matrix_expr_mul(leaf, leaf)
+    use out = new CppMatrix(2, 2)
+    Assert.Equal(CppResultCode.Success, matrix_expr_eval_into(square, out.Handle))
+    Assert.Equal(9.0, out.Get(1, 1))
+    matrix_destroy(a)
+    Assert.Equal(IntPtr.Zero, matrix_expr_eval(square))
+    Assert.Contains("Stale or invalid handle", getLastErrorMessage())
+    Assert.Equal(CppResultCode.InvalidOperation, matrix_expr_eval_into(square, out.Handle))
+    Assert.Equal(9.0, out.Get(1, 1))
+    matrix_expr_destroy(square)
+    matrix_expr_destroy(leaf)
+
+[<Fact>]
+let ``C++ safe_matrix_multiply shares the matrix result cache`` () =
+    skipIfCppLibraryUnavailable()
+    use a = CppMatrix.FromArray(8, 8, Array.init 64 float)
+    use b = CppMatrix.FromArray(8, 8, Array.init 64 (fun i -> float (i % 3)))
+    CppMatrix.SetResultCacheBudget(1L <<< 20)
+    try
+        use first = (a.Multiply(b)).Value
+        let before = CppMatrix.ResultCacheStatistics
+        let mutable product = IntPtr.Zero
+        Assert.Equal(CppResultCode.Success, safe_matrix_multiply(a.Handle, b.Handle, &product))
+        Assert.Equal(before.hits + 1L, CppMatrix.ResultCacheStatistics.hits)
+        Assert.Equal(first.Get(7, 7), matrix_get(product, 7, 7))
+        matrix_destroy(product)
+    finally
+        CppMatrix.SetResultCacheBudget(0L)